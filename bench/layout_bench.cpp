@@ -0,0 +1,171 @@
+// Compare the row-major layout (CHUNKED, and VECTORIZED which shares its row kernel with TILED) against the blocked
+// one (TILED) on wide grids: time per generation and, where perf events are available, cache misses per generation.
+//
+// usage: bench-layout [height] [generations], both at least 1
+
+#include "game.hpp"
+
+#include <linux/perf_event.h>
+#include <spdlog/spdlog.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+class CacheCounters
+{
+public:
+    enum Counter
+    {
+        L1D_READ_MISS,
+        LLC_READ_MISS,
+        COUNT,
+    };
+
+    // NOTE: `inherit` only follows threads created after the events are opened, so open them before the Grid (and its
+    // ThreadPool); inherited counts are only summed back once those threads exit
+    CacheCounters()
+    {
+        // clang-format off
+        const std::array<std::uint64_t, COUNT> configs{
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_LL  | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        };
+        // clang-format on
+
+        for (std::size_t i = 0; i < COUNT; ++i) {
+            perf_event_attr attr{};
+            attr.type           = PERF_TYPE_HW_CACHE;
+            attr.size           = sizeof(attr);
+            attr.config         = configs[i];
+            attr.inherit        = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+
+            m_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+    }
+
+    ~CacheCounters()
+    {
+        for (auto fd : m_fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    CacheCounters(const CacheCounters&)            = delete;
+    CacheCounters& operator=(const CacheCounters&) = delete;
+
+    std::optional<std::uint64_t> read(Counter counter) const
+    {
+        std::uint64_t value = 0;
+        if (m_fds[counter] < 0 || ::read(m_fds[counter], &value, sizeof(value)) != sizeof(value)) {
+            return {};
+        }
+        return value;
+    }
+
+private:
+    std::array<int, COUNT> m_fds{ -1, -1 };
+};
+
+struct Result
+{
+    double                       m_secondsPerGen = 0.0;
+    std::optional<std::uint64_t> m_l1dMisses;
+    std::optional<std::uint64_t> m_llcMisses;
+};
+
+Result run(int width, int height, int generations, Grid::UpdateStrategy strategy)
+{
+    CacheCounters counters;
+    double        seconds = 0.0;
+    {
+        Grid grid{ width, height, strategy };
+        grid.populate(0.5f);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < generations; ++i) {
+            grid.updateState();
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return {
+        .m_secondsPerGen = seconds / std::max(generations, 1),    // the setup run has none
+        .m_l1dMisses     = counters.read(CacheCounters::L1D_READ_MISS),
+        .m_llcMisses     = counters.read(CacheCounters::LLC_READ_MISS),
+    };
+}
+
+// the whole of `arg` as a number of at least 1
+std::optional<int> parsePositive(std::string_view arg)
+{
+    int value = 0;
+
+    const auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+    if (error != std::errc{} || end != arg.data() + arg.size() || value < 1) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+int main(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto heightArg      = argc > 1 ? parsePositive(argv[1]) : std::optional{ 1024 };
+    const auto generationsArg = argc > 2 ? parsePositive(argv[2]) : std::optional{ 20 };
+    if (argc > 3 || !heightArg || !generationsArg) {
+        std::fprintf(stderr, "usage: %s [height] [generations], both at least 1\n", argv[0]);
+        return 1;
+    }
+
+    const int height      = *heightArg;
+    const int generations = *generationsArg;
+
+    std::printf(
+        "%-8s %-10s %12s %14s %16s %16s\n", "width", "layout", "ms/gen", "Mcells/s", "L1d miss/gen", "LLC miss/gen"
+    );
+
+    const std::array layouts{
+        std::pair{ "rows", Grid::UpdateStrategy::CHUNKED },
+        std::pair{ "rows-simd", Grid::UpdateStrategy::VECTORIZED },
+        std::pair{ "tiles", Grid::UpdateStrategy::TILED },
+    };
+
+    for (int width : { 4096, 16384, 32768 }) {
+        for (auto [name, strategy] : layouts) {
+            // the same run with no generation tells how much of the counts is setup (allocation and populate)
+            const auto setup  = run(width, height, 0, strategy);
+            const auto result = run(width, height, generations, strategy);
+
+            auto perGen = [&](const auto& total, const auto& base) -> std::string {
+                if (!total || !base) {
+                    return "-";
+                }
+                return std::to_string((long long)(*total - std::min(*total, *base)) / generations);
+            };
+
+            std::printf(
+                "%-8d %-10s %12.3f %14.1f %16s %16s\n",
+                width,
+                name,
+                result.m_secondsPerGen * 1e3,
+                (double)width * height / result.m_secondsPerGen / 1e6,
+                perGen(result.m_l1dMisses, setup.m_l1dMisses).c_str(),
+                perGen(result.m_llcMisses, setup.m_llcMisses).c_str()
+            );
+        }
+    }
+}
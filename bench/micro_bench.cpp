@@ -0,0 +1,318 @@
+// Microbenchmarks of the hot paths, on Google Benchmark. Results can be exported for comparing runs over time with the
+// usual flags, e.g.
+//
+//     bench --benchmark_out=results.json --benchmark_out_format=json
+//     bench --benchmark_filter='UpdateState/.*/chunked'
+//
+// The Plane case needs an OpenGL context (from a hidden window), it is skipped when there is no display.
+
+#include "game.hpp"
+#include "plane.hpp"
+#include "threadpool.hpp"
+#include "triple_buffer_atomic.hpp"
+#include "unrolled_matrix.hpp"
+
+#include <benchmark/benchmark.h>
+#include <glbinding/glbinding.h>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // the strategies, indexed by the benchmark argument
+    const std::vector<std::pair<std::string, Grid::UpdateStrategy>> s_strategies{
+        Grid::s_updateStrategyMap.begin(),
+        Grid::s_updateStrategyMap.end(),
+    };
+
+    constexpr std::uint64_t s_seed = 42;
+
+    float toDensity(std::int64_t percent) { return (float)percent / 100.0f; }
+
+    // Grid construction is not what is measured, and its pool is expensive to spin up: keep the last one around
+    Grid& cachedGrid(int size, Grid::UpdateStrategy strategy)
+    {
+        static std::unique_ptr<Grid> grid;
+        static int                   gridSize     = 0;
+        static Grid::UpdateStrategy  gridStrategy = {};
+
+        if (!grid || gridSize != size || gridStrategy != strategy) {
+            grid.reset();    // don't have two pools at once
+            grid         = std::make_unique<Grid>(size, size, strategy);
+            gridSize     = size;
+            gridStrategy = strategy;
+        }
+        return *grid;
+    }
+
+    void setCellCounters(benchmark::State& state, std::int64_t cellsPerIteration)
+    {
+        state.SetItemsProcessed(state.iterations() * cellsPerIteration);
+        state.counters["cells"] = (double)cellsPerIteration;
+    }
+
+    class OffscreenContext
+    {
+    public:
+        OffscreenContext()
+        {
+            if (glfwInit() != GLFW_TRUE) {
+                return;
+            }
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+            m_window = glfwCreateWindow(64, 64, "bench", nullptr, nullptr);
+            if (m_window == nullptr) {
+                return;
+            }
+            glfwMakeContextCurrent(m_window);
+            glbinding::initialize(glfwGetProcAddress);
+        }
+
+        ~OffscreenContext()
+        {
+            if (m_window != nullptr) {
+                glfwDestroyWindow(m_window);
+            }
+            glfwTerminate();
+        }
+
+        OffscreenContext(const OffscreenContext&)            = delete;
+        OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+        bool isValid() const { return m_window != nullptr; }
+
+    private:
+        GLFWwindow* m_window = nullptr;
+    };
+}
+
+// Grid
+// ----
+
+// args: size, density (percent), strategy
+void BM_UpdateState(benchmark::State& state)
+{
+    const auto size              = (int)state.range(0);
+    const auto& [name, strategy] = s_strategies[(std::size_t)state.range(2)];
+
+    auto& grid = cachedGrid(size, strategy);
+    grid.setSeed(s_seed);
+    grid.populate(toDensity(state.range(1)));
+
+    for (auto _ : state) {
+        grid.updateState();
+    }
+
+    state.SetLabel(name);
+    setCellCounters(state, (std::int64_t)size * size);
+}
+
+// args: size, density (percent), strategy
+void BM_Populate(benchmark::State& state)
+{
+    const auto size              = (int)state.range(0);
+    const auto& [name, strategy] = s_strategies[(std::size_t)state.range(2)];
+
+    auto& grid = cachedGrid(size, strategy);
+    grid.setSeed(s_seed);
+
+    for (auto _ : state) {
+        grid.populate(toDensity(state.range(1)));
+    }
+
+    state.SetLabel(name);
+    setCellCounters(state, (std::int64_t)size * size);
+}
+
+// args: size, density (percent); single threaded, every cell of the grid once per iteration
+void BM_CheckNeighbors(benchmark::State& state)
+{
+    const auto size = (int)state.range(0);
+
+    auto& grid = cachedGrid(size, Grid::UpdateStrategy::CHUNKED);
+    grid.setSeed(s_seed);
+    grid.populate(toDensity(state.range(1)));
+
+    for (auto _ : state) {
+        int sum = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                sum += grid.checkNeighbors(x, y);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    setCellCounters(state, (std::int64_t)size * size);
+}
+
+// UnrolledMatrix
+// --------------
+
+// args: size
+void BM_MatrixApply(benchmark::State& state)
+{
+    const auto size = state.range(0);
+
+    UnrolledMatrix<Grid::Cell> matrix{ size, size, Grid::LIVE_STATE };
+    for (auto _ : state) {
+        matrix.apply([](Grid::Cell& cell) { cell = cell == 0 ? Grid::LIVE_STATE : (Grid::Cell)(cell - 1); });
+        benchmark::ClobberMemory();
+    }
+
+    setCellCounters(state, size * size);
+}
+
+// args: size; includes the copy transform() makes
+void BM_MatrixTransform(benchmark::State& state)
+{
+    const auto size = state.range(0);
+
+    UnrolledMatrix<Grid::Cell> matrix{ size, size, Grid::LIVE_STATE };
+    for (auto _ : state) {
+        auto result = matrix.transform([](Grid::Cell& cell) { cell = (Grid::Cell)(cell >> 1); });
+        benchmark::DoNotOptimize(result.base().data());
+    }
+
+    setCellCounters(state, size * size);
+}
+
+// Plane
+// -----
+
+// args: size, density (percent); the whole grid is visible
+void BM_PlaneCustomizeIndices(benchmark::State& state)
+{
+    static OffscreenContext context;
+    if (!context.isValid()) {
+        state.SkipWithError("no OpenGL context (no display?)");
+        return;
+    }
+
+    const auto size = (int)state.range(0);
+
+    auto& grid = cachedGrid(size, Grid::UpdateStrategy::CHUNKED);
+    grid.setSeed(s_seed);
+    grid.populate(toDensity(state.range(1)));
+
+    Plane plane{ 1.0f, { size, size }, { size, size } };
+    for (auto _ : state) {
+        plane.customizeIndices(0, size, 0, size, grid.data(), [](const Grid::Cell& cell) {
+            return cell == Grid::LIVE_STATE;
+        });
+    }
+
+    setCellCounters(state, (std::int64_t)size * size);
+}
+
+// TripleBufferAtomic
+// ------------------
+
+// publish() then acquire() on the same thread, the cost of the handoff itself with no contention
+void BM_TripleBufferHandoff(benchmark::State& state)
+{
+    TripleBufferAtomic<Grid::Grid_type> buffer{ Grid::Grid_type{ 64, 64 } };
+    for (auto _ : state) {
+        buffer.publish();
+        benchmark::DoNotOptimize(&buffer.acquire());
+    }
+}
+
+// same, with a consumer spinning on acquire() on another thread
+void BM_TripleBufferHandoffContended(benchmark::State& state)
+{
+    TripleBufferAtomic<Grid::Grid_type> buffer{ Grid::Grid_type{ 64, 64 } };
+
+    std::atomic<bool> stop{ false };
+    std::jthread      consumer{ [&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            benchmark::DoNotOptimize(&buffer.acquire());
+        }
+    } };
+
+    for (auto _ : state) {
+        buffer.publish();
+    }
+    stop = true;
+}
+
+// ThreadPool
+// ----------
+
+// enqueue() an empty task and wait for its future
+void BM_ThreadPoolEnqueueRoundTrip(benchmark::State& state)
+{
+    ThreadPool pool{ (std::size_t)state.range(0) };
+    for (auto _ : state) {
+        pool.enqueue([] {}).wait();
+    }
+}
+
+// args: threads, mode; an empty parallelFor() over one index per thread, the fork-join overhead
+void BM_ThreadPoolParallelForRoundTrip(benchmark::State& state)
+{
+    const auto threads = (std::size_t)state.range(0);
+    const auto mode    = state.range(1) == 0 ? ThreadPool::Mode::SHARED_QUEUE : ThreadPool::Mode::WORK_STEALING;
+
+    ThreadPool pool{ threads, mode };
+    for (auto _ : state) {
+        pool.parallelFor(0, (long)threads, 1, [](long i) { benchmark::DoNotOptimize(i); });
+    }
+
+    state.SetLabel(mode == ThreadPool::Mode::SHARED_QUEUE ? "shared-queue" : "work-stealing");
+}
+
+// clang-format off
+BENCHMARK(BM_UpdateState)
+    ->ArgsProduct({ { 256, 1024, 4096 }, { 10, 50 }, benchmark::CreateDenseRange(0, (long)s_strategies.size() - 1, 1) })
+    ->ArgNames({ "size", "density", "strategy" })
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_Populate)
+    ->ArgsProduct({ { 256, 1024, 4096 }, { 10, 50 }, benchmark::CreateDenseRange(0, (long)s_strategies.size() - 1, 1) })
+    ->ArgNames({ "size", "density", "strategy" })
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_CheckNeighbors)
+    ->ArgsProduct({ { 256, 1024 }, { 10, 50 } })
+    ->ArgNames({ "size", "density" })
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MatrixApply)->RangeMultiplier(4)->Range(256, 4096)->ArgName("size")->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MatrixTransform)->RangeMultiplier(4)->Range(256, 4096)->ArgName("size")->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_PlaneCustomizeIndices)
+    ->ArgsProduct({ { 256, 1024 }, { 10, 50 } })
+    ->ArgNames({ "size", "density" })
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TripleBufferHandoff);
+BENCHMARK(BM_TripleBufferHandoffContended)->UseRealTime();
+BENCHMARK(BM_ThreadPoolEnqueueRoundTrip)->Arg(1)->Arg(4)->ArgName("threads")->UseRealTime();
+BENCHMARK(BM_ThreadPoolParallelForRoundTrip)
+    ->ArgsProduct({ { 1, 4 }, { 0, 1 } })
+    ->ArgNames({ "threads", "mode" })
+    ->UseRealTime();
+// clang-format on
+
+int main(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::warn);    // the Grid and the ThreadPool are chatty on construction
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
@@ -15,3 +15,4 @@ class Recipe(ConanFile):
         self.requires("perlinnoise/3.0.0")
         self.requires("spdlog/1.13.0")
         self.requires("cli11/2.4.1")
+        self.requires("benchmark/1.8.3")
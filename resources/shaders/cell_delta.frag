@@ -0,0 +1,9 @@
+#version 330 core
+
+flat in float Live;
+out vec4      FragColor;
+
+void main()
+{
+    FragColor = vec4(Live, 0.0, 0.0, 1.0);    // only the red channel exists on the texture, 1.0 is LIVE
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+// one point per changed cell, rendered into the state texture (one texel per cell) so only the changes are uploaded
+layout(location = 0) in uvec3 a_change;    // column, row, 1 if the cell became live
+
+flat out float Live;
+
+uniform vec2 u_size;    // of the state texture
+
+void main()
+{
+    gl_Position  = vec4((vec2(a_change.xy) + 0.5) / u_size * 2.0 - 1.0, 0.0, 1.0);
+    gl_PointSize = 1.0;
+    Live         = float(a_change.z);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// one instance per live cell, no per-vertex attribute: the four corners of the quad (drawn as a triangle strip) come
+// from gl_VertexID. the cell at column x and row y covers [x, x + 1) x [y, y + 1), same as the subdivided plane
+layout(location = 0) in uvec2 a_cell;
+
+out vec2 TexCoords;
+
+uniform mat4 u_view;
+uniform mat4 u_projection;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    gl_Position = u_projection * u_view * vec4(vec2(a_cell) + corner, 0.0, 1.0);
+    TexCoords   = corner;
+}
@@ -6,11 +6,71 @@ out vec4 FragColor;
 uniform sampler2D u_tex;
 uniform vec3      u_color;
 
+// state mode: the whole grid is a single quad, TexCoords goes from 0 to the grid dimension and its integer part is the
+// cell, looked up in u_state (one texel per cell, 1.0 is LIVE). the cell and the grid lines are drawn procedurally
+uniform bool      u_stateMode;
+uniform sampler2D u_state;
+uniform bool      u_gridLines;
+uniform vec3      u_gridColor;
+uniform bool      u_trail;    // the cells below 1.0 are the fade of the dead ones, drawn dimmer as they fade out
+uniform float     u_blockSize;    // cells per texel of u_state, more than 1 for a level of the density pyramid
+
+const float CELL_BEVEL = 0.125;    // same proportion as resources/textures/cell.png
+const float GRID_BEVEL = 0.086;    // same proportion as resources/textures/grid.png
+
+const float TRAIL_BRIGHTNESS = 0.6;    // of a cell that just died, relative to a LIVE one
+const float SPARSE_BRIGHTNESS = 0.3;    // of a block with a single LIVE cell, relative to a full one
+
+// bevelled square: `face` inside, then one shade per side (left, right, bottom, top) on the bevel
+float bevel(vec2 local, float width, float face, vec4 sides)
+{
+    vec4  dist    = vec4(local.x, 1.0 - local.x, local.y, 1.0 - local.y);
+    float nearest = min(min(dist.x, dist.y), min(dist.z, dist.w));
+    if (nearest >= width) {
+        return face;
+    }
+    if (nearest == dist.x) {
+        return sides.x;
+    } else if (nearest == dist.y) {
+        return sides.y;
+    } else if (nearest == dist.z) {
+        return sides.z;
+    }
+    return sides.w;
+}
+
 void main()
 {
-    vec4 textureColor = texture(u_tex, TexCoords);
-    if (textureColor.a < 0.1f) {
+    if (!u_stateMode) {
+        vec4 textureColor = texture(u_tex, TexCoords);
+        if (textureColor.a < 0.1f) {
+            discard;
+        }
+        FragColor = vec4(textureColor.rgb * u_color, textureColor.a);
+        return;
+    }
+
+    vec2  coords = TexCoords / max(u_blockSize, 1.0);
+    ivec2 cell   = min(ivec2(floor(coords)), textureSize(u_state, 0) - 1);
+    vec2  local  = fract(coords);
+
+    float state = texelFetch(u_state, cell, 0).r;
+    if (u_blockSize > 1.0) {
+        // a block is smaller than a pixel, no bevel nor grid lines: only how full it is
+        if (state == 0.0) {
+            discard;
+        }
+        FragColor = vec4(vec3(0.88 * mix(SPARSE_BRIGHTNESS, 1.0, state)) * u_color, 1.0);
+    } else if (state == 1.0) {
+        float shade = bevel(local, CELL_BEVEL, 0.88, vec4(0.69, 0.75, 0.60, 0.96));
+        FragColor   = vec4(vec3(shade) * u_color, 1.0);
+    } else if (u_trail && state > 0.0) {
+        float shade = bevel(local, CELL_BEVEL, 0.88, vec4(0.69, 0.75, 0.60, 0.96)) * TRAIL_BRIGHTNESS * state;
+        FragColor   = vec4(vec3(shade) * u_color, 1.0);
+    } else if (u_gridLines && min(min(local.x, 1.0 - local.x), min(local.y, 1.0 - local.y)) < GRID_BEVEL) {
+        float shade = bevel(local, GRID_BEVEL, 0.0, vec4(0.29, 0.27, 0.37, 0.04));
+        FragColor   = vec4(vec3(shade) * u_gridColor, 1.0);
+    } else {
         discard;
     }
-    FragColor = vec4(textureColor.rgb * u_color, textureColor.a);
 }
@@ -0,0 +1,40 @@
+#version 330 core
+
+// one generation of Grid::updateState under a Rule, one fragment per cell: 1.0 is LIVE, anything lower is 1/255 per
+// state toward 0.0 (see Rule for the meaning of the states in between)
+
+out float NextState;
+
+uniform sampler2D u_state;
+uniform int       u_birth;       // bit n set: born on n neighbors
+uniform int       u_survival;    // bit n set: stays LIVE on n neighbors
+uniform float     u_decay;       // lost per generation by a cell that isn't LIVE
+uniform bool      u_lifeLike;    // a dying cell can be born again, not only a dead one
+
+const float LIVE = 1.0;
+
+int isLive(ivec2 cell, ivec2 size)
+{
+    // wrap-around, same as Grid::operator()
+    return texelFetch(u_state, (cell + size) % size, 0).r == LIVE ? 1 : 0;
+}
+
+void main()
+{
+    ivec2 size = textureSize(u_state, 0);
+    ivec2 pos  = ivec2(gl_FragCoord.xy);
+
+    int neighbor = isLive(pos + ivec2(-1, -1), size) + isLive(pos + ivec2(0, -1), size) + isLive(pos + ivec2(1, -1), size)
+                 + isLive(pos + ivec2(-1,  0), size)                                    + isLive(pos + ivec2(1,  0), size)
+                 + isLive(pos + ivec2(-1,  1), size) + isLive(pos + ivec2(0,  1), size) + isLive(pos + ivec2(1,  1), size);
+
+    float cell     = texelFetch(u_state, pos, 0).r;
+    bool  survived = cell == LIVE && ((u_survival >> neighbor) & 1) != 0;
+    bool  born     = cell != LIVE && (cell == 0.0 || u_lifeLike) && ((u_birth >> neighbor) & 1) != 0;
+
+    if (survived || born) {
+        NextState = LIVE;
+    } else {
+        NextState = max(cell - u_decay, 0.0);
+    }
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+in vec2  TexCoords;
+out vec4 FragColor;
+
+// one texel per pixel of the text, 1.0 where a glyph is lit
+uniform sampler2D u_text;
+uniform vec4      u_foreground;
+uniform vec4      u_background;
+
+void main()
+{
+    FragColor = mix(u_background, u_foreground, texture(u_text, TexCoords).r);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+// a single screen-space quad, no vertex attribute: the four corners (drawn as a triangle strip) come from gl_VertexID.
+// u_rect is the quad in normalized device coordinates: left, bottom, right, top
+out vec2 TexCoords;
+
+uniform vec4 u_rect;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+    gl_Position = vec4(mix(u_rect.xy, u_rect.zw, corner), 0.0, 1.0);
+    TexCoords   = vec2(corner.x, 1.0 - corner.y);    // the first row of the text is the first row of the texture
+}
@@ -0,0 +1,75 @@
+#ifndef ALLOC_COUNTER_HPP_H6VZP2TE
+#define ALLOC_COUNTER_HPP_H6VZP2TE
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Process-wide count of the heap allocations, split by what the allocating thread is working for: the ticks of the
+// simulation or the frames of the renderer (see setTrack(), a pool worker counts for the thread that handed it the job).
+// Only counts with GOL_COUNT_ALLOCATIONS defined, in which case main.cpp replaces the global operator new to call
+// count(); otherwise the counts stay at 0 and s_enabled tells the stats not to show them.
+class AllocCounter
+{
+public:
+    enum class Track
+    {
+        OTHER,
+        TICK,
+        FRAME,
+
+        numOfTracks,
+    };
+
+    static constexpr auto s_numOfTracks = (std::size_t)Track::numOfTracks;
+
+#ifdef GOL_COUNT_ALLOCATIONS
+    static constexpr bool s_enabled = true;
+#else
+    static constexpr bool s_enabled = false;
+#endif
+
+    using Counts = std::array<std::uint64_t, s_numOfTracks>;
+
+    // while the calling thread is set to another track, restored on destruction
+    class ScopedTrack
+    {
+    public:
+        explicit ScopedTrack(Track track)
+            : m_previous{ std::exchange(t_track, track) }
+        {
+        }
+
+        ~ScopedTrack() { t_track = m_previous; }
+
+        ScopedTrack(const ScopedTrack&)            = delete;
+        ScopedTrack& operator=(const ScopedTrack&) = delete;
+
+    private:
+        Track m_previous;
+    };
+
+    // called on every allocation, must not allocate itself
+    static void count() noexcept { s_counts[(std::size_t)t_track].fetch_add(1, std::memory_order_relaxed); }
+
+    static Track track() noexcept { return t_track; }
+    static void  setTrack(Track track) noexcept { t_track = track; }
+
+    // the counts since the last drain()
+    static Counts drain()
+    {
+        Counts counts;
+        for (std::size_t i = 0; i < s_numOfTracks; ++i) {
+            counts[i] = s_counts[i].exchange(0, std::memory_order_relaxed);
+        }
+        return counts;
+    }
+
+private:
+    static inline thread_local Track                                    t_track = Track::OTHER;
+    static inline std::array<std::atomic<std::uint64_t>, s_numOfTracks> s_counts{};
+};
+
+#endif /* end of include guard: ALLOC_COUNTER_HPP_H6VZP2TE */
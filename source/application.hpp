@@ -1,23 +1,36 @@
 #ifndef APPLICATION_HPP_32WF98D4
 #define APPLICATION_HPP_32WF98D4
 
+#include "alloc_counter.hpp"
 #include "camera.hpp"
-#include "double_buffer_atomic.hpp"
 #include "game.hpp"
+#include "gpu_simulation.hpp"
+#include "pattern.hpp"
+#include "phase_stats.hpp"
 #include "renderer.hpp"
 #include "simulation.hpp"
+#include "snapshot.hpp"
+#include "stats_overlay.hpp"
 
 #include <glfw_cpp/glfw_cpp.hpp>
 #include <glbinding/glbinding.h>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
 #include <concepts>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <format>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <string_view>
 #include <type_traits>
 #include <utility>
+#include <variant>
 
 class Application
 {
@@ -32,6 +45,29 @@ public:
         std::size_t          m_delay;    // in milliseconds
         bool                 m_vsync;
         Grid::UpdateStrategy m_updateStrategy;
+        int                  m_hashLifeStep;          // 2^step generations per tick
+        std::size_t          m_hashLifeCacheLimit;    // in number of nodes
+        bool                 m_trackActiveTiles;
+        int                  m_generationsPerTick;
+        bool                 m_gpu;    // simulate on the GPU instead, the Grid is only used to populate
+        Renderer::RenderMode m_renderMode;
+        bool                 m_levelOfDetail;    // draw a density pyramid built by the simulation when zoomed out
+        Grid::Placement      m_placement;        // of the simulation workers and the cells
+        std::uint64_t        m_seed;    // of the populations, see Grid::setSeed()
+        Rule                 m_rule;
+        Grid::Boundary       m_boundary;    // ignored with m_gpu, the shader wraps around
+
+        std::optional<std::filesystem::path> m_statsFile;    // dump the phase timings every second, JSON if *.json else CSV
+        std::optional<std::filesystem::path> m_pattern;      // loaded instead of the random population
+        std::optional<std::pair<int, int>>   m_patternOffset;    // column and row of its lower left cell, else centered
+        std::optional<std::filesystem::path> m_resume;           // snapshot to start from, instead of the pattern
+        std::filesystem::path                m_snapshotFile;     // saved to on F5, restored from on F9
+        std::filesystem::path                m_mappedFile;       // holds the cells of the MAPPED strategy, replaced
+        std::uint64_t                        m_checkpointInterval;    // save to m_snapshotFile every n generations
+        std::uint64_t                        m_jumpTo;                // fast-forward to it on start, 0 to not
+        Simulation::CycleAction              m_cycleAction;           // once the states repeat
+        bool                                 m_census;                // count the cells of every generation
+        std::size_t                          m_censusHistory;         // generations of it kept, see Simulation
     };
 
     Application()                              = delete;
@@ -44,20 +80,66 @@ public:
         : m_glfw{ glfwInit() }
         , m_wm{ m_glfw->createWindowManager() }
         , m_window{ m_wm.createWindow({}, s_defaultTitle.data(), 800, 600) }
-        , m_simulation{ param.m_gridWidth, param.m_gridHeight, param.m_updateStrategy, param.m_delay }
-        , m_renderer{ m_window, *m_simulation.read([](auto& grid) { return &grid; }) }    // kinda a hack, but eh
+        , m_simulation{
+            param.m_gridWidth, param.m_gridHeight, param.m_updateStrategy,
+            param.m_delay,     param.m_mappedFile, param.m_placement,
+        }
+        , m_renderer{ m_window, *m_simulation.read([](auto& grid) { return &grid; }), param.m_renderMode }    // kinda a hack, but eh
         , m_interp{ -1, -1 }
     {
         m_window.setVsync(param.m_vsync);
+        m_renderer.setTrail(!param.m_rule.isLifeLike());    // the dying states are part of a Generations rule
+        m_simulation.setGenerationsPerTick(param.m_generationsPerTick);
 
-        // initialize the grid and the buffer
+        // initialize the grid, the renderer then reads its state without locking through the handoff
         m_simulation.write([&](Grid& grid) {
-            spdlog::info("(Application) Populating grid...");
-            grid.populate(std::clamp(param.m_startDensity, 0.0f, 1.0f));    // clamp, just a sanity check
-            auto data = grid.data();
-            m_buffer.reset(std::move(data));
+            grid.setHashLifeStep(param.m_hashLifeStep);
+            grid.setHashLifeCacheLimit(param.m_hashLifeCacheLimit);
+            grid.setActiveTileTracking(param.m_trackActiveTiles);
+            grid.setChangeTracking(!param.m_gpu && param.m_renderMode == Renderer::RenderMode::DELTA);
+            grid.setSeed(param.m_seed);
+            grid.setRule(param.m_rule);
+            grid.setBoundary(param.m_boundary);
+
+            if (param.m_resume) {
+                spdlog::info("(Application) Restoring '{}'...", param.m_resume->string());
+                grid.restore(Snapshot{ *param.m_resume });
+            } else if (param.m_pattern) {
+                loadPattern(grid, *param.m_pattern, param.m_patternOffset);
+            } else {
+                spdlog::info("(Application) Populating grid, seed: [{}]...", param.m_seed);
+                grid.populate(std::clamp(param.m_startDensity, 0.0f, 1.0f));    // clamp, just a sanity check
+            }
+            grid.publish();
+            m_handoff = &grid.handoff();
             spdlog::info("(Application) Populating grid done.");
         });
+
+        if (param.m_gpu) {
+            m_gpu.emplace(param.m_gridWidth, param.m_gridHeight);
+            m_gpu->setRule(param.m_rule);
+            if (param.m_boundary != Grid::Boundary::TORUS) {
+                spdlog::warn("(Application) The GPU simulation only wraps around, ignoring the boundary");
+            }
+            m_gpu->load(m_handoff->acquire().m_cells);
+        }
+
+        if (param.m_statsFile) {
+            openStatsFile(*param.m_statsFile);
+        }
+
+        m_snapshotFile  = param.m_snapshotFile;
+        m_levelOfDetail = !param.m_gpu && param.m_levelOfDetail;
+        if (param.m_checkpointInterval > 0 && !m_gpu) {
+            m_simulation.setCheckpoint(m_snapshotFile, param.m_checkpointInterval);
+        }
+        if (!m_gpu) {
+            m_simulation.setCycleAction(param.m_cycleAction);
+            m_simulation.setCensus(param.m_census, param.m_censusHistory);
+        }
+        if (param.m_jumpTo > 0) {
+            edit(Simulation::JumpTo{ param.m_jumpTo });
+        }
     }
 
     static glfw_cpp::Instance::Handle glfwInit()
@@ -92,26 +174,52 @@ public:
 
     void run()
     {
+        AllocCounter::setTrack(AllocCounter::Track::FRAME);
+
+        if (m_gpu) {
+            runGpu();
+            return;
+        }
+
         // launch the simulation
-        m_simulation.launch([this](Grid& grid) {
-            m_buffer.updateBuffer([&](auto& data) {
-                data = grid.data();
-            });
-        });
+        m_simulation.launch([](Grid& grid) { grid.publish(); });
 
         // render the grid
         m_window.run([this, timeSum = 0.0](auto&& events) mutable {
+            auto frameTimer = PhaseStats::measure(PhaseStats::Phase::FRAME);
+
             handleEvents(std::move(events));
 
-            const auto& front = m_buffer.swapBuffers();
+            const auto& front = m_handoff->acquire();    // leased until the next frame
             m_renderer.render(m_window, front, m_simulation.isPaused());
+            drawStatsOverlay();
+
+            const auto& [xStart, xEnd, yStart, yEnd] = m_renderer.getVisibleBorder();
+            m_simulation.setViewport({ xStart, xEnd, yStart, yEnd });
+            if (m_levelOfDetail) {
+                m_simulation.setLevelOfDetail(m_renderer.levelsOfDetail());
+            }
 
             const auto fps = 1.0 / m_window.deltaTime();
             const auto tps = m_simulation.getTickRate();
 
-            // update title every 1 seconds
+            // update title every 1 seconds, along with the progress of a fast-forward
             if ((timeSum += m_window.deltaTime()) > 1.0) {
-                m_window.updateTitle(std::format("{} [{:.2f}FPS|{:.2f}TPS]", s_defaultTitle, fps, tps));
+                auto title = std::format("{} [{:.2f}FPS|{:.2f}TPS]", s_defaultTitle, fps, tps);
+                if (const auto progress = m_simulation.getFastForwardProgress()) {
+                    title += std::format(
+                        " fast-forward {}/{} ({:.0f}%)", progress->m_generation, progress->m_to, 100 * progress->fraction()
+                    );
+                }
+                if (const auto cycle = m_simulation.getCycle()) {
+                    title += std::format(" period {} since generation {}", cycle->m_period, cycle->m_since);
+                }
+                m_window.updateTitle(title);
+                auto rates = std::format("FPS {:.2f}  TPS {:.2f}  GEN {}", fps, tps, m_simulation.getGeneration());
+                if (const auto census = m_simulation.getCensus()) {
+                    rates += std::format("  POP {} +{} -{}", census->m_population, census->m_births, census->m_deaths);
+                }
+                updateStats(rates);
                 timeSum = 0.0;
             }
 
@@ -122,6 +230,40 @@ public:
         m_simulation.stop();
     }
 
+    // the simulation thread is never launched, the GPU steps right before the frame is drawn on the render thread;
+    // Simulation is still used for the pause state, the delay and the number of generations per tick
+    void runGpu()
+    {
+        m_window.run([this, timeSum = 0.0, stepTime = 0.0, lastGeneration = std::uint64_t{ 0 }](auto&& events) mutable {
+            auto frameTimer = PhaseStats::measure(PhaseStats::Phase::FRAME);
+
+            handleEvents(std::move(events));
+
+            const auto delay = (double)m_simulation.getDelay() / 1000.0;
+            if (!m_simulation.isPaused() && (stepTime += m_window.deltaTime()) >= delay) {
+                auto                      timer = PhaseStats::measure(PhaseStats::Phase::UPDATE);
+                AllocCounter::ScopedTrack track{ AllocCounter::Track::TICK };
+                m_gpu->step(m_simulation.getGenerationsPerTick());
+                stepTime = 0.0;
+            }
+            m_renderer.render(m_window, m_gpu->state(), m_simulation.isPaused());
+            drawStatsOverlay();
+
+            // update title every 1 seconds
+            if ((timeSum += m_window.deltaTime()) > 1.0) {
+                const auto fps = 1.0 / m_window.deltaTime();
+                const auto gps = (double)(m_gpu->generation() - std::min(lastGeneration, m_gpu->generation())) / timeSum;
+                m_window.updateTitle(std::format("{} [{:.2f}FPS|{:.2f}GPS]", s_defaultTitle, fps, gps));
+                updateStats(std::format("FPS {:.2f}  GPS {:.2f}", fps, gps));
+
+                lastGeneration = m_gpu->generation();
+                timeSum        = 0.0;
+            }
+
+            m_wm.pollEvents();
+        });
+    }
+
 private:
     class InterpolationHelper
     {
@@ -132,48 +274,16 @@ private:
         {
         }
 
-        void interpolate(int x, int y, std::invocable<int, int> auto&& fn)
+        // `fn(x1, y1, x2, y2)` is given the segment from the last point to this one, if it moved
+        void interpolate(int x, int y, std::invocable<int, int, int, int> auto&& fn)
         {
-            const int xDelta = x - m_xLast;
-            const int yDelta = y - m_yLast;
-
-            if (xDelta == 0 && yDelta == 0) {
+            if (x == m_xLast && y == m_yLast) {
                 return;
             }
 
-            const auto grad{ (float)yDelta / (float)xDelta };
-            const auto grad_inv{ (float)xDelta / (float)yDelta };
-
-            int x1 = std::exchange(m_xLast, x);
-            int y1 = std::exchange(m_yLast, y);
-            int x2 = x;
-            int y2 = y;
-
-            if (x1 > x2) {
-                std::swap(x1, x2);
-                std::swap(y1, y2);
-            }
-
-            // TODO: use a more sophisticated algorithm
-            if (std::abs(grad) <= 1.0f) {
-                if (x1 > x2) {
-                    std::swap(x1, x2);
-                    std::swap(y1, y2);
-                }
-                for (int col{ x1 }; col <= x2; ++col) {
-                    const auto row{ static_cast<int>(grad * (col - x1) + y1) };
-                    fn(col, row);
-                }
-            } else {
-                if (y1 > y2) {
-                    std::swap(x1, x2);
-                    std::swap(y1, y2);
-                }
-                for (int row{ y1 }; row <= y2; ++row) {
-                    const auto col{ static_cast<int>(grad_inv * (row - y1) + x1) };
-                    fn(col, row);
-                }
-            }
+            const int x1 = std::exchange(m_xLast, x);
+            const int y1 = std::exchange(m_yLast, y);
+            fn(x1, y1, x, y);
         }
 
     private:
@@ -183,6 +293,8 @@ private:
 
     static constexpr std::string_view s_defaultTitle = "Game of Life";
 
+    static constexpr std::uint64_t s_fastForwardGenerations = 1000;    // on N
+
     glfw_cpp::Instance::Handle m_glfw;
     glfw_cpp::WindowManager    m_wm;
     glfw_cpp::Window           m_window;
@@ -197,7 +309,189 @@ private:
 
     std::pair<double, double> m_lastCursor = {};
 
-    DoubleBufferAtomic<Grid::Grid_type> m_buffer;
+    Grid::Handoff_type*          m_handoff = nullptr;    // owned by the Grid, only the consumer side is used here
+    std::optional<GpuSimulation> m_gpu;
+
+    bool m_levelOfDetail = false;    // the grid builds the levels of the density pyramid the zoom asks for
+
+    struct FileCloser
+    {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    std::optional<StatsOverlay>            m_statsOverlay;    // created the first time it is shown
+    bool                                   m_showStats  = false;
+    std::unique_ptr<std::FILE, FileCloser> m_statsFile;
+    bool                                   m_statsJson  = false;
+    PhaseStats::Clock::time_point          m_statsStart = PhaseStats::Clock::now();
+    std::filesystem::path                  m_snapshotFile;
+
+    static void loadPattern(Grid& grid, const std::filesystem::path& path, std::optional<std::pair<int, int>> offset)
+    {
+        spdlog::info("(Application) Loading pattern '{}'...", path.string());
+
+        const auto pattern = Pattern{ path };
+        spdlog::info(
+            "(Application) Pattern is {}x{} ({}), rule: [{}]",
+            pattern.width(),
+            pattern.height(),
+            pattern.formatName(),
+            pattern.rule().empty() ? "unspecified" : pattern.rule()
+        );
+        if (pattern.width() > grid.width() || pattern.height() > grid.height()) {
+            spdlog::warn("(Application) Pattern is larger than the grid, the cells outside of it are dropped");
+        }
+
+        // the rule of a pattern may be written in another notation, or one that isn't supported at all
+        auto isSameRule = [&] {
+            try {
+                return Rule{ pattern.rule() } == grid.rule();
+            } catch (const std::exception&) {
+                return false;
+            }
+        };
+        if (!pattern.rule().empty() && !isSameRule()) {
+            spdlog::warn(
+                "(Application) Pattern is meant for rule [{}], it runs under rule [{}]", pattern.rule(), grid.rule().name()
+            );
+        }
+
+        if (offset) {
+            grid.load(pattern, offset->first, offset->second);
+        } else {
+            grid.load(pattern);
+        }
+    }
+
+    void openStatsFile(const std::filesystem::path& path)
+    {
+        m_statsFile.reset(std::fopen(path.c_str(), "w"));
+        if (!m_statsFile) {
+            spdlog::error("(Application) Failed to open stats file '{}', phase timings won't be saved", path.string());
+            return;
+        }
+
+        m_statsJson = path.extension() == ".json";
+        if (!m_statsJson) {
+            PhaseStats::writeCsvHeader(m_statsFile.get());
+        }
+        spdlog::info("(Application) Saving phase timings to '{}'", path.string());
+    }
+
+    // called once per second: the timings of the last second go to the overlay and the stats file
+    void updateStats(std::string_view rates)
+    {
+        const auto summaries   = PhaseStats::drain();
+        const auto traffics    = PhaseStats::drainTraffic();
+        const auto allocations = AllocCounter::drain();
+
+        if (m_statsFile) {
+            const auto time = std::chrono::duration<double>(PhaseStats::Clock::now() - m_statsStart).count();
+            if (m_statsJson) {
+                PhaseStats::writeJson(m_statsFile.get(), time, summaries, traffics, allocations);
+            } else {
+                PhaseStats::writeCsv(m_statsFile.get(), time, summaries);
+            }
+        }
+
+        if (m_showStats) {
+            if (!m_statsOverlay) {
+                m_statsOverlay.emplace();
+            }
+            // the per worker bandwidth of each node, only recorded with the workers pinned
+            auto line = std::string{ rates };
+            for (std::size_t node = 0; node < PhaseStats::s_maxNodes; ++node) {
+                if (traffics[node].m_bytes > 0) {
+                    line += std::format("  N{} {:.1f}GB/s", node, traffics[node].gbPerSecond());
+                }
+            }
+            // the steady state should stay at 0 on both, the once per second formatting here aside
+            if constexpr (AllocCounter::s_enabled) {
+                auto perCount = [&](AllocCounter::Track track, PhaseStats::Phase phase) {
+                    const auto count = summaries[(std::size_t)phase].m_count;
+                    return (double)allocations[(std::size_t)track] / (double)std::max(count, std::uint64_t{ 1 });
+                };
+                line += std::format(
+                    "  ALLOC {:.1f}/tick {:.1f}/frame",
+                    perCount(AllocCounter::Track::TICK, PhaseStats::Phase::UPDATE),
+                    perCount(AllocCounter::Track::FRAME, PhaseStats::Phase::FRAME)
+                );
+            }
+            m_statsOverlay->update(summaries, line);
+        }
+    }
+
+    // the overlay only shows up on the next update, after a second at most
+    void drawStatsOverlay()
+    {
+        if (m_showStats && m_statsOverlay) {
+            const auto& dim = m_window.properties().m_dimension;
+            m_statsOverlay->draw(dim.m_width, dim.m_height);
+        }
+    }
+
+    // the edits go through the command queue of the simulation so the input never waits for a tick, except with the
+    // GPU where the state lives on this thread
+    void edit(Simulation::Command command)
+    {
+        if (!m_gpu) {
+            m_simulation.post(std::move(command));
+            return;
+        }
+
+        auto set = [this](int x, int y, Grid::Cell cell) {
+            if (x >= 0 && x < m_gpu->width() && y >= 0 && y < m_gpu->height()) {
+                m_gpu->set(x, y, cell);
+            }
+        };
+
+        std::visit(
+            [&](auto& cmd) {
+                using C = std::decay_t<decltype(cmd)>;
+                if constexpr (std::same_as<C, Simulation::PaintCell>) {
+                    set(cmd.m_x, cmd.m_y, cmd.m_cell);
+                } else if constexpr (std::same_as<C, Simulation::PaintLine>) {
+                    Simulation::forEachCellOnLine(cmd.m_x1, cmd.m_y1, cmd.m_x2, cmd.m_y2, [&](int x, int y) {
+                        set(x, y, cmd.m_cell);
+                    });
+                } else if constexpr (std::same_as<C, Simulation::Clear>) {
+                    m_gpu->clear();
+                } else if constexpr (std::same_as<C, Simulation::Populate>) {
+                    m_simulation.write([&](Grid& grid) {    // the simulation thread is not running
+                        spdlog::info("(Application) Populating grid...");
+                        grid.populate(cmd.m_density);
+
+                        Grid::Grid_type data;
+                        grid.copyTo(data);
+                        m_gpu->load(data);
+                        spdlog::info("(Application) Populating grid done.");
+                    });
+                } else if constexpr (std::same_as<C, Simulation::SetPause>) {
+                    m_simulation.setPause(cmd.m_pause);
+                } else if constexpr (std::same_as<C, Simulation::Save>) {
+                    spdlog::warn("(Application) Snapshots of the GPU state are not supported");
+                } else if constexpr (std::same_as<C, Simulation::Restore>) {
+                    m_simulation.write([&](Grid& grid) {
+                        try {
+                            grid.restore(Snapshot{ cmd.m_path });
+                        } catch (const std::exception& e) {
+                            spdlog::error("(Application) Failed to restore '{}': {}", cmd.m_path.string(), e.what());
+                            return;
+                        }
+
+                        Grid::Grid_type data;
+                        grid.copyTo(data, true);
+                        m_gpu->load(data);
+                    });
+                } else if constexpr (std::same_as<C, Simulation::FastForward>) {
+                    m_gpu->step((int)std::min<std::uint64_t>(cmd.m_generations, std::numeric_limits<int>::max()));
+                } else if constexpr (std::same_as<C, Simulation::JumpTo>) {
+                    spdlog::warn("(Application) The GPU simulation doesn't count generations, can't jump to one");
+                }
+            },
+            command
+        );
+    }
 
     void handleEvents(std::deque<glfw_cpp::Event>&& events)
     {
@@ -290,23 +584,15 @@ private:
         using M = glfw_cpp::MouseButton;
         if (buttons.isPressed(M::LEFT)) {
             if (m_previouslyLeftPressed) {
-                m_simulation.write([this, x, y](Grid& grid) {
-                    m_interp.interpolate(x, y, [&](int col, int row) {
-                        if (grid.isInBound(col, row)) {
-                            grid.get(col, row) = Grid::LIVE_STATE;
-                        };
-                    });
+                m_interp.interpolate(x, y, [&](int x1, int y1, int x2, int y2) {
+                    edit(Simulation::PaintLine{ x1, y1, x2, y2, Grid::LIVE_STATE });
                 });
             }
             m_previouslyLeftPressed = true;
         } else if (buttons.isPressed(M::RIGHT)) {
             if (m_previouslyRightPressed) {
-                m_simulation.write([this, x, y](Grid& grid) {
-                    m_interp.interpolate(x, y, [&](int col, int row) {
-                        if (grid.isInBound(col, row)) {
-                            grid.get(col, row) = Grid::DEAD_STATE;
-                        };
-                    });
+                m_interp.interpolate(x, y, [&](int x1, int y1, int x2, int y2) {
+                    edit(Simulation::PaintLine{ x1, y1, x2, y2, Grid::DEAD_STATE });
                 });
             }
             m_previouslyRightPressed = true;
@@ -341,32 +627,20 @@ private:
 
         if (button == M::LEFT && state == S::PRESS) {
             m_previouslyPaused = m_simulation.isPaused();
-            m_simulation.setPause(true);
-            m_simulation.wakeUp();
-
-            m_simulation.write([x, y](Grid& grid) {
-                if (grid.isInBound(x, y)) {
-                    grid.get(x, y) = Grid::LIVE_STATE;
-                };
-            });
+            edit(Simulation::SetPause{ true });
+            edit(Simulation::PaintCell{ x, y, Grid::LIVE_STATE });
             m_interp = InterpolationHelper{ x, y };
         } else if (button == M::LEFT && state == S::RELEASE) {
-            m_simulation.setPause(m_previouslyPaused);
+            edit(Simulation::SetPause{ m_previouslyPaused });
         }
 
         if (button == M::RIGHT && state == S::PRESS) {
             m_previouslyPaused = m_simulation.isPaused();
-            m_simulation.setPause(true);
-            m_simulation.wakeUp();
-
-            m_simulation.write([x, y](Grid& grid) {
-                if (grid.isInBound(x, y)) {
-                    grid.get(x, y) = Grid::DEAD_STATE;
-                };
-            });
+            edit(Simulation::SetPause{ true });
+            edit(Simulation::PaintCell{ x, y, Grid::DEAD_STATE });
             m_interp = InterpolationHelper{ x, y };
         } else if (button == M::RIGHT && state == S::RELEASE) {
-            m_simulation.setPause(m_previouslyPaused);
+            edit(Simulation::SetPause{ m_previouslyPaused });
         }
     }
 
@@ -398,7 +672,17 @@ private:
                 m_window.requestClose();
                 break;
             case K::U:
-                m_simulation.forceUpdate();
+                if (m_gpu) {
+                    m_gpu->step(m_simulation.getGenerationsPerTick());
+                } else {
+                    m_simulation.forceUpdate();
+                }
+                break;
+            case K::N:
+                edit(Simulation::FastForward{ s_fastForwardGenerations });
+                break;
+            case K::ESCAPE:
+                m_simulation.cancelFastForward();
                 break;
             case K::F:
                 m_renderer.fitToWindow();
@@ -406,16 +690,23 @@ private:
             case K::G:
                 m_renderer.cycleGridMode();
                 break;
+            case K::T:
+                m_renderer.setTrail(!m_renderer.isDrawingTrail());
+                break;
+            case K::F3:
+                m_showStats = !m_showStats;
+                break;
             case K::R:
-                m_simulation.write(&Grid::clear);
+                edit(Simulation::Clear{});
                 break;
             case K::P:
-                m_simulation.write([](Grid& grid) {
-                    spdlog::info("(Application) Populating grid...");
-                    auto density = Grid::getRandomProbability() * 0.6f + 0.2f;
-                    grid.populate(density);
-                    spdlog::info("(Application) Populating grid done.");
-                });
+                edit(Simulation::Populate{});
+                break;
+            case K::F5:
+                edit(Simulation::Save{ m_snapshotFile });
+                break;
+            case K::F9:
+                edit(Simulation::Restore{ m_snapshotFile });
                 break;
             case K::SPACE:
                 m_simulation.togglePause();
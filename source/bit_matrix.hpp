@@ -0,0 +1,245 @@
+#ifndef BIT_MATRIX_HPP_K7QF3N2A
+#define BIT_MATRIX_HPP_K7QF3N2A
+
+#include "mapped_file.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Row-major matrix of bits, one bit per cell and 64 cells per word. Bit `b` of word `i` in a row is the cell at column
+// `i * 64 + b`. Bits past the width in the last word of a row are always kept at zero.
+//
+// The words are either in memory or in a file mapped into memory (see the constructor taking a path), which then may be
+// much larger than the memory: only the pages being worked on need to be resident, see file().
+class BitMatrix
+{
+public:
+    using Word_type = std::uint64_t;
+
+    static constexpr ssize_t s_wordBits = 64;
+
+    BitMatrix() = default;
+
+    BitMatrix(
+        ssize_t width,
+        ssize_t height
+    )
+        : m_width{ width }
+        , m_height{ height }
+        , m_wordsPerRow{ (width + s_wordBits - 1) / s_wordBits }
+        , m_words((std::size_t)(m_wordsPerRow * height), 0)
+        , m_data{ m_words.data() }
+    {
+    }
+
+    // all dead, in a new file at `path` (replaced if it exists); the rows simply follow each other in the file
+    BitMatrix(
+        ssize_t                      width,
+        ssize_t                      height,
+        const std::filesystem::path& path
+    )
+        : m_width{ width }
+        , m_height{ height }
+        , m_wordsPerRow{ (width + s_wordBits - 1) / s_wordBits }
+        , m_file{ MappedFile::create(path, (std::size_t)(m_wordsPerRow * height) * sizeof(Word_type)) }
+        , m_data{ reinterpret_cast<Word_type*>(m_file->writableBytes().data()) }    // mmap() is page aligned
+    {
+    }
+
+    BitMatrix(BitMatrix&& other) noexcept { swap(other); }
+
+    BitMatrix& operator=(BitMatrix&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    BitMatrix(const BitMatrix&)            = delete;
+    BitMatrix& operator=(const BitMatrix&) = delete;
+
+    bool get(ssize_t col, ssize_t row) const
+    {
+        if (col < 0 || row < 0 || col >= m_width || row >= m_height) {
+            throw std::out_of_range{ "out of bound" };
+        }
+        return (this->row(row)[col / s_wordBits] >> (col % s_wordBits)) & 1;
+    }
+
+    void set(ssize_t col, ssize_t row, bool value)
+    {
+        if (col < 0 || row < 0 || col >= m_width || row >= m_height) {
+            throw std::out_of_range{ "out of bound" };
+        }
+
+        auto&           word = this->row(row)[col / s_wordBits];
+        const Word_type mask = Word_type{ 1 } << (col % s_wordBits);
+        word                 = value ? (word | mask) : (word & ~mask);
+    }
+
+    Word_type*       row(ssize_t row) { return m_data + row * m_wordsPerRow; }
+    const Word_type* row(ssize_t row) const { return m_data + row * m_wordsPerRow; }
+
+    // compute the next generation of a row from the rows above and below it (wrap-around on both edges), using a
+    // bitwise full-adder tree to count the neighbors of 64 cells at once. bit n of `birth` (`survival`): a dead (live)
+    // cell is live on n neighbors, see Rule
+    void nextRow(
+        const Word_type* up,
+        const Word_type* mid,
+        const Word_type* down,
+        Word_type*       out,
+        std::uint16_t    birth,
+        std::uint16_t    survival
+    ) const
+    {
+        // Conway's keeps its hand minimized expression, twice as fast as matching the counts one by one
+        if (birth == s_conwayBirth && survival == s_conwaySurvival) {
+            nextRow(up, mid, down, out, [](const Counts& counts, Word_type cells) {
+                // live on exactly 3 neighbors, or on 2 neighbors if already live
+                return ~counts.m_s3 & ~counts.m_s2 & counts.m_s1 & (counts.m_s0 | cells);
+            });
+            return;
+        }
+
+        // only the counts the rule cares about are matched against
+        std::array<int, 9> birthCounts;
+        std::array<int, 9> survivalCounts;
+        std::size_t        numBirthCounts    = 0;
+        std::size_t        numSurvivalCounts = 0;
+        for (int n = 0; n <= 8; ++n) {
+            if ((birth >> n) & 1) {
+                birthCounts[numBirthCounts++] = n;
+            }
+            if ((survival >> n) & 1) {
+                survivalCounts[numSurvivalCounts++] = n;
+            }
+        }
+
+        nextRow(up, mid, down, out, [&](const Counts& counts, Word_type cells) {
+            Word_type born = 0;
+            for (std::size_t c = 0; c < numBirthCounts; ++c) {
+                born |= counts.equal(birthCounts[c]);
+            }
+            Word_type survived = 0;
+            for (std::size_t c = 0; c < numSurvivalCounts; ++c) {
+                survived |= counts.equal(survivalCounts[c]);
+            }
+            return (born & ~cells) | (survived & cells);
+        });
+    }
+
+    // the 4-bit neighbor counts (s3 s2 s1 s0) of 64 cells
+    struct Counts
+    {
+        Word_type m_s0, m_s1, m_s2, m_s3;
+
+        // the cells with exactly n neighbors; n is at most 8, so s3 and s2 are never both set
+        Word_type equal(int n) const
+        {
+            const auto low = (n & 1 ? m_s0 : ~m_s0) & (n & 2 ? m_s1 : ~m_s1);
+            switch (n >> 2) {
+            case 0: return low & ~m_s2 & ~m_s3;
+            case 1: return low & m_s2;
+            default: return low & m_s3;
+            }
+        }
+    };
+
+    // the counts of the 64 cells of `mid`, from the words above and below it and from the three rows shifted by a cell:
+    // `west` holds the west neighbor of every cell (the row shifted towards the east), `east` the east one
+    static Counts count(
+        Word_type upWest,
+        Word_type up,
+        Word_type upEast,
+        Word_type west,
+        Word_type east,
+        Word_type downWest,
+        Word_type down,
+        Word_type downEast
+    )
+    {
+        const auto [u0, u1] = fullAdd(upWest, up, upEast);
+        const auto [m0, m1] = halfAdd(west, east);
+        const auto [d0, d1] = fullAdd(downWest, down, downEast);
+
+        // sum the three 2-bit partial counts into the 4-bit count (s3 s2 s1 s0)
+        const auto [s0, c0] = fullAdd(u0, m0, d0);
+        const auto [t0, t1] = fullAdd(u1, m1, d1);
+        const auto [s1, c1] = halfAdd(t0, c0);
+        const auto [s2, s3] = halfAdd(t1, c1);
+        return { s0, s1, s2, s3 };
+    }
+
+    // return pair of width, height
+    std::pair<ssize_t, ssize_t> dimension() const { return { m_width, m_height }; }
+
+    ssize_t width() const { return m_width; }
+    ssize_t height() const { return m_height; }
+    ssize_t wordsPerRow() const { return m_wordsPerRow; }
+
+    std::span<const Word_type> data() const { return { m_data, (std::size_t)(m_wordsPerRow * m_height) }; }
+    std::span<Word_type>       base() { return { m_data, (std::size_t)(m_wordsPerRow * m_height) }; }
+
+    // the mapping of the words, if they are in a file
+    const MappedFile* file() const { return m_file ? &*m_file : nullptr; }
+
+    void swap(BitMatrix& other) noexcept
+    {
+        std::swap(m_width, other.m_width);
+        std::swap(m_height, other.m_height);
+        std::swap(m_wordsPerRow, other.m_wordsPerRow);
+        std::swap(m_words, other.m_words);    // the buffer moves along, m_data stays valid
+        std::swap(m_file, other.m_file);
+        std::swap(m_data, other.m_data);
+    }
+
+private:
+    static constexpr std::uint16_t s_conwayBirth    = 1 << 3;
+    static constexpr std::uint16_t s_conwaySurvival = 1 << 2 | 1 << 3;
+
+    ssize_t                   m_width       = 0;
+    ssize_t                   m_height      = 0;
+    ssize_t                   m_wordsPerRow = 0;
+    std::vector<Word_type>    m_words;
+    std::optional<MappedFile> m_file;    // instead of m_words
+    Word_type*                m_data = nullptr;
+
+    // `next(counts, cells)` is the next state of the 64 cells of a word
+    template <typename Next>
+    void nextRow(const Word_type* up, const Word_type* mid, const Word_type* down, Word_type* out, Next&& next) const
+    {
+        const auto lastWord = m_wordsPerRow - 1;
+        const auto lastBit  = (m_width - 1) % s_wordBits;
+
+        // the cell at column 0 and the cell at column width-1 are neighbors
+        auto westCarry = [&](const Word_type* row) { return (row[lastWord] >> lastBit) & 1; };
+        auto eastCarry = [&](const Word_type* row) { return (row[0] & 1) << lastBit; };
+
+        for (ssize_t i = 0; i < m_wordsPerRow; ++i) {
+            // clang-format off
+            auto west = [&](const Word_type* row) { return (row[i] << 1) | (i == 0        ? westCarry(row) : row[i - 1] >> 63); };
+            auto east = [&](const Word_type* row) { return (row[i] >> 1) | (i == lastWord ? eastCarry(row) : row[i + 1] << 63); };
+            // clang-format on
+
+            const auto counts = count(west(up), up[i], east(up), west(mid), east(mid), west(down), down[i], east(down));
+            out[i]            = next(counts, mid[i]);
+        }
+
+        out[lastWord] &= lastBit == s_wordBits - 1 ? ~Word_type{ 0 } : (Word_type{ 1 } << (lastBit + 1)) - 1;
+    }
+
+    static std::pair<Word_type, Word_type> halfAdd(Word_type a, Word_type b) { return { a ^ b, a & b }; }
+
+    static std::pair<Word_type, Word_type> fullAdd(Word_type a, Word_type b, Word_type c)
+    {
+        const auto ab = a ^ b;
+        return { ab ^ c, (a & b) | (c & ab) };
+    }
+};
+
+#endif /* end of include guard: BIT_MATRIX_HPP_K7QF3N2A */
@@ -0,0 +1,124 @@
+#ifndef CELL_INSTANCES_HPP_VX3M7QAT
+#define CELL_INSTANCES_HPP_VX3M7QAT
+
+#include "game.hpp"
+#include "image_texture.hpp"
+#include "phase_stats.hpp"
+#include "shader.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+// One instance per visible live cell, the quad itself is generated in the vertex shader from gl_VertexID (see
+// cell_instanced.vert). The only buffer is the list of cell coordinates, so memory grows with the live cells on screen
+// instead of with the grid size like the subdivided Plane does.
+//
+// NOTE: must be constructed and used on the thread owning the OpenGL context
+class CellInstances
+{
+public:
+    using Instance_type = std::array<std::uint32_t, 2>;    // column, row
+
+    CellInstances(
+        const std::filesystem::path& cellTextureDir,
+        ImageTexture::Specification  textureSpec
+    )
+        : m_texture{ ImageTexture::from(cellTextureDir, "u_tex", 0, std::move(textureSpec)).value() }    // throws on failure
+        , m_shader{ "./resources/shaders/cell_instanced.vert", "./resources/shaders/grid_shader.frag" }
+    {
+        gl::glGenVertexArrays(1, &m_vao);
+        gl::glGenBuffers(1, &m_vbo);
+
+        gl::glBindVertexArray(m_vao);
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, m_vbo);
+
+        // a_cell, advanced once per instance
+        gl::glEnableVertexAttribArray(0);
+        gl::glVertexAttribIPointer(0, 2, gl::GL_UNSIGNED_INT, sizeof(Instance_type), (void*)(0));
+        gl::glVertexAttribDivisor(0, 1);
+
+        gl::glBindVertexArray(0);
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, 0);
+
+        m_shader.use();
+        m_shader.setUniform("u_color", m_color);
+        m_texture.activate(m_shader);
+    }
+
+    CellInstances(const CellInstances&)            = delete;
+    CellInstances& operator=(const CellInstances&) = delete;
+    CellInstances(CellInstances&&)                 = delete;
+    CellInstances& operator=(CellInstances&&)      = delete;
+
+    ~CellInstances()
+    {
+        gl::glDeleteVertexArrays(1, &m_vao);
+        gl::glDeleteBuffers(1, &m_vbo);
+    }
+
+    // exclusive: [xStart, xEnd), [yStart, yEnd), collect the live cells and upload them
+    void update(int xStart, int xEnd, int yStart, int yEnd, const Grid::Grid_type& gridData)
+    {
+        auto prepareTimer = PhaseStats::measure(PhaseStats::Phase::PREPARE);
+
+        m_instances.clear();    // keeps the capacity, no allocation once the biggest frame has been seen
+
+        for (int y{ yStart }; y < yEnd; ++y) {
+            const auto* row = gridData.row(y);
+            for (int x{ xStart }; x < xEnd; ++x) {
+                if (row[x] == Grid::LIVE_STATE) {
+                    m_instances.push_back({ (std::uint32_t)x, (std::uint32_t)y });
+                }
+            }
+        }
+
+        prepareTimer.stop();
+        auto uploadTimer = PhaseStats::measure(PhaseStats::Phase::UPLOAD);
+
+        // let the driver orphan the previous storage instead of waiting for the last draw to finish reading it
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, m_vbo);
+        gl::glBufferData(
+            gl::GL_ARRAY_BUFFER,
+            static_cast<gl::GLsizeiptr>(m_instances.size() * sizeof(Instance_type)),
+            m_instances.data(),
+            gl::GL_STREAM_DRAW
+        );
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, 0);
+    }
+
+    void draw(const glm::mat4& projMat, const glm::mat4& viewMat)
+    {
+        if (m_instances.empty()) {
+            return;
+        }
+
+        auto timer = PhaseStats::measure(PhaseStats::Phase::DRAW);
+
+        m_shader.use();
+        m_shader.setUniform("u_view", viewMat);
+        m_shader.setUniform("u_projection", projMat);
+        m_texture.activate(m_shader);
+
+        gl::glBindVertexArray(m_vao);
+        gl::glDrawArraysInstanced(gl::GL_TRIANGLE_STRIP, 0, 4, (gl::GLsizei)m_instances.size());
+        gl::glBindVertexArray(0);
+    }
+
+    std::size_t count() const { return m_instances.size(); }
+
+private:
+    ImageTexture               m_texture;
+    Shader                     m_shader;
+    glm::vec3                  m_color{ 1.0f, 1.0f, 1.0f };
+    gl::GLuint                 m_vao = 0;
+    gl::GLuint                 m_vbo = 0;
+    std::vector<Instance_type> m_instances;
+};
+
+#endif /* end of include guard: CELL_INSTANCES_HPP_VX3M7QAT */
@@ -0,0 +1,124 @@
+#ifndef DELTA_TEXTURE_HPP_Q8HV2NKR
+#define DELTA_TEXTURE_HPP_Q8HV2NKR
+
+#include "game.hpp"
+#include "grid_texture.hpp"
+#include "phase_stats.hpp"
+#include "shader.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <array>
+#include <optional>
+
+// The whole grid on a GridTexture (LIVE or not, no fade) kept up to date from the changes carried by each Grid::Frame
+// (see Grid::setChangeTracking()): the changes are uploaded into a buffer orphaned every frame and drawn as points into
+// the texture, so the upload is proportional to the number of cells that changed instead of the population. The whole
+// grid is only uploaded for the first frame, or when the frame doesn't carry enough changes to catch up.
+//
+// NOTE: must be constructed and used on the thread owning the OpenGL context
+class DeltaTexture
+{
+public:
+    DeltaTexture(int width, int height, std::string uniformName, gl::GLint textureUnitNum)
+        : m_texture{ width, height, std::move(uniformName), textureUnitNum }
+        , m_shader{ "./resources/shaders/cell_delta.vert", "./resources/shaders/cell_delta.frag" }
+    {
+        gl::glGenFramebuffers(1, &m_fbo);
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, m_fbo);
+        gl::glFramebufferTexture2D(gl::GL_FRAMEBUFFER, gl::GL_COLOR_ATTACHMENT0, gl::GL_TEXTURE_2D, m_texture.id(), 0);
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, 0);
+
+        gl::glGenVertexArrays(1, &m_vao);
+        gl::glGenBuffers(1, &m_vbo);
+
+        gl::glBindVertexArray(m_vao);
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, m_vbo);
+
+        // a_change
+        gl::glEnableVertexAttribArray(0);
+        gl::glVertexAttribIPointer(0, 3, gl::GL_UNSIGNED_INT, sizeof(Grid::CellChange), (void*)(0));
+
+        gl::glBindVertexArray(0);
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, 0);
+
+        m_shader.use();
+        m_shader.setUniform("u_size", (float)width, (float)height);
+    }
+
+    DeltaTexture(const DeltaTexture&)            = delete;
+    DeltaTexture& operator=(const DeltaTexture&) = delete;
+    DeltaTexture(DeltaTexture&&)                 = delete;
+    DeltaTexture& operator=(DeltaTexture&&)      = delete;
+
+    ~DeltaTexture()
+    {
+        gl::glDeleteFramebuffers(1, &m_fbo);
+        gl::glDeleteVertexArrays(1, &m_vao);
+        gl::glDeleteBuffers(1, &m_vbo);
+    }
+
+    // bring the texture to the state of `frame`
+    void update(const Grid::Frame& frame)
+    {
+        if (m_version == frame.m_version) {
+            return;
+        }
+
+        auto timer = PhaseStats::measure(PhaseStats::Phase::UPLOAD);
+
+        const bool canCatchUp = m_version && frame.m_baseVersion <= *m_version && *m_version < frame.m_version;
+        if (!canCatchUp) {
+            const auto& cells = frame.m_cells;
+            m_texture.stream(0, 0, m_texture.width(), m_texture.height(), cells.row(0), (int)cells.stride());
+            m_version = frame.m_version;
+            m_fullUploads++;
+            return;
+        }
+
+        const auto& changes = frame.m_changes;
+        m_version           = frame.m_version;
+        if (changes.empty()) {
+            return;
+        }
+
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, m_vbo);
+        gl::glBufferData(
+            gl::GL_ARRAY_BUFFER,
+            static_cast<gl::GLsizeiptr>(changes.size() * sizeof(Grid::CellChange)),
+            changes.data(),
+            gl::GL_STREAM_DRAW
+        );
+        gl::glBindBuffer(gl::GL_ARRAY_BUFFER, 0);
+
+        // the renderer sets its own viewport every frame, but don't leave it in a weird state anyway
+        std::array<gl::GLint, 4> viewport;
+        gl::glGetIntegerv(gl::GL_VIEWPORT, viewport.data());
+
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, m_fbo);
+        gl::glViewport(0, 0, m_texture.width(), m_texture.height());
+
+        // later changes of the same cell are drawn after, and so win
+        m_shader.use();
+        gl::glBindVertexArray(m_vao);
+        gl::glDrawArrays(gl::GL_POINTS, 0, (gl::GLsizei)changes.size());
+        gl::glBindVertexArray(0);
+
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, 0);
+        gl::glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    const GridTexture& texture() const { return m_texture; }
+    std::size_t        fullUploads() const { return m_fullUploads; }
+
+private:
+    GridTexture                  m_texture;
+    Shader                       m_shader;
+    gl::GLuint                   m_fbo = 0;
+    gl::GLuint                   m_vao = 0;
+    gl::GLuint                   m_vbo = 0;
+    std::optional<std::uint64_t> m_version;    // of the frame the texture holds
+    std::size_t                  m_fullUploads = 0;
+};
+
+#endif /* end of include guard: DELTA_TEXTURE_HPP_Q8HV2NKR */
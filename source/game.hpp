@@ -1,20 +1,43 @@
 #ifndef GAME_HPP
 #define GAME_HPP
 
+#include "bit_matrix.hpp"
+#include "hashlife.hpp"
+#include "numa.hpp"
+#include "pattern.hpp"
+#include "phase_stats.hpp"
+#include "rule.hpp"
+#include "simd_kernel.hpp"
+#include "snapshot.hpp"
+#include "sparse_universe.hpp"
 #include "threadpool.hpp"
+#include "tiled_matrix.hpp"
+#include "triple_buffer_atomic.hpp"
 #include "unrolled_matrix.hpp"
 
 #include <PerlinNoise.hpp>
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
 #include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
+#include <filesystem>
+#include <format>
+#include <functional>
 #include <map>
-#include <random>
+#include <numeric>
+#include <optional>
 #include <ranges>
+#include <stdexcept>
+#include <thread>
 #include <utility>
+#include <vector>
 
 class Grid
 {
@@ -22,6 +45,34 @@ public:
     using Cell       = std::uint8_t;    // i'm planning on using all the range a byte offer
     using Coord_type = int;
     using Grid_type  = UnrolledMatrix<Cell>;    // X number of Cells inside Y number of vectors
+    using Tiled_type = TiledMatrix<Cell>;
+
+    // a cell that became LIVE (m_live = 1) or stopped being LIVE (m_live = 0)
+    struct CellChange
+    {
+        std::uint32_t m_x;
+        std::uint32_t m_y;
+        std::uint32_t m_live;
+    };
+
+    // a published state, see handoff(). with change tracking on (see setChangeTracking()), applying m_changes in order
+    // to any state from m_baseVersion to m_version (excluded) gives this one; otherwise m_baseVersion == m_version
+    //
+    // NOTE: no default member initializers, TripleBufferAtomic needs it default initializable before Grid is complete
+    struct Frame
+    {
+        Grid_type               m_cells;    // with a ghost border for the byte buffer strategies, read it by row()
+        std::vector<CellChange> m_changes;
+        std::uint64_t           m_version;
+        std::uint64_t           m_baseVersion;
+
+        // with setLevelOfDetail(), the density pyramid of m_cells: m_levels[i] has a cell per 2^(i+1) square block of
+        // cells, the share of them that is LIVE from 0 to LIVE_STATE (never 0 if one of them is). down to a single cell
+        std::vector<Grid_type> m_levels;
+    };
+
+    // the byte state handed over to the renderer, see handoff()
+    using Handoff_type = TripleBufferAtomic<Frame>;
 
     enum class BufferType
     {
@@ -33,33 +84,148 @@ public:
     {
         INTERLEAVED,
         CHUNKED,
+        BITPACKED,        // one bit per cell, the byte buffers are only filled on copyTo()
+        VECTORIZED,       // chunked, with SIMD on the interior rows
+        HASHLIFE,         // unbounded quadtree universe, the grid is only a fixed window into it (see copyTo())
+        WORK_STEALING,    // chunked, but rows are split lazily and stolen by idle workers (ThreadPool::parallelFor)
+        TILED,            // cells stored in contiguous 64x64 blocks, workers process whole blocks
+        TEMPORAL,         // advance() computes several generations per pass over a tile (see TEMPORAL_MAX_DEPTH)
+        MAPPED,           // bit-packed in a memory mapped file, updated in place strip by strip (see updateMapped())
+        SPARSE,           // unbounded universe of 64x64 chunks, only where the cells live; same window as HASHLIFE
+    };
+
+    // where the workers run and the cells are put in memory
+    enum class Placement
+    {
+        DEFAULT,    // the buffers are zeroed by the constructing thread, the workers run on any cpu
+        PINNED,     // every worker pinned to a cpu (node after node), the chunks of a pass always go to the same worker
+        NUMA,       // same as PINNED, and each band of rows of the byte buffers is first touched by the worker updating
+                    // it, so its pages are on the node of that worker (for the strategies going through chunks)
+    };
+
+    static inline const std::map<std::string, Placement> s_placementMap{
+        { "default", Placement::DEFAULT },
+        { "pinned", Placement::PINNED },
+        { "numa", Placement::NUMA },
+    };
+
+    // what the cells on the edges see past them
+    enum class Boundary
+    {
+        TORUS,       // the cells on the other side
+        DEAD,        // dead cells
+        MIRRORED,    // the edge itself, repeated
+    };
+
+    static inline const std::map<std::string, Boundary> s_boundaryMap{
+        { "torus", Boundary::TORUS },
+        { "dead", Boundary::DEAD },
+        { "mirrored", Boundary::MIRRORED },
+    };
+
+    // the population of a generation, and the cells born and died to get to it. the births and deaths of a TEMPORAL
+    // pass are the net ones over its generations, HASHLIFE only has the population. HASHLIFE and SPARSE count the whole
+    // universe, not only the grid
+    struct Census
+    {
+        std::uint64_t m_generation;
+        std::uint64_t m_population;
+        std::uint64_t m_births;
+        std::uint64_t m_deaths;
+    };
+
+    // exclusive: [xStart, xEnd), [yStart, yEnd)
+    struct Region
+    {
+        Coord_type m_xStart = 0;
+        Coord_type m_xEnd   = 0;
+        Coord_type m_yStart = 0;
+        Coord_type m_yEnd   = 0;
     };
 
     static constexpr Cell LIVE_STATE = 0xff;
     static constexpr Cell DEAD_STATE = 0x00;
 
+    static_assert(Snapshot::s_liveState == LIVE_STATE);
+    static_assert(Rule::s_live == LIVE_STATE && Rule::s_dead == DEAD_STATE);
+
+    static constexpr Coord_type TILE_SIZE          = 64;     // for active tile tracking
+    static constexpr Coord_type TEMPORAL_TILE_SIZE = 128;    // for temporal blocking, without the halo
+    static constexpr int        TEMPORAL_MAX_DEPTH = 16;     // generations per pass, also the width of the halo
+    static constexpr long       MAPPED_STRIP_BYTES = 1 << 20;    // of the file per strip of rows, at least a row
+
+    static inline const std::filesystem::path s_defaultMappedFile = "grid.bits";
+
     static inline const std::map<std::string, UpdateStrategy> s_updateStrategyMap{
         { "interleaved", UpdateStrategy::INTERLEAVED },
-        { "chunked", UpdateStrategy::CHUNKED }
+        { "chunked", UpdateStrategy::CHUNKED },
+        { "bitpacked", UpdateStrategy::BITPACKED },
+        { "vectorized", UpdateStrategy::VECTORIZED },
+        { "hashlife", UpdateStrategy::HASHLIFE },
+        { "stealing", UpdateStrategy::WORK_STEALING },
+        { "tiled", UpdateStrategy::TILED },
+        { "temporal", UpdateStrategy::TEMPORAL },
+        { "mapped", UpdateStrategy::MAPPED },
+        { "sparse", UpdateStrategy::SPARSE },
     };
 
-    Grid(const Coord_type width, const Coord_type height, UpdateStrategy updateStrategy)
-        : m_front{ width, height }
-        , m_back{ width, height }
-        , m_threadPool{ std::thread::hardware_concurrency() }
+    // `mappedFile` holds the cells of MAPPED, replaced if it exists. the bytes of MAPPED are only allocated once asked
+    // for (publish(), copyTo()) and only filled around the viewport, the bits don't have to fit in memory
+    Grid(
+        const Coord_type             width,
+        const Coord_type             height,
+        UpdateStrategy               updateStrategy,
+        std::size_t                  numThreads = std::thread::hardware_concurrency(),
+        const std::filesystem::path& mappedFile = s_defaultMappedFile,
+        Placement                    placement  = Placement::DEFAULT
+    )
+        : m_buffers{ Frame{
+              .m_cells       = updateStrategy == UpdateStrategy::MAPPED || hasByteBuffers(updateStrategy)
+                                 ? Grid_type{}
+                                 : Grid_type{ width, height },
+              .m_changes     = {},
+              .m_version     = 0,
+              .m_baseVersion = 0,
+              .m_levels      = {},
+          } }
+        , m_packedFront{ makePacked(updateStrategy, width, height, mappedFile) }
+        , m_packedBack{ updateStrategy == UpdateStrategy::BITPACKED ? BitMatrix{ width, height } : BitMatrix{} }
+        , m_tiledFront{ isTiled(updateStrategy) ? Tiled_type{ width, height } : Tiled_type{} }
+        , m_tiledBack{ isTiled(updateStrategy) ? Tiled_type{ width, height } : Tiled_type{} }
+        , m_threadPool{
+            numThreads,
+            updateStrategy == UpdateStrategy::WORK_STEALING ? ThreadPool::Mode::WORK_STEALING
+                                                            : ThreadPool::Mode::SHARED_QUEUE,
+        }
         , m_width{ width }
         , m_height{ height }
         , m_updateStrategy{ updateStrategy }
+        , m_placement{ placement }
+        , m_viewport{ 0, width, 0, height }
     {
-        spdlog::info("(Grid) Created with width: [{}], height: [{}]", width, height);
-        spdlog::info("(Grid) Using update strategy: [{}]", [&] {
-            for (const auto& [key, value] : s_updateStrategyMap) {
-                if (value == updateStrategy) {
-                    return key;
-                }
+        if (placement != Placement::DEFAULT) {
+            const auto& topology = NumaTopology::get();
+            const auto  cpus     = topology.cpus();
+            m_threadPool.pinWorkers(cpus);
+            for (std::size_t worker = 0; worker < m_threadPool.size(); ++worker) {
+                m_workerNodes.push_back(topology.nodeOf(cpus[worker % cpus.size()]));
             }
-            return std::string{ "unknown" };    // this should never happen
-        }());
+            m_workerTraffic.resize(m_threadPool.size());
+        }
+
+        if (hasByteBuffers(updateStrategy)) {
+            m_buffers.initialize([&](Frame& frame) { frame.m_cells = makeCells(); });
+        }
+
+        spdlog::info("(Grid) Created with width: [{}], height: [{}]", width, height);
+        spdlog::info("(Grid) Using update strategy: [{}]", strategyName(updateStrategy));
+
+        if (updateStrategy == UpdateStrategy::VECTORIZED) {
+            spdlog::info("(Grid) Using instruction set: [{}]", SimdKernel::instructionSetName());
+        }
+        if (updateStrategy == UpdateStrategy::MAPPED) {
+            spdlog::info("(Grid) Cells mapped from file: [{}]", mappedFile.string());
+        }
     }
 
     Grid(const Grid& other)            = delete;
@@ -67,85 +233,544 @@ public:
     Grid(Grid&& other)                 = delete;
     Grid& operator=(Grid&& other)      = delete;
 
-    template <typename T>
-    static T getRandomNumber(T min, T max)
-    {
-        thread_local static std::mt19937 mt{ static_cast<std::mt19937::result_type>(std::time(nullptr)) };
-        if constexpr (std::integral<T>) {
-            return std::uniform_int_distribution<T>{ min, max }(mt);
-        } else if constexpr (std::floating_point<T>) {
-            return std::uniform_real_distribution<T>{ min, max }(mt);
-        } else if constexpr (std::is_arithmetic_v<T>) {
-            auto real = std::uniform_real_distribution<>{ 0.0, 1.0 }(mt);
-            return min + real * (max - min);
-        } else {
-            static_assert(std::is_arithmetic_v<T>, "T must be an arithmetic type");
+    // the result only depends on the seed (see setSeed()), the density and how many times populate was called before:
+    // the noise is cached and the random number of a cell is a hash of its coordinates, so it doesn't depend on the
+    // number of threads, the order the cells are visited in nor the update strategy. without a density, one in
+    // [0.2, 0.8) is drawn from the seed and the number of calls too
+    void populate(std::optional<float> requested = std::nullopt)
+    {
+        m_generation = 0;
+        markAllTilesChanged();
+
+        const auto round   = m_populateCount++;
+        const auto key     = splitMix64(m_seed ^ splitMix64(round));
+        const auto density = requested.value_or(0.2f + 0.6f * (float)(splitMix64(key) >> 40) * 0x1p-24f);
+
+        buildNoise();
+
+        if (m_updateStrategy == UpdateStrategy::HASHLIFE) {
+            m_hashlife.load(m_width, m_height, [&](auto x, auto y) {
+                return cellRandom(key, (int)x, (int)y) < density && noiseAt((int)x, (int)y) < density;
+            });
+            return;
+        }
+
+        if (m_updateStrategy == UpdateStrategy::SPARSE) {
+            m_sparse.reset();
+            for (auto y : std::views::iota(0, m_height)) {
+                for (auto x : std::views::iota(0, m_width)) {
+                    if (cellRandom(key, x, y) < density && noiseAt(x, y) < density) {
+                        m_sparse.setCell(x, y, true);
+                    }
+                }
+            }
+            return;
+        }
+
+        process_rows([&](long y) {
+            for (auto x : std::views::iota(0l, (long)m_width)) {
+                auto spawn = cellRandom(key, (int)x, (int)y) < density && noiseAt((int)x, (int)y) < density;
+                store((int)x, (int)y, spawn ? LIVE_STATE : DEAD_STATE);
+            }
+        });
+        commitStore();
+    }
+
+    // seed of the noise and of the random numbers used by populate(), the default one is taken from the clock
+    void setSeed(std::uint64_t seed)
+    {
+        m_seed          = seed;
+        m_populateCount = 0;
+        m_perlin.reseed(static_cast<siv::PerlinNoise::seed_type>(seed));
+        m_noise.clear();
+    }
+
+    std::uint64_t seed() const { return m_seed; }
+
+    void updateState()
+    {
+        flushEdits();
+
+        bool rowsHashed = false;    // on the way, by the worker that wrote them (see setHashObserver())
+        switch (m_updateStrategy) {
+        case UpdateStrategy::BITPACKED:
+            updatePacked();
+            rowsHashed = true;
+            break;
+        case UpdateStrategy::MAPPED:
+            updateMapped();
+            rowsHashed = true;
+            break;
+        case UpdateStrategy::HASHLIFE:
+            m_generation += m_hashlife.step();
+            if (m_censusObserver) {
+                m_censusObserver({
+                    .m_generation = m_generation,
+                    .m_population = m_hashlife.population(),
+                    .m_births     = 0,
+                    .m_deaths     = 0,
+                });
+            }
+            return;
+        case UpdateStrategy::SPARSE:
+            m_sparse.step([this](long count, auto&& func) { process_indices(count, func); });
+            ++m_generation;
+            if (m_censusObserver) {
+                m_censusObserver({
+                    .m_generation = m_generation,
+                    .m_population = m_sparse.population(),
+                    .m_births     = m_sparse.births(),
+                    .m_deaths     = m_sparse.deaths(),
+                });
+            }
+            return;
+        case UpdateStrategy::VECTORIZED:
+            updateVectorized();
+            publishBack();
+            rowsHashed = true;
+            break;
+        case UpdateStrategy::TILED:
+            updateTiled();
+            m_tiledFront.swap(m_tiledBack);
+            break;
+        case UpdateStrategy::TEMPORAL:
+            updateTemporal(1);
+            publishBack();
+            break;
+        default:
+            if (m_trackActiveTiles) {
+                updateActiveTiles();
+            } else {
+                process_multi(
+                    [this](long x, long y) { updateCell(x, y); },
+                    [this](long y) {
+                        hashBackRow(y);
+                        countBackRow(y);
+                        flagBackRow(y);
+                    }
+                );
+                rowsHashed = true;
+            }
+            publishBack();
+        }
+
+        ++m_generation;
+        observeHash(rowsHashed);
+        observeCensus();
+    }
+
+    // advance the grid by `generations` generations. TEMPORAL goes through memory once per TEMPORAL_MAX_DEPTH
+    // generations instead of once per generation, the other strategies simply update that many times
+    void advance(int generations)
+    {
+        flushEdits();
+
+        if (m_updateStrategy != UpdateStrategy::TEMPORAL) {
+            for (int i = 0; i < generations; ++i) {
+                updateState();
+            }
+            return;
+        }
+
+        // past the edges of a bounded grid the halo would evolve too instead of staying what the boundary says
+        const auto maxDepth = m_boundary == Boundary::TORUS ? TEMPORAL_MAX_DEPTH : 1;
+        while (generations > 0) {
+            const auto depth = std::min(generations, maxDepth);
+            updateTemporal(depth);
+            publishBack();
+
+            m_generation += (std::uint64_t)depth;
+            generations  -= depth;
+            observeHash(false);
+            observeCensus();
         }
     }
 
-    // 0 < probability < 1
-    static bool getRandomBool(float probability)
+    // the state comes back every `period` generations (see setHashObserver()): moving ahead by a multiple of it only
+    // moves the generation counter
+    void skipCycles(std::uint64_t period, std::uint64_t cycles) { m_generation += period * cycles; }
+
+    // zeroes-out the grid
+    void clear()
     {
-        thread_local static std::mt19937 mt{ static_cast<std::mt19937::result_type>(std::time(nullptr)) };
-        return std::uniform_real_distribution<float>{}(mt) < probability;
+        m_generation = 0;
+        markAllTilesChanged();
+
+        if (m_updateStrategy == UpdateStrategy::HASHLIFE) {
+            m_hashlife.reset();
+            return;
+        }
+        if (m_updateStrategy == UpdateStrategy::SPARSE) {
+            m_sparse.reset();
+            return;
+        }
+
+        storeDead();
+        commitStore();
     }
 
-    // 0.0f < return < 1.0f
-    static float getRandomProbability()
+    // same as below, centered on the grid
+    void load(const Pattern& pattern)
     {
-        return getRandomNumber(0.0f, 1.0f);
+        load(pattern, (m_width - pattern.width()) / 2, (m_height - pattern.height()) / 2);
     }
 
-    void populate(const float density = getRandomProbability())
+    // replace the state with `pattern`, its top left cell at column `xOffset` and row `yOffset + pattern.height() - 1`
+    // (row 0 is drawn at the bottom, so the pattern is upright). whatever falls outside of the grid is dropped, the
+    // rest of the grid is dead. the bands of the pattern are decoded in parallel, straight into the grid
+    void load(const Pattern& pattern, Coord_type xOffset, Coord_type yOffset)
     {
-        process_multi([&](long x, long y) {
-            auto spawn   = shouldSpawn((int)x, (int)y, density) && getRandomBool(density);
-            m_back(x, y) = m_front(x, y) = spawn ? LIVE_STATE : DEAD_STATE;
-        });
+        m_generation = 0;
+
+        const auto top = (long)yOffset + pattern.height() - 1;
+        loadCells(pattern, [&](int x, int y) { return std::pair{ (long)xOffset + x, top - y }; });
     }
 
-    void updateState()
+    // replace the state with the one saved in `snapshot`, generation included. a snapshot of another size is aligned on
+    // the first cell of both and cropped
+    void restore(const Snapshot& snapshot)
     {
-        process_multi([this](long x, long y) {
-            auto cell    = m_front(x, y);
-            auto neigbor = checkNeighbors((int)x, (int)y);
+        if (snapshot.width() != m_width || snapshot.height() != m_height) {
+            spdlog::warn(
+                "(Grid) Restoring a {}x{} snapshot on a {}x{} grid, it is cropped",
+                snapshot.width(),
+                snapshot.height(),
+                m_width,
+                m_height
+            );
+        }
 
-            // clang-format off
-            if (cell == LIVE_STATE) {
-                if      (neigbor <  2) { m_back(x, y) = (cell == 0 || cell - 1 == 0) ? DEAD_STATE : cell - 1; }
-                else if (neigbor <= 3) { m_back(x, y) = LIVE_STATE; }
-                else                   { m_back(x, y) = (cell == 0 || cell - 1 == 0) ? DEAD_STATE : cell - 1; }
+        if (snapshot.info().m_rule != m_rule.name()) {
+            spdlog::warn(
+                "(Grid) The snapshot was saved under rule [{}], it continues under rule [{}]",
+                snapshot.info().m_rule,
+                m_rule.name()
+            );
+        }
+
+        loadCells(snapshot, [](int x, int y) { return std::pair{ (long)x, (long)y }; });
+        m_generation = snapshot.info().m_generation;
+    }
+
+    // set the state of a cell, works for every strategy. the byte buffer strategies never write to the current state
+    // since the renderer may be reading it: the first set() since the last publish copies it into the free buffer and
+    // the edits go there, they become the current state on the next publish() or update (get() doesn't see them yet)
+    void set(const Coord_type xPos, const Coord_type yPos, Cell cell)
+    {
+        switch (m_updateStrategy) {
+        case UpdateStrategy::BITPACKED:
+        case UpdateStrategy::MAPPED:
+            m_packedFront.set(xPos, yPos, cell == LIVE_STATE);
+            break;
+        case UpdateStrategy::HASHLIFE:
+            m_hashlife.setCell(xPos, yPos, cell == LIVE_STATE);
+            break;
+        case UpdateStrategy::SPARSE:
+            m_sparse.setCell(xPos, yPos, cell == LIVE_STATE);
+            break;
+        case UpdateStrategy::TILED:
+            m_tiledFront(xPos, yPos) = cell;
+            break;
+        default:
+            beginEdit();
+            back()(xPos, yPos) = cell;
+            m_rehashAll        = true;
+            m_recount          = true;
+            if (m_trackChanges) {
+                m_rowChanged[(std::size_t)yPos] = true;
+            }
+            if (m_trackActiveTiles) {
+                const auto tile    = (std::size_t)((yPos / TILE_SIZE) * m_tilesX + xPos / TILE_SIZE);
+                m_tileChanged[tile] = true;
+                m_tileVersion[tile] = m_buffers.version() + 1;
+            }
+        }
+    }
+
+    // make the current state available through handoff(). the byte buffer strategies publish every generation on their
+    // own so this does nothing for them, the others get their state converted into the free buffer first (copyTo)
+    void publish()
+    {
+        if (hasByteBuffers(m_updateStrategy)) {
+            flushEdits();
+            return;
+        }
+        copyTo(back());
+        std::fill(m_rowChanged.begin(), m_rowChanged.end(), true);    // nothing says where it differs
+        publishBack();
+    }
+
+    // consumer side of the byte state, meant to be held by the renderer: it only ever calls acquire() on it, which
+    // doesn't need the lock the Grid is under, and reads the returned buffer while the next generation is computed in
+    // another one. no cell is copied between the two threads for the byte buffer strategies
+    Handoff_type& handoff() { return m_buffers; }
+
+    // copy the current state into `dest` as bytes; this is the only place the bit-packed state gets unpacked, the tiled
+    // one gets untiled, and the universes get rasterized. the universes and MAPPED, whose grid may not fit in memory,
+    // only get the part around the viewport unless `whole`
+    //
+    // NOTE: the window into the universes (HASHLIFE, SPARSE) is fixed to [0, width) x [0, height) of them: the cells
+    //       that grow or fly past it are still simulated, and counted by the census, but never shown; nothing pans it
+    void copyTo(Grid_type& dest, bool whole = false)
+    {
+        if (hasByteBuffers(m_updateStrategy)) {
+            dest = m_editing ? back() : front();
+            return;
+        }
+
+        if (dest.width() != m_width || dest.height() != m_height) {
+            dest = Grid_type{ m_width, m_height };
+        }
+
+        if (m_updateStrategy == UpdateStrategy::HASHLIFE || m_updateStrategy == UpdateStrategy::SPARSE) {
+            const auto [xStart, xEnd, yStart, yEnd] = whole ? Region{ 0, m_width, 0, m_height } : paddedViewport();
+            for (auto y : std::views::iota(yStart, yEnd)) {
+                std::fill_n(dest.row(y) + xStart, xEnd - xStart, DEAD_STATE);
+            }
+
+            auto live = [&](auto x, auto y) { dest(x, y) = LIVE_STATE; };
+            if (m_updateStrategy == UpdateStrategy::HASHLIFE) {
+                m_hashlife.forEachLive(xStart, xEnd, yStart, yEnd, live);
             } else {
-                if      (neigbor == 3) { m_back(x, y) = LIVE_STATE; }
-                else                   { m_back(x, y) = (cell == 0 || cell - 1 == 0) ? DEAD_STATE : cell - 1; }
-            }
-
-            // // incorrect but interesting result
-            // if (cell == LIVE_STATE) {
-            //     if      (neigbor <  2) { m_back(x, y) -= 1; }
-            //     else if (neigbor <= 3) { m_back(x, y) = LIVE_STATE; }
-            //     else                   { m_back(x, y) -= 1; }
-            // } else {
-            //     if      (neigbor == 3) { m_back(x, y) = LIVE_STATE; }
-            //     else                   { m_back(x, y) = (cell == 0 || cell - 1 == 0) ? DEAD_STATE : cell - 1; }
-            // }
-            // clang-format on
+                m_sparse.forEachLive(xStart, xEnd, yStart, yEnd, live);    // only the chunks in the viewport
+            }
+            return;
+        }
+
+        if (m_updateStrategy == UpdateStrategy::TILED) {
+            process_rows([&](long y) {
+                auto* row = dest.row(y);
+                for (long x = 0; x < m_width; x += Tiled_type::s_tileSize) {
+                    const auto count = std::min((long)Tiled_type::s_tileSize, m_width - x);
+                    std::memcpy(row + x, m_tiledFront.rowSegment(x, y), (std::size_t)count);
+                }
+            });
+            return;
+        }
+
+        const auto [xStart, xEnd, yStart, yEnd] = whole || m_updateStrategy != UpdateStrategy::MAPPED
+                                                    ? Region{ 0, m_width, 0, m_height }
+                                                    : paddedViewport();
+        process_indices(yEnd - yStart, [&](long i) {
+            const auto  y     = yStart + i;
+            const auto* words = m_packedFront.row(y);
+            auto*       row   = dest.row(y);
+            for (long x = xStart; x < xEnd; ++x) {
+                const auto bit = (words[x / BitMatrix::s_wordBits] >> (x % BitMatrix::s_wordBits)) & 1;
+                row[x]         = bit ? LIVE_STATE : DEAD_STATE;
+            }
         });
+    }
 
-        m_front.swap(m_back);
+    // the part of the grid that is currently being looked at, strategies that can't cheaply produce the whole grid
+    // (HASHLIFE, SPARSE, MAPPED) only produce this part on copyTo()
+    void setViewport(Region viewport)
+    {
+        viewport.m_xStart = std::clamp(viewport.m_xStart, 0, m_width);
+        viewport.m_xEnd   = std::clamp(viewport.m_xEnd, viewport.m_xStart, m_width);
+        viewport.m_yStart = std::clamp(viewport.m_yStart, 0, m_height);
+        viewport.m_yEnd   = std::clamp(viewport.m_yEnd, viewport.m_yStart, m_height);
+        m_viewport        = viewport;
     }
 
-    // zeroes-out the grid
-    void clear()
+    // only recompute the tiles that changed on the last generation (or are next to one that did); works with the
+    // INTERLEAVED, CHUNKED and WORK_STEALING strategies, ignored by the others
+    void setActiveTileTracking(bool enable)
+    {
+        const bool supported = m_updateStrategy == UpdateStrategy::INTERLEAVED
+                            || m_updateStrategy == UpdateStrategy::CHUNKED
+                            || m_updateStrategy == UpdateStrategy::WORK_STEALING;
+        if (enable && !supported) {
+            spdlog::warn("(Grid) Active tile tracking is not supported by the current update strategy, ignoring");
+            return;
+        }
+
+        m_trackActiveTiles = enable;
+        if (enable) {
+            m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+            m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+            m_tileChanged.assign((std::size_t)(m_tilesX * m_tilesY), true);
+            m_tileChangedNext.assign(m_tileChanged.size(), false);
+            m_tileVersion.assign(m_tileChanged.size(), m_buffers.version() + 1);
+            m_activeTiles.reserve(m_tileChanged.size());
+            m_staleTiles.reserve(m_tileChanged.size());
+        }
+    }
+
+    // record which cells changed between two published states along with them (see Frame), so a renderer can update
+    // its copy with only those. the update kernels of the byte buffer strategies flag the rows they changed, only those
+    // are compared on publish; the others have the whole state compared
+    void setChangeTracking(bool enable)
+    {
+        m_trackChanges = enable;
+        m_rowChanged.assign(enable ? (std::size_t)m_height : 0, true);
+        m_pendingChanges.clear();
+        m_pendingBase = m_buffers.version();
+    }
+
+    // build the first `levels` levels of the density pyramid of every published frame (see Frame::m_levels), so a
+    // renderer zoomed out does work in proportion to the screen and not to the grid. costs a pass over the published
+    // cells on every publish: meant to follow the zoom, only asking for the levels that are drawn (0, none, by default)
+    void setLevelOfDetail(std::size_t levels)
+    {
+        if (levels > m_levelOfDetail && hasByteBuffers(m_updateStrategy)) {
+            beginEdit();    // republished with them on the next publish(), even if paused
+        }
+        m_levelOfDetail = levels;
+    }
+
+    // while on, the byte buffer strategies stop handing every generation over: they go back and forth between back()
+    // and a spare buffer instead, with no change tracking nor density pyramid, and the last generation is published
+    // when it's turned off. the other strategies only ever publish on publish(), nothing changes for them
+    void setFastForward(bool enable)
+    {
+        if (enable == m_fastForward) {
+            return;
+        }
+        flushEdits();
+
+        if (enable) {
+            if (hasByteBuffers(m_updateStrategy) && m_spare.length() != front().length()) {
+                m_spare = makeCells();
+            }
+            m_fastForwardVersion     = m_buffers.version();
+            m_fastForwardBackVersion = m_buffers.backVersion();
+            m_spareVersion           = 0;    // whatever it holds is outdated everywhere
+            m_fastForward            = true;
+            return;
+        }
+
+        m_fastForward = false;
+        if (m_spareCurrent) {
+            std::swap(back(), m_spare);
+            m_spareCurrent = false;
+            markAllTilesChanged();    // the tile versions went on counting on their own
+            publishBack();
+        }
+    }
+
+    bool isFastForwarding() const { return m_fastForward; }
+
+    using HashObserver   = std::function<void(std::uint64_t generation, std::uint64_t hash)>;
+    using CensusObserver = std::function<void(const Census& census)>;
+
+    // called with the generation and the hash of the state after every generation computed (a TEMPORAL pass only
+    // materializes its last one), an empty one to stop. a row is hashed by the worker that just wrote it when the
+    // strategy goes row by row; otherwise after the pass, and with active tiles only the bands of tiles that changed.
+    // the hash of the state is the sum of the ones of its rows, the fade left out under a Life-like rule (see
+    // hashCells()). HASHLIFE and SPARSE are not supported, there is no grid to hash
+    void setHashObserver(HashObserver observer)
+    {
+        if (observer && (m_updateStrategy == UpdateStrategy::HASHLIFE || m_updateStrategy == UpdateStrategy::SPARSE)) {
+            spdlog::warn("(Grid) State hashing is not supported by the current update strategy, ignoring");
+            return;
+        }
+
+        m_hashObserver = std::move(observer);
+        m_rowHashes.assign(m_hashObserver ? (std::size_t)m_height : 0, 0);
+        m_rehashAll = true;
+    }
+
+    // called with the census of every generation computed (see Census), an empty one to stop. the update kernels count
+    // the rows they write while they are in the cache, per worker, the counts are summed once the pass is done; with
+    // active tiles the population is carried over from the previous generation instead (recounted after an edit)
+    void setCensusObserver(CensusObserver observer)
+    {
+        m_censusObserver = std::move(observer);
+        m_censusSlots.assign(m_censusObserver ? m_threadPool.size() + 1 : 0, CensusSlot{});
+        m_recount = true;
+    }
+
+    bool        isTrackingChanges() const { return m_trackChanges; }
+    bool        isKeepingLevelOfDetail() const { return m_levelOfDetail; }
+    bool        isTrackingActiveTiles() const { return m_trackActiveTiles; }
+    std::size_t activeTileCount() const { return m_activeTiles.size(); }
+
+    // a step of HASHLIFE advances 2^step generations
+    void setHashLifeStep(int step) { m_hashlife.setStep(step); }
+    void setHashLifeCacheLimit(std::size_t numNodes) { m_hashlife.setCacheLimit(numNodes); }
+
+    std::uint64_t generation() const { return m_generation; }
+
+    // the cells already on the grid are kept as they are, see supportsRule() for the ones a strategy can't run
+    void setRule(const Rule& rule)
+    {
+        if (!supportsRule(m_updateStrategy, rule)) {
+            throw std::runtime_error{ std::format(
+                "rule '{}' is not supported by the {} strategy", rule.name(), strategyName(m_updateStrategy)
+            ) };
+        }
+
+        m_rule = rule;
+        m_hashlife.setRule(rule.birthMask(), rule.survivalMask());
+        m_sparse.setRule(rule.birthMask(), rule.survivalMask());
+        markAllTilesChanged();
+
+        spdlog::info("(Grid) Using rule: [{}]", rule.name());
+    }
+
+    const Rule& rule() const { return m_rule; }
+
+    // the cells already on the grid are kept as they are, see supportsBoundary()
+    void setBoundary(Boundary boundary)
+    {
+        if (!supportsBoundary(m_updateStrategy, boundary)) {
+            throw std::runtime_error{ std::format(
+                "boundary '{}' is not supported by the {} strategy", boundaryName(boundary), strategyName(m_updateStrategy)
+            ) };
+        }
+
+        m_boundary = boundary;
+        markAllTilesChanged();
+        if (hasByteBuffers(m_updateStrategy)) {
+            beginEdit();    // the ghost border of the current state is the old boundary's, see publishBack()
+        }
+
+        spdlog::info("(Grid) Using boundary: [{}]", boundaryName(boundary));
+    }
+
+    Boundary boundary() const { return m_boundary; }
+
+    // the bit-packed kernels only wrap around, the universes of HASHLIFE and SPARSE have no edge at all
+    static bool supportsBoundary(UpdateStrategy strategy, Boundary boundary)
+    {
+        return boundary == Boundary::TORUS
+            || !(isBitPacked(strategy) || strategy == UpdateStrategy::HASHLIFE || strategy == UpdateStrategy::SPARSE);
+    }
+
+    static std::string boundaryName(Boundary boundary)
+    {
+        for (const auto& [key, value] : s_boundaryMap) {
+            if (value == boundary) {
+                return key;
+            }
+        }
+        return "unknown";
+    }
+
+    // BITPACKED, MAPPED and HASHLIFE only hold LIVE or dead cells so they only run Life-like rules; HASHLIFE's universe
+    // is unbounded, so not the rules giving birth on 0 neighbors either
+    static bool supportsRule(UpdateStrategy strategy, const Rule& rule)
     {
-        process_multi([this](long x, long y) { m_back(x, y) = m_front(x, y) = DEAD_STATE; });
+        switch (strategy) {
+        case UpdateStrategy::BITPACKED:
+        case UpdateStrategy::MAPPED: return rule.isLifeLike();
+        case UpdateStrategy::HASHLIFE:
+        case UpdateStrategy::SPARSE: return rule.isLifeLike() && (rule.birthMask() & 1) == 0;
+        default: return true;
+        }
     }
 
-    // return the number of live neighbors
+    // return the number of live neighbors, past the edges as the boundary says (see setBoundary())
     int checkNeighbors(const Coord_type xPos, const Coord_type yPos) const
     {
         auto checkState = [this](const Coord_type x, const Coord_type y) {
-            return (*this)(x, y) == LIVE_STATE;
+            if (isInBound(x, y)) {
+                return get(x, y) == LIVE_STATE;
+            }
+            const auto effX = resolve(x, m_width);
+            const auto effY = resolve(y, m_height);
+            return effX >= 0 && effY >= 0 && get(effX, effY) == LIVE_STATE;
         };
 
         auto& x{ xPos };
@@ -176,9 +801,9 @@ public:
     {
         switch (type) {
         case BufferType::FRONT:
-            return m_front(xPos, yPos);
+            return front()(xPos, yPos);
         case BufferType::BACK:
-            return m_back(xPos, yPos);
+            return back()(xPos, yPos);
         }
     }
 
@@ -186,30 +811,30 @@ public:
     {
         switch (type) {
         case BufferType::FRONT:
-            return m_front(xPos, yPos);
+            return front()(xPos, yPos);
         case BufferType::BACK:
-            return m_back(xPos, yPos);
+            return back()(xPos, yPos);
         }
     }
 
+    // past the edges, the cell the boundary says (see resolve()); a dead one past a DEAD edge is a scratch cell,
+    // writing to it doesn't reach the grid
     Cell& operator()(const Coord_type xPos, const Coord_type yPos)
     {
-        // boundary condition: wrap-around
         if (!isInBound(xPos, yPos)) {
-            int effX{ (m_width + xPos % m_width) % m_width };    // following python behavior of operator% (modulo)
-            int effY{ (m_height + yPos % m_height) % m_height };
-            return get(effX, effY);
+            const auto effX = resolve(xPos, m_width);
+            const auto effY = resolve(yPos, m_height);
+            return effX < 0 || effY < 0 ? (t_pastEdge = DEAD_STATE) : get(effX, effY);
         }
         return get(xPos, yPos);
     }
 
     const Cell& operator()(const Coord_type xPos, const Coord_type yPos) const
     {
-        // boundary condition: wrap-around
         if (!isInBound(xPos, yPos)) {
-            int effX{ (m_width + xPos % m_width) % m_width };    // following python behavior of operator% (modulo)
-            int effY{ (m_height + yPos % m_height) % m_height };
-            return get(effX, effY);
+            const auto effX = resolve(xPos, m_width);
+            const auto effY = resolve(yPos, m_height);
+            return effX < 0 || effY < 0 ? s_deadCell : get(effX, effY);
         }
         return get(xPos, yPos);
     }
@@ -218,9 +843,9 @@ public:
     {
         switch (type) {
         case BufferType::FRONT:
-            return m_front;
+            return front();
         case BufferType::BACK:
-            return m_back;
+            return back();
         }
     }
 
@@ -228,109 +853,1154 @@ public:
     {
         switch (type) {
         case BufferType::FRONT:
-            return m_front;
+            return front();
         case BufferType::BACK:
-            return m_back;
+            return back();
         }
     }
 
     Coord_type width() const { return m_width; }
     Coord_type height() const { return m_height; }
 
+    UpdateStrategy updateStrategy() const { return m_updateStrategy; }
+    Placement      placement() const { return m_placement; }
+
+    static std::string strategyName(UpdateStrategy updateStrategy)
+    {
+        for (const auto& [key, value] : s_updateStrategyMap) {
+            if (value == updateStrategy) {
+                return key;
+            }
+        }
+        return "unknown";    // this should never happen
+    }
+
+    static std::string placementName(Placement placement)
+    {
+        for (const auto& [key, value] : s_placementMap) {
+            if (value == placement) {
+                return key;
+            }
+        }
+        return "unknown";
+    }
+
     // return length, width
     const std::pair<int, int> dimension() const { return { m_width, m_height }; }
 
+    // SplitMix64 finalizer, good enough to turn a counter into a random number
+    static constexpr std::uint64_t splitMix64(std::uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15;
+        value  = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value  = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+
 private:
-    Grid_type      m_front;    // this one is to be shown to the outside
-    Grid_type      m_back;     // updates done here
+    Handoff_type   m_buffers;        // latest() is the current generation, updates are done on back()
+    BitMatrix      m_packedFront;    // same as above, but for UpdateStrategy::BITPACKED
+    BitMatrix      m_packedBack;
+    Tiled_type     m_tiledFront;    // same as above, but for UpdateStrategy::TILED
+    Tiled_type     m_tiledBack;
     ThreadPool     m_threadPool;
     Coord_type     m_width          = 0;
     Coord_type     m_height         = 0;
     UpdateStrategy m_updateStrategy = UpdateStrategy::INTERLEAVED;
+    Placement      m_placement      = Placement::DEFAULT;
+    HashLife       m_hashlife;
+    SparseUniverse m_sparse;
+    Region         m_viewport;
+    std::uint64_t  m_generation = 0;
+    bool           m_editing    = false;    // back() holds the current state plus the edits of set()
+
+    // active tile tracking: a tile is recomputed only if it or one of its 8 neighbors changed on the last generation.
+    // the back buffer can be a few generations old (the renderer may hold the previous one), so a skipped tile is only
+    // left alone if it didn't change since the version the back buffer holds, otherwise it's copied from the front
+    bool                       m_trackActiveTiles = false;
+    Coord_type                 m_tilesX           = 0;
+    Coord_type                 m_tilesY           = 0;
+    std::vector<std::uint8_t>  m_tileChanged;        // on the last generation (not vector<bool>: written concurrently)
+    std::vector<std::uint8_t>  m_tileChangedNext;    // on the generation being computed
+    std::vector<std::uint64_t> m_tileVersion;        // first Handoff_type::version() holding the tile's current cells
+    std::vector<Coord_type>    m_activeTiles;
+    std::vector<Coord_type>    m_staleTiles;         // skipped, but outdated on the back buffer
 
-    siv::BasicPerlinNoise<float> m_perlin{ static_cast<siv::PerlinNoise::seed_type>(std::time(nullptr)) };
+    // change tracking: the changes since the oldest version the renderer may hold, carried by every published frame
+    // until the renderer is known to have taken a newer one. too many of them and it's cheaper to send the whole grid
+    bool                                 m_trackChanges = false;
+    std::vector<CellChange>              m_pendingChanges;
+    std::uint64_t                        m_pendingBase = 0;
+    std::vector<CellChange>              m_changes;          // between the last two published versions
+    std::vector<std::vector<CellChange>> m_changeStripes;    // one per stripe of rows, filled in parallel
+    std::vector<std::uint8_t>            m_rowChanged;       // since the last publish, see flagChangedRow()
+
+    std::size_t m_levelOfDetail = 0;    // levels built, see setLevelOfDetail()
+
+    // fast-forward (see setFastForward()): the generations go back and forth between back() and m_spare, which is
+    // front() once it holds one. the tile versions keep counting from the last published one, by generation
+    bool          m_fastForward            = false;
+    bool          m_spareCurrent           = false;
+    Grid_type     m_spare;
+    std::uint64_t m_fastForwardVersion     = 0;    // of front()
+    std::uint64_t m_fastForwardBackVersion = 0;    // of the state back() holds
+    std::uint64_t m_spareVersion           = 0;    // same, m_spare
+
+    // with the workers pinned: the node each one is on, and what it went through on the current pass (see
+    // PhaseStats::recordTraffic())
+    struct alignas(64) WorkerTraffic
+    {
+        std::uint64_t               m_bytes = 0;
+        PhaseStats::Clock::duration m_busy  = {};
+    };
+
+    std::vector<std::size_t>   m_workerNodes;
+    std::vector<WorkerTraffic> m_workerTraffic;
+
+    std::vector<BitMatrix::Word_type> m_stripEdges;    // see updateMapped()
+
+    // state hashing, see setHashObserver()
+    HashObserver               m_hashObserver;
+    std::vector<std::uint64_t> m_rowHashes;           // of the current state
+    std::vector<std::uint8_t>  m_bandChanged;         // by row of tiles, on the last generation
+    bool                       m_rehashAll = true;    // some cells were replaced since the rows were last hashed
+
+    Boundary  m_boundary = Boundary::TORUS;
+
+    // census, see setCensusObserver(): one slot per worker plus one for any other thread
+    struct alignas(64) CensusSlot
+    {
+        std::uint64_t m_population = 0;
+        std::uint64_t m_births     = 0;
+        std::uint64_t m_deaths     = 0;
+    };
+
+    CensusObserver          m_censusObserver;
+    std::vector<CensusSlot> m_censusSlots;
+    std::uint64_t           m_population = 0;       // of the current state, as of the last census
+    bool                    m_recount    = true;    // some cells were replaced since then
+
+    Rule m_rule = Rule::make<"B3/S23">();
+
+    std::uint64_t                m_seed          = static_cast<std::uint64_t>(std::time(nullptr));
+    std::uint64_t                m_populateCount = 0;
+    siv::BasicPerlinNoise<float> m_perlin{ static_cast<siv::PerlinNoise::seed_type>(m_seed) };
     float                        m_perlinFreq   = 8.0f;
     int                          m_perlinOctave = 8;
 
-    bool shouldSpawn(int x, int y, float probability) const
-    {
-        const float fx{ m_perlinFreq / m_width };
-        const float fy{ m_perlinFreq / m_height };
+    // the noise of populate() sampled every m_noiseStep cells (and on the last row and column) then interpolated, the
+    // octaves finer than that are too faint to be seen on a grid this size anyway. rebuilt after setSeed(). the step
+    // only grows past s_minNoiseStep on grids too large for s_maxNoiseSamples, so the cache of a MAPPED grid stays small
+    static constexpr Coord_type s_minNoiseStep    = 4;
+    static constexpr double     s_maxNoiseSamples = 1 << 26;
+    std::vector<float>          m_noise;
+    Coord_type                  m_noiseColumns = 0;
+    Coord_type                  m_noiseStep    = s_minNoiseStep;
 
-        return m_perlin.octave2D_01(fx * (float)x, fy * (float)y, m_perlinOctave) < probability;
+    // what operator() hands out past a DEAD edge
+    static constexpr Cell           s_deadCell = DEAD_STATE;
+    static inline thread_local Cell t_pastEdge = DEAD_STATE;
+
+    // 0.0f <= return < 1.0f, the same for the same key and cell whoever asks and whenever
+    static float cellRandom(std::uint64_t key, int x, int y)
+    {
+        const auto cell = (std::uint64_t)(std::uint32_t)y << 32 | (std::uint32_t)x;
+        return (float)(splitMix64(key ^ splitMix64(cell)) >> 40) * 0x1p-24f;    // the 24 bits of the mantissa
     }
 
-    // process the grid in parallel
-    void process_multi(std::invocable<long, long> auto&& func)
+    void buildNoise()
     {
-        switch (m_updateStrategy) {
-        case UpdateStrategy::INTERLEAVED:
-            processInterleaved(std::forward<decltype(func)>(func));
-            break;
-        case UpdateStrategy::CHUNKED:
-            processChunked(std::forward<decltype(func)>(func));
-            break;
+        if (!m_noise.empty()) {
+            return;
         }
+
+        const auto cells = (double)m_width * (double)m_height;
+        m_noiseStep      = std::max(s_minNoiseStep, (Coord_type)std::ceil(std::sqrt(cells / s_maxNoiseSamples)));
+
+        const auto columns = (m_width - 1) / m_noiseStep + 2;
+        const auto rows    = (m_height - 1) / m_noiseStep + 2;
+        const auto fx      = m_perlinFreq / (float)m_width;
+        const auto fy      = m_perlinFreq / (float)m_height;
+
+        m_noise.resize((std::size_t)columns * (std::size_t)rows);
+        m_noiseColumns = columns;
+
+        m_threadPool.parallelFor(0, (long)rows, 1, [&](long j) {
+            const auto y = (float)std::min((Coord_type)j * m_noiseStep, m_height - 1);
+            for (Coord_type i = 0; i < columns; ++i) {
+                const auto x = (float)std::min(i * m_noiseStep, m_width - 1);
+                m_noise[(std::size_t)j * (std::size_t)columns + (std::size_t)i]
+                    = m_perlin.octave2D_01(fx * x, fy * y, m_perlinOctave);
+            }
+        });
     }
 
-    void processInterleaved(std::invocable<long, long> auto&& func)
+    // bilinear interpolation of the cached noise, see buildNoise()
+    float noiseAt(int x, int y) const
     {
-        const auto concurrencyLevel = m_threadPool.size();
-        const auto chunkSize        = m_height / (long)concurrencyLevel;
+        const auto i = x / m_noiseStep;
+        const auto j = y / m_noiseStep;
 
-        std::vector<std::future<void>> futures;
-        futures.reserve(concurrencyLevel);
+        // the last sample of a row or column sits on the edge of the grid, not a whole step further
+        const auto spanX = std::min(m_noiseStep, m_width - 1 - i * m_noiseStep);
+        const auto spanY = std::min(m_noiseStep, m_height - 1 - j * m_noiseStep);
+        const auto tx    = spanX > 0 ? (float)(x - i * m_noiseStep) / (float)spanX : 0.0f;
+        const auto ty    = spanY > 0 ? (float)(y - j * m_noiseStep) / (float)spanY : 0.0f;
 
-        // interleaved update
-        for (auto i : std::views::iota(0l, (long)concurrencyLevel)) {
-            const auto numSteps = [&] {
-                const auto maxSize = chunkSize * (long)concurrencyLevel + i;
-                if (maxSize < m_height) {
-                    return chunkSize + 1;
-                }
-                return chunkSize;
-            }();
-
-            futures.emplace_back(m_threadPool.enqueue([=, this] {
-                for (auto count : std::views::iota(0l, numSteps)) {
-                    const auto y = count * (int)concurrencyLevel + i;
-                    for (auto x : std::views::iota(0l, m_width)) {
-                        func(x, y);
-                    }
-                }
-            }));
-        }
+        const auto* row  = m_noise.data() + (std::size_t)j * (std::size_t)m_noiseColumns + (std::size_t)i;
+        const auto  top  = row[0] + tx * (row[1] - row[0]);
+        const auto  next = row + m_noiseColumns;
+        const auto  down = next[0] + tx * (next[1] - next[0]);
+        return top + ty * (down - top);
+    }
 
-        for (auto& future : futures) {
-            future.get();
-        }
+    static bool isBitPacked(UpdateStrategy strategy)
+    {
+        return strategy == UpdateStrategy::BITPACKED || strategy == UpdateStrategy::MAPPED;
     }
 
-    void processChunked(std::invocable<long, long> auto&& func)
+    static bool isTiled(UpdateStrategy strategy) { return strategy == UpdateStrategy::TILED; }
+
+    // all DEAD_STATE, with the one cell ghost border updateCell() reads past the edges (see publishBack()); under NUMA,
+    // each band of rows is first touched by the worker processChunked() gives it to, the ghost rows by the first and
+    // last ones
+    Grid_type makeCells()
     {
-        const auto concurrencyLevel = std::min((long)m_threadPool.size(), (long)m_height);    // make sure at least 1
-        const auto chunkSize        = m_height / concurrencyLevel;
+        if (m_placement != Placement::NUMA) {
+            return Grid_type{ m_width, m_height, Grid_type::Ghost{ 1 } };
+        }
 
-        std::vector<std::future<void>> futures;
-        futures.reserve((std::size_t)concurrencyLevel);
+        auto       cells  = Grid_type{ m_width, m_height, Grid_type::Ghost{ 1 }, Grid_type::Uninitialized{} };
+        const auto ghost  = cells.ghost();
+        const auto stride = cells.stride();
+        m_threadPool.parallelForOwned(0, m_height, [&](long y) {
+            const auto first = y == 0 ? -ghost : y;
+            const auto last  = y == m_height - 1 ? y + ghost : y;
+            for (auto row = first; row <= last; ++row) {
+                std::fill_n(cells.row(row) - ghost, stride, DEAD_STATE);
+            }
+        });
+        return cells;
+    }
 
-        // chunked update
-        for (auto i : std::views::iota(0l, concurrencyLevel)) {
-            const auto chunkBegin = i * chunkSize;
-            const auto chunkEnd   = std::min(chunkBegin + chunkSize, (long)m_height);
+    static bool hasByteBuffers(UpdateStrategy strategy)
+    {
+        return strategy != UpdateStrategy::BITPACKED && strategy != UpdateStrategy::HASHLIFE
+            && strategy != UpdateStrategy::TILED && strategy != UpdateStrategy::MAPPED
+            && strategy != UpdateStrategy::SPARSE;
+    }
 
-            futures.emplace_back(m_threadPool.enqueue([=, this] {
-                for (auto y : std::views::iota(chunkBegin, chunkEnd)) {
-                    for (auto x : std::views::iota(0l, m_width)) {
-                        func(x, y);
-                    }
-                }
-            }));
+    static BitMatrix makePacked(
+        UpdateStrategy               strategy,
+        Coord_type                   width,
+        Coord_type                   height,
+        const std::filesystem::path& mappedFile
+    )
+    {
+        switch (strategy) {
+        case UpdateStrategy::BITPACKED: return BitMatrix{ width, height };
+        case UpdateStrategy::MAPPED: return BitMatrix{ width, height, mappedFile };
+        default: return BitMatrix{};
         }
+    }
+
+    // the viewport grown by half its size on each side, so that moving the camera doesn't immediately show stale cells
+    Region paddedViewport() const
+    {
+        const auto [xStart, xEnd, yStart, yEnd] = m_viewport;
+
+        const auto xPad = (xEnd - xStart) / 2 + 1;
+        const auto yPad = (yEnd - yStart) / 2 + 1;
+        return {
+            .m_xStart = std::max(xStart - xPad, 0),
+            .m_xEnd   = std::min(xEnd + xPad, m_width),
+            .m_yStart = std::max(yStart - yPad, 0),
+            .m_yEnd   = std::min(yEnd + yPad, m_height),
+        };
+    }
+
+    // the state becomes the live cells of `source` (a Pattern or a Snapshot), put at `place(x, y)` unless that's out of
+    // the grid; the chunks of `source` are decoded in parallel (one at a time for HASHLIFE and SPARSE)
+    void loadCells(const auto& source, auto&& place)
+    {
+        markAllTilesChanged();
+
+        auto decode = [&](std::size_t chunk, auto&& fn) {
+            source.decodeChunk(chunk, [&](int x, int y) {
+                const auto [xPos, yPos] = place(x, y);
+                if (xPos >= 0 && yPos >= 0 && xPos < m_width && yPos < m_height) {
+                    fn((Coord_type)xPos, (Coord_type)yPos);
+                }
+            });
+        };
+
+        if (m_updateStrategy == UpdateStrategy::HASHLIFE) {
+            m_hashlife.reset();
+            for (std::size_t chunk = 0; chunk < source.numOfChunks(); ++chunk) {
+                decode(chunk, [&](auto x, auto y) { m_hashlife.setCell(x, y, true); });
+            }
+            return;
+        }
+        if (m_updateStrategy == UpdateStrategy::SPARSE) {
+            m_sparse.reset();
+            for (std::size_t chunk = 0; chunk < source.numOfChunks(); ++chunk) {
+                decode(chunk, [&](auto x, auto y) { m_sparse.setCell(x, y, true); });
+            }
+            return;
+        }
+
+        storeDead();
+        m_threadPool.parallelFor(0, (long)source.numOfChunks(), 1, [&](long chunk) {
+            decode((std::size_t)chunk, [&](auto x, auto y) { store(x, y, LIVE_STATE); });
+        });
+        commitStore();
+    }
+
+    // every cell is stored before commitStore(), for the byte buffers they go to the free buffer (see set())
+    void store(const Coord_type xPos, const Coord_type yPos, Cell cell)
+    {
+        if (isBitPacked(m_updateStrategy)) {
+            m_packedFront.set(xPos, yPos, cell == LIVE_STATE);
+        } else if (isTiled(m_updateStrategy)) {
+            m_tiledBack(xPos, yPos) = m_tiledFront(xPos, yPos) = cell;
+        } else {
+            back()(xPos, yPos) = cell;
+        }
+    }
+
+    // same as storing DEAD_STATE on every cell, a word at a time when bit-packed
+    void storeDead()
+    {
+        if (isBitPacked(m_updateStrategy)) {
+            process_rows([this](long y) { std::fill_n(m_packedFront.row(y), m_packedFront.wordsPerRow(), 0); });
+        } else {
+            process_multi([this](long x, long y) { store((int)x, (int)y, DEAD_STATE); });
+        }
+    }
+
+    void commitStore()
+    {
+        if (hasByteBuffers(m_updateStrategy)) {
+            m_editing = true;    // the whole buffer was written, nothing to copy
+            flushEdits();
+        }
+    }
+
+    // the boundary policy of the grid, as a compile-time one (see TorusBoundary and the others)
+    decltype(auto) withBoundary(auto&& func) const
+    {
+        switch (m_boundary) {
+        case Boundary::DEAD: return func(DeadBoundary{});
+        case Boundary::MIRRORED: return func(MirroredBoundary{});
+        default: return func(TorusBoundary{});
+        }
+    }
+
+    // a coordinate past an edge to the one it reads, -1 for a dead cell
+    Coord_type resolve(Coord_type i, Coord_type size) const
+    {
+        return (Coord_type)withBoundary([&]<BoundaryPolicy B>(B) { return B::resolve(i, size); });
+    }
+
+    // hand back() over to the renderer, with the changes from the current state if they are tracked
+    void publishBack()
+    {
+        // the border the next generation reads past the edges, the only part of the grid not written by the kernels
+        withBoundary([&]<BoundaryPolicy B>(B) { back().refreshGhosts<B>(DEAD_STATE); });
+
+        if (m_fastForward) {
+            std::fill(m_rowChanged.begin(), m_rowChanged.end(), false);    // see setFastForward(), all of them on exit
+
+            // the spare takes the new generation, back() the one before it (or nothing useful the first time)
+            std::swap(back(), m_spare);
+            std::swap(m_fastForwardBackVersion, m_spareVersion);
+            m_spareVersion = ++m_fastForwardVersion;
+            m_spareCurrent = true;
+            return;
+        }
+
+        auto& frame     = m_buffers.back();
+        frame.m_version = m_buffers.version() + 1;
+
+        buildLevels(frame);
+
+        if (!m_trackChanges) {
+            frame.m_changes.clear();
+            frame.m_baseVersion = frame.m_version;
+            m_buffers.publish();
+            return;
+        }
+
+        // the frames of MAPPED are empty until the first copyTo(), there is nothing to compare the first one against
+        const bool comparable = front().length() == frame.m_cells.length();
+        if (comparable) {
+            collectChanges(front(), frame.m_cells, m_changes);
+        }
+        std::fill(m_rowChanged.begin(), m_rowChanged.end(), false);
+
+        const auto maxChanges = (std::size_t)m_width * (std::size_t)m_height / 16;
+        if (comparable && m_pendingChanges.size() + m_changes.size() <= maxChanges) {
+            frame.m_changes.assign(m_pendingChanges.begin(), m_pendingChanges.end());
+            frame.m_changes.insert(frame.m_changes.end(), m_changes.begin(), m_changes.end());
+            frame.m_baseVersion = m_pendingBase;
+        } else {
+            frame.m_changes.clear();
+            frame.m_baseVersion = frame.m_version;
+        }
+
+        if (m_buffers.publish()) {
+            // the renderer holds the previous version at least, what it may not have yet are the last changes
+            if (comparable && m_changes.size() <= maxChanges) {
+                std::swap(m_pendingChanges, m_changes);
+                m_pendingBase = frame.m_version - 1;
+            } else {
+                m_pendingChanges.clear();
+                m_pendingBase = frame.m_version;
+            }
+        } else {
+            // the previous version was never taken, carry everything over
+            m_pendingChanges.assign(frame.m_changes.begin(), frame.m_changes.end());
+            m_pendingBase = frame.m_baseVersion;
+        }
+    }
+
+    // each level from the one below it, the first one from the cells; the blocks on the right and bottom edges may be
+    // missing a half, the share is then of the half that is there
+    void buildLevels(Frame& frame)
+    {
+        auto& levels = frame.m_levels;
+
+        std::size_t level = 0;
+        for (auto width = m_width, height = m_height; (width > 1 || height > 1) && level < m_levelOfDetail; ++level) {
+            width  = (width + 1) / 2;
+            height = (height + 1) / 2;
+            if (levels.size() <= level) {
+                levels.emplace_back(width, height);
+            }
+
+            auto&       above = levels[level];
+            const auto& below = level == 0 ? frame.m_cells : levels[level - 1];
+            const bool  cells = level == 0;
+
+            process_indices(height, [&](long y) {
+                const auto* top    = below.row(2 * y);
+                const auto* bottom = 2 * y + 1 < below.height() ? below.row(2 * y + 1) : nullptr;
+                auto*       out    = above.row(y);
+
+                for (long x = 0; x < width; ++x) {
+                    unsigned   sum   = 0;
+                    unsigned   count = 0;
+                    const auto right = 2 * x + 1 < below.width();
+                    for (const auto* row : { top, bottom }) {
+                        if (row == nullptr) {
+                            continue;
+                        }
+                        for (auto i = 2 * x; i < 2 * x + 1 + right; ++i) {
+                            sum += cells ? (row[i] == LIVE_STATE ? LIVE_STATE : 0u) : row[i];
+                            ++count;
+                        }
+                    }
+                    out[x] = (Cell)((sum + count - 1) / count);
+                }
+            });
+        }
+        levels.resize(level);
+    }
+
+    // the cells whose LIVE-ness differ between `from` and `to`, in row-major order; only in the rows flagged changed
+    void collectChanges(const Grid_type& from, const Grid_type& to, std::vector<CellChange>& changes)
+    {
+        const auto stripes = (long)std::min((std::size_t)m_height, m_threadPool.size() * 4);
+        m_changeStripes.resize((std::size_t)stripes);
+
+        m_threadPool.parallelFor(0, stripes, 1, [&](long stripe) {
+            auto& out = m_changeStripes[(std::size_t)stripe];
+            out.clear();
+
+            const auto yStart = stripe * m_height / stripes;
+            const auto yEnd   = (stripe + 1) * m_height / stripes;
+            for (auto y = yStart; y < yEnd; ++y) {
+                if (!m_rowChanged[(std::size_t)y]) {
+                    continue;
+                }
+                const auto* a = from.row(y);
+                const auto* b = to.row(y);
+
+                long x = 0;
+                for (; x + 8 <= m_width; x += 8) {
+                    if (std::memcmp(a + x, b + x, 8) == 0) {
+                        continue;    // most of the grid is dead, or still
+                    }
+                    for (long i = x; i < x + 8; ++i) {
+                        if ((a[i] == LIVE_STATE) != (b[i] == LIVE_STATE)) {
+                            out.push_back({ (std::uint32_t)i, (std::uint32_t)y, b[i] == LIVE_STATE });
+                        }
+                    }
+                }
+                for (; x < m_width; ++x) {
+                    if ((a[x] == LIVE_STATE) != (b[x] == LIVE_STATE)) {
+                        out.push_back({ (std::uint32_t)x, (std::uint32_t)y, b[x] == LIVE_STATE });
+                    }
+                }
+            }
+        });
+
+        changes.clear();
+        for (const auto& stripe : m_changeStripes) {
+            changes.insert(changes.end(), stripe.begin(), stripe.end());
+        }
+    }
+
+    // the edits go to back(), a copy of the current state, until flushEdits()
+    void beginEdit()
+    {
+        if (!m_editing) {
+            back()    = front();
+            m_editing = true;
+        }
+    }
+
+    // make the buffer set() wrote into the current state
+    void flushEdits()
+    {
+        if (m_editing) {
+            publishBack();
+            m_editing = false;
+        }
+    }
+
+    // the neighbors are read straight from memory, past the edges from the ghost border (whatever the boundary)
+    void updateCell(long x, long y)
+    {
+        const auto& from   = front();
+        const auto  stride = from.stride();
+        const auto* cell   = from.row(y) + x;
+        const auto  up     = cell - stride;
+        const auto  down   = cell + stride;
+
+        const int neighbors = (up[-1] == LIVE_STATE) + (up[0] == LIVE_STATE) + (up[1] == LIVE_STATE)
+                            + (cell[-1] == LIVE_STATE) + (cell[1] == LIVE_STATE)
+                            + (down[-1] == LIVE_STATE) + (down[0] == LIVE_STATE) + (down[1] == LIVE_STATE);
+
+        back().row(y)[x] = m_rule.next(*cell, neighbors);
+    }
+
+    // every row goes through SimdKernel, the cells past the edges are read from the ghost border
+    void updateVectorized()
+    {
+        process_rows([this](long y) {
+            const auto& front = this->front();
+            SimdKernel::updateRow(
+                front.row(y - 1), front.row(y), front.row(y + 1), back().row(y), (std::size_t)m_width, m_rule
+            );
+            hashBackRow(y);
+            countBackRow(y);
+            flagBackRow(y);
+        });
+    }
+
+    // every block is copied with a one cell halo into a thread local buffer, then updated row by row with SimdKernel;
+    // only the halo needs the wrap-around, the block itself is read straight from contiguous memory
+    void updateTiled()
+    {
+        process_indices(m_tiledFront.tileCount(), [this](long tile) {
+            constexpr long tileSize = Tiled_type::s_tileSize;
+            constexpr long stride   = tileSize + 2;
+
+            thread_local std::array<Cell, stride * stride> halo;
+
+            const auto tileX  = tile % m_tiledFront.tilesX();
+            const auto tileY  = tile / m_tiledFront.tilesX();
+            const auto xStart = tileX * tileSize;
+            const auto yStart = tileY * tileSize;
+            const auto width  = std::min(tileSize, m_width - xStart);
+            const auto height = std::min(tileSize, m_height - yStart);
+
+            const auto west = resolve(xStart - 1, m_width);
+            const auto east = resolve(xStart + width, m_width);
+
+            for (long r = -1; r <= height; ++r) {
+                const auto y   = resolve(yStart + r, m_height);
+                auto*      dst = halo.data() + (r + 1) * stride;
+                if (y < 0) {
+                    std::fill_n(dst, width + 2, DEAD_STATE);
+                    continue;
+                }
+
+                dst[0]         = west < 0 ? DEAD_STATE : m_tiledFront(west, y);
+                dst[width + 1] = east < 0 ? DEAD_STATE : m_tiledFront(east, y);
+                std::memcpy(dst + 1, m_tiledFront.rowSegment(xStart, y), (std::size_t)width);
+            }
+
+            for (long r = 0; r < height; ++r) {
+                const auto* mid = halo.data() + (r + 1) * stride + 1;
+                auto*       out = m_tiledBack.rowSegment(xStart, yStart + r);
+                SimdKernel::updateRow(mid - stride, mid, mid + stride, out, (std::size_t)width, m_rule);
+                countRow(mid, out, width);
+            }
+        });
+    }
+
+    // every tile is loaded along with a `depth` cells wide halo into thread local buffers and advanced `depth` times
+    // there; each generation leaves one more ring of the halo stale, so after the last one only the tile itself is
+    // correct and gets written back. costs some redundant work on the halo, but the grid is only streamed once
+    void updateTemporal(int depth)
+    {
+        const auto tilesX = (m_width + TEMPORAL_TILE_SIZE - 1) / TEMPORAL_TILE_SIZE;
+        const auto tilesY = (m_height + TEMPORAL_TILE_SIZE - 1) / TEMPORAL_TILE_SIZE;
+
+        process_indices((long)tilesX * tilesY, [this, depth, tilesX](long tile) {
+            thread_local std::vector<Cell> bufferFront;
+            thread_local std::vector<Cell> bufferBack;
+
+            const auto xStart = (Coord_type)(tile % tilesX) * TEMPORAL_TILE_SIZE;
+            const auto yStart = (Coord_type)(tile / tilesX) * TEMPORAL_TILE_SIZE;
+            const auto width  = std::min(TEMPORAL_TILE_SIZE, m_width - xStart);
+            const auto height = std::min(TEMPORAL_TILE_SIZE, m_height - yStart);
+            const long stride = width + 2 * depth;
+            const long rows   = height + 2 * depth;
+
+            bufferFront.resize((std::size_t)(stride * rows));
+            bufferBack.resize(bufferFront.size());
+
+            // the halo may go past the edges (even more than once on tiny grids), where the boundary says what it reads;
+            // the part inside the grid is copied in one go
+            const auto inStart = std::max(xStart - depth, 0);
+            const auto inEnd   = std::min(xStart + width + depth, m_width);
+            for (long r = 0; r < rows; ++r) {
+                const auto y   = resolve(yStart - depth + r, m_height);
+                auto*      dst = bufferFront.data() + r * stride;
+                if (y < 0) {
+                    std::fill_n(dst, stride, DEAD_STATE);
+                    continue;
+                }
+
+                const auto* src = front().row(y);
+                std::memcpy(dst + inStart - (xStart - depth), src + inStart, (std::size_t)(inEnd - inStart));
+                for (long i = 0; i < stride; ++i) {
+                    const auto x = xStart - depth + i;
+                    if (x < inStart || x >= inEnd) {
+                        const auto col = resolve(x, m_width);
+                        dst[i]         = col < 0 ? DEAD_STATE : src[col];
+                    }
+                }
+            }
+
+            auto* front = bufferFront.data();
+            auto* back  = bufferBack.data();
+            for (long gen = 1; gen <= depth; ++gen) {
+                for (long r = gen; r < rows - gen; ++r) {
+                    const auto* mid   = front + r * stride + gen;
+                    auto*       out   = back + r * stride + gen;
+                    const auto  count = (std::size_t)(stride - 2 * gen);
+                    SimdKernel::updateRow(mid - stride, mid, mid + stride, out, count, m_rule);
+                }
+                std::swap(front, back);
+            }
+
+            for (long r = 0; r < height; ++r) {
+                auto*       dst = this->back().row(yStart + r) + xStart;
+                const auto* src = front + (r + depth) * stride + depth;
+                const auto* before = this->front().row(yStart + r) + xStart;
+                if (m_trackChanges && std::memcmp(before, src, (std::size_t)width) != 0) {
+                    flagChangedRow(yStart + r);
+                }
+                std::memcpy(dst, src, (std::size_t)width);
+                countRow(before, src, width);
+            }
+        });
+    }
+
+    // the whole state was replaced: the rows are all to be hashed and compared again too, and the population recounted
+    void markAllTilesChanged()
+    {
+        std::fill(m_tileChanged.begin(), m_tileChanged.end(), true);
+        std::fill(m_rowChanged.begin(), m_rowChanged.end(), true);
+        std::fill(m_tileVersion.begin(), m_tileVersion.end(), m_buffers.version() + 1);
+        m_rehashAll = true;
+        m_recount   = true;
+    }
+
+    void hashBackRow(long y)
+    {
+        if (m_hashObserver) {
+            m_rowHashes[(std::size_t)y] = hashCells(y, back().row(y), (std::size_t)m_width);
+        }
+    }
+
+    void hashPackedRow(long y, const BitMatrix::Word_type* row)
+    {
+        if (m_hashObserver) {
+            const auto bytes            = (std::size_t)m_packedFront.wordsPerRow() * sizeof(BitMatrix::Word_type);
+            m_rowHashes[(std::size_t)y] = hashBytes(y, row, bytes);
+        }
+    }
+
+    // a row of the current state
+    std::uint64_t hashRow(long y) const
+    {
+        switch (m_updateStrategy) {
+        case UpdateStrategy::BITPACKED:
+        case UpdateStrategy::MAPPED:
+            return hashBytes(
+                y, m_packedFront.row(y), (std::size_t)m_packedFront.wordsPerRow() * sizeof(BitMatrix::Word_type)
+            );
+        case UpdateStrategy::TILED:
+        {
+            constexpr long tileSize = Tiled_type::s_tileSize;
+
+            auto hash = std::uint64_t{ 0 };
+            for (long x = 0; x < m_width; x += tileSize) {
+                const auto width = (std::size_t)std::min(tileSize, (long)m_width - x);
+                hash             = splitMix64(hash ^ hashCells(y, m_tiledFront.rowSegment(x, y), width));
+            }
+            return hash;
+        }
+        default:
+            return hashCells(y, front().row(y), (std::size_t)m_width);
+        }
+    }
+
+    // of `width` byte cells of row `y`. with a Life-like rule the fade is only for the looks (see Rule), only which
+    // cells are LIVE is hashed or a cycle would only be seen once everything around it faded out; with Generations the
+    // dying states decide who can be born next, they are part of the state
+    std::uint64_t hashCells(long y, const Cell* row, std::size_t width) const
+    {
+        if (!m_rule.isLifeLike()) {
+            return hashBytes(y, row, width);
+        }
+
+        // 0x80 in the bytes of the word that are LIVE (0xff), 0 in the others
+        constexpr auto low = std::uint64_t{ 0x7f7f'7f7f'7f7f'7f7f };
+        auto liveness = [](std::uint64_t word) {
+            const auto inverted = ~word;
+            return ~(((inverted & low) + low) | inverted | low);
+        };
+
+        auto hash = splitMix64((std::uint64_t)y);
+
+        std::size_t i = 0;
+        for (; i + sizeof(std::uint64_t) <= width; i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, row + i, sizeof(word));
+            hash = std::rotl((hash ^ liveness(word)) * 0x9E3779B97F4A7C15ull, 29);
+        }
+        if (i < width) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, row + i, width - i);
+            hash = std::rotl((hash ^ liveness(word)) * 0x9E3779B97F4A7C15ull, 29);
+        }
+        return splitMix64(hash ^ width);
+    }
+
+    // the rows not hashed on the way are hashed now, then the observer gets the sum
+    void observeHash(bool rowsHashed)
+    {
+        if (!m_hashObserver) {
+            return;
+        }
+
+        if (!rowsHashed) {
+            // with active tiles, a band of tiles none of which changed still has the rows it had
+            const bool bands = m_trackActiveTiles && !m_rehashAll;
+            if (bands) {
+                m_bandChanged.assign((std::size_t)m_tilesY, false);
+                for (Coord_type tile = 0; tile < m_tilesX * m_tilesY; ++tile) {
+                    m_bandChanged[(std::size_t)(tile / m_tilesX)] |= m_tileChanged[(std::size_t)tile];
+                }
+            }
+            process_rows([&](long y) {
+                if (!bands || m_bandChanged[(std::size_t)(y / TILE_SIZE)]) {
+                    m_rowHashes[(std::size_t)y] = hashRow(y);
+                }
+            });
+        }
+        m_rehashAll = false;
+
+        m_hashObserver(m_generation, std::accumulate(m_rowHashes.begin(), m_rowHashes.end(), std::uint64_t{ 0 }));
+    }
+
+    // of `bytes` of row `y` as they are in memory, seeded with the row so that the rows can be summed in any order
+    static std::uint64_t hashBytes(long y, const void* data, std::size_t bytes)
+    {
+        const auto* ptr  = static_cast<const unsigned char*>(data);
+        auto        hash = splitMix64((std::uint64_t)y);
+
+        std::size_t i = 0;
+        for (; i + sizeof(std::uint64_t) <= bytes; i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, ptr + i, sizeof(word));
+            hash = std::rotl((hash ^ word) * 0x9E3779B97F4A7C15ull, 29);
+        }
+        if (i < bytes) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, ptr + i, bytes - i);
+            hash = std::rotl((hash ^ word) * 0x9E3779B97F4A7C15ull, 29);
+        }
+        return splitMix64(hash ^ bytes);
+    }
+
+    // a row of `width` cells `before` and `after` a generation, added to the counts of the calling worker
+    void countRow(const Cell* before, const Cell* after, long width)
+    {
+        if (!m_censusObserver) {
+            return;
+        }
+
+        std::uint64_t population = 0;
+        std::uint64_t births     = 0;
+        std::uint64_t deaths     = 0;
+        for (long x = 0; x < width; ++x) {
+            const bool was  = before[x] == LIVE_STATE;
+            const bool is   = after[x] == LIVE_STATE;
+            population     += is;
+            births         += is && !was;
+            deaths         += was && !is;
+        }
+
+        auto& slot         = m_censusSlots[m_threadPool.currentWorker()];
+        slot.m_population += population;
+        slot.m_births     += births;
+        slot.m_deaths     += deaths;
+    }
+
+    void countBackRow(long y)
+    {
+        countRow(front().row(y), back().row(y), m_width);
+    }
+
+    // with change tracking, the rows of back() the kernels made differ from front(); collectChanges() only goes through
+    // those. several workers may share a row (tiles), hence the atomic store
+    void flagChangedRow(long y)
+    {
+        std::atomic_ref{ m_rowChanged[(std::size_t)y] }.store(true, std::memory_order_relaxed);
+    }
+
+    // a row written whole by the calling worker, compared while it's still in the cache
+    void flagBackRow(long y)
+    {
+        if (m_trackChanges && std::memcmp(front().row(y), back().row(y), (std::size_t)m_width) != 0) {
+            flagChangedRow(y);
+        }
+    }
+
+    void countPackedRow(const BitMatrix::Word_type* before, const BitMatrix::Word_type* after)
+    {
+        if (!m_censusObserver) {
+            return;
+        }
+
+        std::uint64_t population = 0;
+        std::uint64_t births     = 0;
+        std::uint64_t deaths     = 0;
+        for (ssize_t i = 0; i < m_packedFront.wordsPerRow(); ++i) {
+            population += (std::uint64_t)std::popcount(after[i]);
+            births     += (std::uint64_t)std::popcount(after[i] & ~before[i]);
+            deaths     += (std::uint64_t)std::popcount(before[i] & ~after[i]);
+        }
+
+        auto& slot         = m_censusSlots[m_threadPool.currentWorker()];
+        slot.m_population += population;
+        slot.m_births     += births;
+        slot.m_deaths     += deaths;
+    }
+
+    // the counts of the workers summed into the census of the generation
+    void observeCensus()
+    {
+        if (!m_censusObserver) {
+            return;
+        }
+
+        CensusSlot total;
+        for (auto& slot : m_censusSlots) {
+            total.m_population += std::exchange(slot.m_population, 0);
+            total.m_births     += std::exchange(slot.m_births, 0);
+            total.m_deaths     += std::exchange(slot.m_deaths, 0);
+        }
+
+        // only the active tiles were counted, the population of the others didn't change
+        if (hasByteBuffers(m_updateStrategy) && m_trackActiveTiles) {
+            if (m_recount) {
+                const auto& cells  = front();
+                total.m_population = 0;
+                for (long y = 0; y < m_height; ++y) {
+                    total.m_population += (std::uint64_t)std::count(cells.row(y), cells.row(y) + m_width, LIVE_STATE);
+                }
+            } else {
+                total.m_population = m_population + total.m_births - total.m_deaths;
+            }
+        }
+        m_recount    = false;
+        m_population = total.m_population;
+
+        m_censusObserver({
+            .m_generation = m_generation,
+            .m_population = total.m_population,
+            .m_births     = total.m_births,
+            .m_deaths     = total.m_deaths,
+        });
+    }
+
+    Grid_type&       front() { return m_spareCurrent ? m_spare : m_buffers.latest().m_cells; }
+    const Grid_type& front() const { return m_spareCurrent ? m_spare : m_buffers.latest().m_cells; }
+    Grid_type&       back() { return m_buffers.back().m_cells; }
+    const Grid_type& back() const { return m_buffers.back().m_cells; }
+
+    void updateActiveTiles()
+    {
+        const auto backVersion = m_fastForward ? m_fastForwardBackVersion : m_buffers.backVersion();
+        const auto nextVersion = (m_fastForward ? m_fastForwardVersion : m_buffers.version()) + 1;
+
+        m_activeTiles.clear();
+        m_staleTiles.clear();
+        for (auto ty : std::views::iota(0, m_tilesY)) {
+            for (auto tx : std::views::iota(0, m_tilesX)) {
+                bool active = false;
+                for (int dy = -1; dy <= 1 && !active; ++dy) {
+                    for (int dx = -1; dx <= 1 && !active; ++dx) {
+                        const auto nx = (tx + dx + m_tilesX) % m_tilesX;
+                        const auto ny = (ty + dy + m_tilesY) % m_tilesY;
+                        active        = m_tileChanged[(std::size_t)(ny * m_tilesX + nx)];
+                    }
+                }
+                const auto tile = ty * m_tilesX + tx;
+                if (active) {
+                    m_activeTiles.push_back(tile);
+                } else if (m_tileVersion[(std::size_t)tile] > backVersion) {
+                    m_staleTiles.push_back(tile);
+                }
+            }
+        }
+
+        process_indices((long)m_staleTiles.size(), [this](long i) {
+            const auto tile   = m_staleTiles[(std::size_t)i];
+            const auto xStart = (tile % m_tilesX) * TILE_SIZE;
+            const auto yStart = (tile / m_tilesX) * TILE_SIZE;
+            const auto width  = std::min(xStart + TILE_SIZE, m_width) - xStart;
+            const auto yEnd   = std::min(yStart + TILE_SIZE, m_height);
 
-        for (auto& future : futures) {
-            future.get();
+            for (long y = yStart; y < yEnd; ++y) {
+                std::memcpy(back().row(y) + xStart, front().row(y) + xStart, (std::size_t)width);
+            }
+        });
+
+        process_indices((long)m_activeTiles.size(), [this, nextVersion](long i) {
+            const auto tile   = m_activeTiles[(std::size_t)i];
+            const auto xStart = (tile % m_tilesX) * TILE_SIZE;
+            const auto yStart = (tile / m_tilesX) * TILE_SIZE;
+            const auto xEnd   = std::min(xStart + TILE_SIZE, m_width);
+            const auto yEnd   = std::min(yStart + TILE_SIZE, m_height);
+
+            bool changed = false;
+            for (long y = yStart; y < yEnd; ++y) {
+                bool rowChanged = false;
+                for (long x = xStart; x < xEnd; ++x) {
+                    updateCell(x, y);
+                    rowChanged |= back().row(y)[x] != front().row(y)[x];
+                }
+                countRow(front().row(y) + xStart, back().row(y) + xStart, xEnd - xStart);
+                if (rowChanged && m_trackChanges) {
+                    flagChangedRow(y);
+                }
+                changed |= rowChanged;
+            }
+            m_tileChangedNext[(std::size_t)tile] = changed;
+            if (changed) {
+                m_tileVersion[(std::size_t)tile] = nextVersion;
+            }
+        });
+
+        m_tileChanged.swap(m_tileChangedNext);
+        std::fill(m_tileChangedNext.begin(), m_tileChangedNext.end(), false);
+    }
+
+    void updatePacked()
+    {
+        process_rows([this](long y) {
+            const auto up   = (y + m_height - 1) % m_height;
+            const auto down = (y + 1) % m_height;
+            m_packedFront.nextRow(
+                m_packedFront.row(up),
+                m_packedFront.row(y),
+                m_packedFront.row(down),
+                m_packedBack.row(y),
+                m_rule.birthMask(),
+                m_rule.survivalMask()
+            );
+            hashPackedRow(y, m_packedBack.row(y));
+            countPackedRow(m_packedFront.row(y), m_packedBack.row(y));
+        });
+
+        m_packedFront.swap(m_packedBack);
+    }
+
+    // the grid is cut into strips of rows, each one updated in place from top to bottom with a copy of the row above the
+    // one being written; the first and the last row of every strip are copied beforehand, as the two strips next to it
+    // need them as they were. a worker only needs the strip it's on and the next one (which the kernel is told to read
+    // ahead), the pages of a strip are let go once it's done so the rest of the file stays on the disk
+    void updateMapped()
+    {
+        using Word_type = BitMatrix::Word_type;
+
+        const auto  words     = (std::size_t)m_packedFront.wordsPerRow();
+        const auto  rowBytes  = words * sizeof(Word_type);
+        const auto  stripRows = std::max(MAPPED_STRIP_BYTES / (long)rowBytes, 1l);
+        const auto  strips    = (m_height + stripRows - 1) / stripRows;
+        const auto& file      = *m_packedFront.file();
+
+        // the first row of a strip, then its last row
+        m_stripEdges.resize((std::size_t)strips * 2 * words);
+        auto edge = [&](long strip, bool last) { return m_stripEdges.data() + ((std::size_t)strip * 2 + last) * words; };
+
+        process_indices(strips, [&](long strip) {
+            const auto yStart = strip * stripRows;
+            const auto yEnd   = std::min(yStart + stripRows, (long)m_height);
+            std::memcpy(edge(strip, false), m_packedFront.row(yStart), rowBytes);
+            std::memcpy(edge(strip, true), m_packedFront.row(yEnd - 1), rowBytes);
+        });
+
+        process_indices(strips, [&](long strip) {
+            thread_local std::vector<Word_type> up;
+            thread_local std::vector<Word_type> mid;
+            up.resize(words);
+            mid.resize(words);
+
+            const auto yStart = strip * stripRows;
+            const auto yEnd   = std::min(yStart + stripRows, (long)m_height);
+            file.advise((std::size_t)yEnd * rowBytes, (std::size_t)stripRows * rowBytes, MADV_WILLNEED);
+
+            std::memcpy(up.data(), edge((strip + strips - 1) % strips, true), rowBytes);
+            std::memcpy(mid.data(), edge(strip, false), rowBytes);
+            for (auto y = yStart; y < yEnd; ++y) {
+                const bool last = y == yEnd - 1;
+                const auto down = last ? edge((strip + 1) % strips, false) : m_packedFront.row(y + 1);
+                m_packedFront.nextRow(
+                    up.data(),
+                    mid.data(),
+                    down,
+                    m_packedFront.row(y),
+                    m_rule.birthMask(),
+                    m_rule.survivalMask()
+                );
+                hashPackedRow(y, m_packedFront.row(y));
+                countPackedRow(mid.data(), m_packedFront.row(y));    // the row as it was
+
+                std::swap(up, mid);
+                if (!last) {
+                    std::memcpy(mid.data(), down, rowBytes);
+                }
+            }
+
+            file.advise((std::size_t)yStart * rowBytes, (std::size_t)(yEnd - yStart) * rowBytes, MADV_DONTNEED);
+        });
+    }
+
+    // process the grid in parallel
+    void process_multi(std::invocable<long, long> auto&& func)
+    {
+        process_multi(std::forward<decltype(func)>(func), [](long) {});
+    }
+
+    // same, `rowDone(y)` is called once row `y` is done, by the same worker
+    void process_multi(std::invocable<long, long> auto&& func, std::invocable<long> auto&& rowDone)
+    {
+        // about a row of cells read and one written, the other two rows read are still in the cache
+        const auto rowBytes = 2 * (std::size_t)m_width * sizeof(Cell);
+        process_rows(
+            [&](long y) {
+                for (auto x : std::views::iota(0l, (long)m_width)) {
+                    func(x, y);
+                }
+                rowDone(y);
+            },
+            rowBytes
+        );
+    }
+
+    // process the grid in parallel, one row at a time
+    void process_rows(std::invocable<long> auto&& func, std::size_t bytesPerRow = 0)
+    {
+        process_indices(m_height, std::forward<decltype(func)>(func), bytesPerRow);
+    }
+
+    // process [0, count) in parallel, distributed according to the update strategy. `bytesPerIndex` is the memory
+    // traffic of an index, recorded per node with the workers pinned (see Placement)
+    void process_indices(long count, std::invocable<long> auto&& func, std::size_t bytesPerIndex = 0)
+    {
+        if (count <= 0) {
+            return;
+        }
+
+        switch (m_updateStrategy) {
+        case UpdateStrategy::INTERLEAVED:
+            processInterleaved(count, std::forward<decltype(func)>(func));
+            break;
+        case UpdateStrategy::CHUNKED:
+        case UpdateStrategy::BITPACKED:
+        case UpdateStrategy::VECTORIZED:
+        case UpdateStrategy::HASHLIFE:
+        case UpdateStrategy::TILED:
+        case UpdateStrategy::TEMPORAL:
+        case UpdateStrategy::MAPPED:    // updateMapped() prefetches the strip after the current one
+        case UpdateStrategy::SPARSE:
+            processChunked(count, std::forward<decltype(func)>(func), bytesPerIndex);
+            break;
+        case UpdateStrategy::WORK_STEALING:
+            processStealing(count, std::forward<decltype(func)>(func));
+            break;
+        }
+    }
+
+    // worker i takes the indices i, i + n, i + 2n... (n workers), through the pool's job so nothing is allocated
+    void processInterleaved(long count, std::invocable<long> auto&& func)
+    {
+        const auto concurrencyLevel = (long)m_threadPool.size();
+
+        m_threadPool.parallelForOwned(0, std::min(concurrencyLevel, count), [&](long i) {
+            for (auto index = i; index < count; index += concurrencyLevel) {
+                func(index);
+            }
+        });
+    }
+
+    // one contiguous chunk per worker, the traffic of each worker is only recorded when its rows are placed
+    void processChunked(long count, std::invocable<long> auto&& func, std::size_t bytesPerIndex = 0)
+    {
+        processOwned(count, func, m_placement != Placement::DEFAULT ? bytesPerIndex : 0);
+    }
+
+    // chunk i of [0, count) always goes to worker i
+    void processOwned(long count, std::invocable<long> auto&& func, std::size_t bytesPerIndex)
+    {
+        if (bytesPerIndex == 0) {
+            m_threadPool.parallelForOwned(0, count, func);
+            return;
         }
+
+        m_threadPool.parallelForOwned(0, count, [&](long index, std::size_t worker) {
+            const auto start = PhaseStats::Clock::now();
+            func(index);
+
+            auto& traffic    = m_workerTraffic[worker];
+            traffic.m_bytes += bytesPerIndex;
+            traffic.m_busy  += PhaseStats::Clock::now() - start;
+        });
+
+        for (std::size_t worker = 0; worker < m_workerTraffic.size(); ++worker) {
+            auto& traffic = m_workerTraffic[worker];
+            if (traffic.m_bytes > 0) {
+                PhaseStats::recordTraffic(m_workerNodes[worker], traffic.m_bytes, traffic.m_busy);
+                traffic = {};
+            }
+        }
+    }
+
+    void processStealing(long count, std::invocable<long> auto&& func)
+    {
+        // a few grains per worker, idle workers steal the halves the busy ones split off
+        const auto grain = std::max(count / ((long)m_threadPool.size() * 8), 1l);
+        m_threadPool.parallelFor(0, count, grain, func);
     }
 };
 
@@ -0,0 +1,130 @@
+#ifndef GPU_SIMULATION_HPP_9BQW4ZLE
+#define GPU_SIMULATION_HPP_9BQW4ZLE
+
+#include "game.hpp"
+#include "grid_texture.hpp"
+#include "shader.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstdint>
+
+// Simulation backend that keeps the whole state on the GPU: two GL_R8 textures, one generation is a fragment pass
+// reading one of them and rendering into the other through a framebuffer (OpenGL 3.3 has no compute shaders). Any Rule
+// runs the same as in Grid::updateState, fade included.
+//
+// NOTE: every member function must be called on the thread owning the OpenGL context, the render thread
+class GpuSimulation
+{
+public:
+    GpuSimulation(int width, int height)
+        : m_textures{
+            GridTexture{ width, height, "u_state", 1 },
+            GridTexture{ width, height, "u_state", 1 },
+        }
+        , m_shader{ "./resources/shaders/life_step.vert", "./resources/shaders/life_step.frag" }
+    {
+        gl::glGenFramebuffers(1, &m_fbo);
+        gl::glGenVertexArrays(1, &m_vao);    // the pass has no vertex attribute, but core profile needs a vao bound
+
+        setRule(Rule::make<"B3/S23">());
+
+        spdlog::info("(GpuSimulation) Created with width: [{}], height: [{}]", width, height);
+    }
+
+    GpuSimulation(const GpuSimulation&)            = delete;
+    GpuSimulation& operator=(const GpuSimulation&) = delete;
+    GpuSimulation(GpuSimulation&&)                 = delete;
+    GpuSimulation& operator=(GpuSimulation&&)      = delete;
+
+    ~GpuSimulation()
+    {
+        gl::glDeleteFramebuffers(1, &m_fbo);
+        gl::glDeleteVertexArrays(1, &m_vao);
+    }
+
+    // replace the whole state, `data` must have the same dimension as the textures
+    void load(const Grid::Grid_type& data)
+    {
+        front().upload(0, 0, (int)data.width(), (int)data.height(), data.row(0), (int)data.stride());
+        m_generation = 0;
+    }
+
+    void setRule(const Rule& rule)
+    {
+        m_shader.use();
+        m_shader.setUniform("u_birth", (gl::GLint)rule.birthMask());
+        m_shader.setUniform("u_survival", (gl::GLint)rule.survivalMask());
+        m_shader.setUniform("u_decay", (gl::GLfloat)rule.decay() / 255.0f);
+        m_shader.setUniform("u_lifeLike", rule.isLifeLike());
+    }
+
+    void set(int xPos, int yPos, Grid::Cell cell)
+    {
+        front().upload(xPos, yPos, 1, 1, &cell, 1);
+    }
+
+    void clear()
+    {
+        bindTarget(front());
+        gl::glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        gl::glClear(gl::GL_COLOR_BUFFER_BIT);
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, 0);
+
+        m_generation = 0;
+    }
+
+    void step(int generations = 1)
+    {
+        // the renderer sets its own viewport every frame, but don't leave it in a weird state anyway
+        std::array<gl::GLint, 4> viewport;
+        gl::glGetIntegerv(gl::GL_VIEWPORT, viewport.data());
+
+        gl::glViewport(0, 0, front().width(), front().height());
+        gl::glBindVertexArray(m_vao);
+        m_shader.use();
+
+        for (int i = 0; i < generations; ++i) {
+            bindTarget(back());
+            front().activate(m_shader);
+            gl::glDrawArrays(gl::GL_TRIANGLES, 0, 3);
+
+            m_current ^= 1;
+        }
+
+        gl::glBindTexture(gl::GL_TEXTURE_2D, 0);
+        gl::glBindVertexArray(0);
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, 0);
+        gl::glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        m_generation += (std::uint64_t)generations;
+    }
+
+    // the texture holding the current generation, bound as "u_state" on texture unit 1
+    const GridTexture& state() const { return m_textures[m_current]; }
+
+    int           width() const { return state().width(); }
+    int           height() const { return state().height(); }
+    std::uint64_t generation() const { return m_generation; }
+
+private:
+    std::array<GridTexture, 2> m_textures;
+    std::size_t                m_current = 0;
+    Shader                     m_shader;
+    gl::GLuint                 m_fbo        = 0;
+    gl::GLuint                 m_vao        = 0;
+    std::uint64_t              m_generation = 0;
+
+    GridTexture& front() { return m_textures[m_current]; }
+    GridTexture& back() { return m_textures[m_current ^ 1]; }
+
+    void bindTarget(const GridTexture& texture)
+    {
+        gl::glBindFramebuffer(gl::GL_FRAMEBUFFER, m_fbo);
+        gl::glFramebufferTexture2D(gl::GL_FRAMEBUFFER, gl::GL_COLOR_ATTACHMENT0, gl::GL_TEXTURE_2D, texture.id(), 0);
+    }
+};
+
+#endif /* end of include guard: GPU_SIMULATION_HPP_9BQW4ZLE */
@@ -0,0 +1,119 @@
+#ifndef GRID_TEXTURE_HPP_H6ND2QKE
+#define GRID_TEXTURE_HPP_H6ND2QKE
+
+#include "texture.hpp"
+
+#include <glbinding/gl/gl.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+// Single channel GL_R8 texture holding one texel per cell, texel (x, y) is the cell at column x and row y. Cells are
+// stored as-is, so LIVE (0xff) is sampled as 1.0 and the fade values in between. Filtering is always nearest, the
+// shaders use texelFetch anyway.
+class GridTexture final : public Texture
+{
+public:
+    using Cell = std::uint8_t;
+
+    GridTexture(
+        int         width,
+        int         height,
+        std::string uniformName,
+        gl::GLint   textureUnitNum
+    )
+        : Texture{ gl::GL_TEXTURE_2D, textureUnitNum, std::move(uniformName) }
+        , m_width{ width }
+        , m_height{ height }
+    {
+        gl::glGenTextures(1, &m_id);
+        gl::glBindTexture(m_target, m_id);
+
+        gl::glTexParameteri(m_target, gl::GL_TEXTURE_WRAP_S, gl::GL_CLAMP_TO_EDGE);
+        gl::glTexParameteri(m_target, gl::GL_TEXTURE_WRAP_T, gl::GL_CLAMP_TO_EDGE);
+        gl::glTexParameteri(m_target, gl::GL_TEXTURE_MIN_FILTER, gl::GL_NEAREST);
+        gl::glTexParameteri(m_target, gl::GL_TEXTURE_MAG_FILTER, gl::GL_NEAREST);
+
+        gl::glTexImage2D(m_target, 0, gl::GL_R8, width, height, 0, gl::GL_RED, gl::GL_UNSIGNED_BYTE, nullptr);
+
+        gl::glBindTexture(m_target, 0);
+    }
+
+    GridTexture(GridTexture&& other) noexcept
+        : Texture{ std::move(other) }
+        , m_width{ other.m_width }
+        , m_height{ other.m_height }
+        , m_pbo{ std::exchange(other.m_pbo, 0) }
+    {
+    }
+
+    GridTexture& operator=(GridTexture&&) = delete;
+
+    ~GridTexture()
+    {
+        if (m_pbo != 0) {
+            gl::glDeleteBuffers(1, &m_pbo);
+        }
+    }
+
+    // the whole texture, `data` is row-major with `width()` cells per row
+    void upload(const Cell* data) { upload(0, 0, m_width, m_height, data, m_width); }
+
+    // a region of the texture, `data` points to the first cell of the region with `rowLength` cells per row
+    void upload(int xStart, int yStart, int width, int height, const Cell* data, int rowLength)
+    {
+        gl::glBindTexture(m_target, m_id);
+        gl::glPixelStorei(gl::GL_UNPACK_ALIGNMENT, 1);
+        gl::glPixelStorei(gl::GL_UNPACK_ROW_LENGTH, rowLength);
+
+        gl::glTexSubImage2D(m_target, 0, xStart, yStart, width, height, gl::GL_RED, gl::GL_UNSIGNED_BYTE, data);
+
+        gl::glPixelStorei(gl::GL_UNPACK_ROW_LENGTH, 0);
+        gl::glPixelStorei(gl::GL_UNPACK_ALIGNMENT, 4);
+        gl::glBindTexture(m_target, 0);
+    }
+
+    // same as upload(), but the copy goes through a pixel buffer that is orphaned on every call, so the driver never
+    // has to wait for the previous transfer to finish and the texture update itself is asynchronous
+    void stream(int xStart, int yStart, int width, int height, const Cell* data, int rowLength)
+    {
+        const auto size = (gl::GLsizeiptr)width * height;
+        if (size <= 0) {
+            return;
+        }
+
+        if (m_pbo == 0) {
+            gl::glGenBuffers(1, &m_pbo);
+        }
+
+        gl::glBindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, m_pbo);
+        gl::glBufferData(gl::GL_PIXEL_UNPACK_BUFFER, size, nullptr, gl::GL_STREAM_DRAW);    // orphan
+
+        auto* mapped = static_cast<Cell*>(gl::glMapBufferRange(
+            gl::GL_PIXEL_UNPACK_BUFFER, 0, size, gl::GL_MAP_WRITE_BIT | gl::GL_MAP_INVALIDATE_BUFFER_BIT
+        ));
+        if (mapped) {
+            for (int row = 0; row < height; ++row) {
+                const auto* src = data + (std::ptrdiff_t)row * rowLength;
+                std::memcpy(mapped + (std::ptrdiff_t)row * width, src, (std::size_t)width);
+            }
+            gl::glUnmapBuffer(gl::GL_PIXEL_UNPACK_BUFFER);
+
+            upload(xStart, yStart, width, height, nullptr, width);    // offset 0 into the bound pixel buffer
+        }
+
+        gl::glBindBuffer(gl::GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+private:
+    int        m_width  = 0;
+    int        m_height = 0;
+    gl::GLuint m_pbo    = 0;    // only created on the first stream()
+};
+
+#endif /* end of include guard: GRID_TEXTURE_HPP_H6ND2QKE */
@@ -0,0 +1,459 @@
+#ifndef HASHLIFE_HPP_N4E7TQ1C
+#define HASHLIFE_HPP_N4E7TQ1C
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Memoized quadtree (HashLife) universe.
+//
+// Every node is canonical: there is only a single node for each distinct pattern, so a node is identified by its index
+// into `m_nodes`. Level 0 nodes are single cells (index 0 is dead, index 1 is live), a node of level `n` covers a
+// square of 2^n cells. The universe is unbounded: the root is always centered at the origin and is expanded as needed.
+//
+// The cache limit is the number of nodes the table is allowed to hold between steps. When the limit is exceeded,
+// unreachable nodes are collected (and the memoized results are dropped) before the next step is run.
+class HashLife
+{
+public:
+    using Node_id    = std::uint32_t;
+    using Coord_type = std::int64_t;
+
+    static constexpr Node_id     s_dead              = 0;
+    static constexpr Node_id     s_live              = 1;
+    static constexpr std::size_t s_defaultCacheLimit = std::size_t{ 1 } << 22;
+
+    struct Node
+    {
+        Node_id       m_nw;
+        Node_id       m_ne;
+        Node_id       m_sw;
+        Node_id       m_se;
+        Node_id       m_next;      // next node on the same hash bucket
+        Node_id       m_result;    // memoized center after 2^min(step, level - 2) generations
+        std::uint64_t m_population;
+        std::uint8_t  m_level;
+    };
+
+    HashLife(std::size_t cacheLimit = s_defaultCacheLimit)
+        : m_cacheLimit{ cacheLimit }
+    {
+        reset();
+    }
+
+    HashLife(const HashLife&)            = delete;
+    HashLife& operator=(const HashLife&) = delete;
+    HashLife(HashLife&&)                 = default;
+    HashLife& operator=(HashLife&&)      = default;
+
+    // remove everything, leaving an empty universe
+    void reset()
+    {
+        m_nodes.clear();
+        m_empty.clear();
+        m_buckets.assign(s_initialBuckets, s_none);
+
+        m_nodes.push_back(Node{ s_none, s_none, s_none, s_none, s_none, s_none, 0, 0 });    // s_dead
+        m_nodes.push_back(Node{ s_none, s_none, s_none, s_none, s_none, s_none, 1, 0 });    // s_live
+        m_root = empty(s_minRootLevel);
+    }
+
+    // replace the universe with the cells of a `width` x `height` region whose top-left is at the origin
+    template <std::invocable<Coord_type, Coord_type> Fn>
+        requires std::same_as<bool, std::invoke_result_t<Fn, Coord_type, Coord_type>>
+    void load(Coord_type width, Coord_type height, Fn&& isLive)
+    {
+        reset();
+        while (half() < std::max(width, height)) {
+            m_root = expand(m_root);
+        }
+        m_root = build(level(m_root), -half(), -half(), width, height, isLive);
+    }
+
+    void setCell(Coord_type x, Coord_type y, bool live)
+    {
+        while (x < -half() || x >= half() || y < -half() || y >= half()) {
+            m_root = expand(m_root);
+        }
+        m_root = setCell(m_root, -half(), -half(), x, y, live);
+    }
+
+    // advance the universe by 2^step generations, return the number of generations advanced
+    std::uint64_t step()
+    {
+        if (m_nodes.size() > m_cacheLimit) {
+            collect();
+        }
+
+        // the pattern must be inside the center 1/4 of the root and the root must be large enough for the step, so
+        // that whatever it grows into still fits in the result
+        while (level(m_root) < m_step + 3 || !isCentered(m_root)) {
+            m_root = expand(m_root);
+        }
+        m_root = successor(m_root);
+
+        return std::uint64_t{ 1 } << m_step;
+    }
+
+    // a step advances the universe by 2^step generations
+    void setStep(int step)
+    {
+        step = std::clamp(step, 0, s_maxStep);
+        if (step != m_step) {
+            m_step = step;
+            for (auto& node : m_nodes) {
+                node.m_result = s_none;
+            }
+        }
+    }
+
+    // bit n of `birth` (`survival`): a dead (live) cell is live on n neighbors, see Rule. birth on 0 neighbors would
+    // fill the unbounded universe, it's not supported
+    void setRule(std::uint16_t birth, std::uint16_t survival)
+    {
+        if (birth != m_birth || survival != m_survival) {
+            m_birth    = birth;
+            m_survival = survival;
+            for (auto& node : m_nodes) {
+                node.m_result = s_none;
+            }
+        }
+    }
+
+    void setCacheLimit(std::size_t limit) { m_cacheLimit = limit; }
+
+    // call `fn(x, y)` for every live cell inside [xStart, xEnd) x [yStart, yEnd); empty nodes are skipped entirely
+    template <std::invocable<Coord_type, Coord_type> Fn>
+    void forEachLive(Coord_type xStart, Coord_type xEnd, Coord_type yStart, Coord_type yEnd, Fn&& fn) const
+    {
+        forEachLive(m_root, -half(), -half(), xStart, xEnd, yStart, yEnd, fn);
+    }
+
+    int           getStep() const { return m_step; }
+    std::size_t   cacheLimit() const { return m_cacheLimit; }
+    std::size_t   nodeCount() const { return m_nodes.size(); }
+    std::uint64_t population() const { return m_nodes[m_root].m_population; }
+
+private:
+    static constexpr Node_id     s_none          = std::numeric_limits<Node_id>::max();
+    static constexpr std::size_t s_initialBuckets = std::size_t{ 1 } << 16;
+    static constexpr int         s_minRootLevel   = 3;
+    static constexpr int         s_maxStep        = 56;    // keep the coordinates well inside Coord_type
+
+    std::vector<Node>    m_nodes;
+    std::vector<Node_id> m_buckets;
+    std::vector<Node_id> m_empty;    // canonical empty node of each level
+    Node_id              m_root       = s_dead;
+    int                  m_step       = 0;
+    std::size_t          m_cacheLimit = s_defaultCacheLimit;
+    std::uint16_t        m_birth      = 1 << 3;    // B3/S23 until setRule()
+    std::uint16_t        m_survival   = 1 << 2 | 1 << 3;
+
+    int        level(Node_id id) const { return m_nodes[id].m_level; }
+    Coord_type half() const { return Coord_type{ 1 } << (level(m_root) - 1); }
+
+    static std::size_t hash(Node_id nw, Node_id ne, Node_id sw, Node_id se)
+    {
+        auto h = (std::uint64_t)nw * 0x9e3779b97f4a7c15ull;
+        h      = (h ^ ne) * 0xbf58476d1ce4e5b9ull;
+        h      = (h ^ sw) * 0x94d049bb133111ebull;
+        h      = (h ^ se) * 0x9e3779b97f4a7c15ull;
+        return (std::size_t)(h ^ (h >> 29));
+    }
+
+    // return the canonical node with the given children
+    Node_id join(Node_id nw, Node_id ne, Node_id sw, Node_id se)
+    {
+        const auto mask = m_buckets.size() - 1;
+        auto&      head = m_buckets[hash(nw, ne, sw, se) & mask];
+
+        for (auto id = head; id != s_none; id = m_nodes[id].m_next) {
+            const auto& node = m_nodes[id];
+            if (node.m_nw == nw && node.m_ne == ne && node.m_sw == sw && node.m_se == se) {
+                return id;
+            }
+        }
+
+        const auto id         = (Node_id)m_nodes.size();
+        const auto population = m_nodes[nw].m_population
+                              + m_nodes[ne].m_population
+                              + m_nodes[sw].m_population
+                              + m_nodes[se].m_population;
+        const auto lvl        = (std::uint8_t)(m_nodes[nw].m_level + 1);
+
+        m_nodes.push_back(Node{ nw, ne, sw, se, head, s_none, population, lvl });
+        head = id;
+
+        if (m_nodes.size() > m_buckets.size()) {
+            rehash(m_buckets.size() * 2);
+        }
+        return id;
+    }
+
+    void rehash(std::size_t buckets)
+    {
+        m_buckets.assign(buckets, s_none);
+        for (Node_id id = 2; id < m_nodes.size(); ++id) {
+            auto& node  = m_nodes[id];
+            auto& head  = m_buckets[hash(node.m_nw, node.m_ne, node.m_sw, node.m_se) & (buckets - 1)];
+            node.m_next = std::exchange(head, id);
+        }
+    }
+
+    Node_id empty(int lvl)
+    {
+        while ((int)m_empty.size() <= lvl) {
+            if (m_empty.empty()) {
+                m_empty.push_back(s_dead);
+            } else {
+                const auto e = m_empty.back();
+                m_empty.push_back(join(e, e, e, e));
+            }
+        }
+        return m_empty[(std::size_t)lvl];
+    }
+
+    // same pattern, one level up, centered
+    Node_id expand(Node_id id)
+    {
+        const auto node = m_nodes[id];
+        const auto e    = empty(node.m_level - 1);
+        return join(join(e, e, e, node.m_nw), join(e, e, node.m_ne, e), join(e, node.m_sw, e, e), join(node.m_se, e, e, e));
+    }
+
+    bool isCentered(Node_id id) const
+    {
+        const auto& n      = m_nodes[id];
+        auto        center = [&](Node_id quad, auto pick) {
+            return m_nodes[pick(m_nodes[pick(m_nodes[quad])])].m_population == m_nodes[quad].m_population;
+        };
+        return center(n.m_nw, [](const Node& q) { return q.m_se; })
+            && center(n.m_ne, [](const Node& q) { return q.m_sw; })
+            && center(n.m_sw, [](const Node& q) { return q.m_ne; })
+            && center(n.m_se, [](const Node& q) { return q.m_nw; });
+    }
+
+    template <typename Fn>
+    Node_id build(int lvl, Coord_type x, Coord_type y, Coord_type width, Coord_type height, Fn& isLive)
+    {
+        const auto size = Coord_type{ 1 } << lvl;
+        if (x >= width || y >= height || x + size <= 0 || y + size <= 0) {
+            return empty(lvl);
+        }
+        if (lvl == 0) {
+            return isLive(x, y) ? s_live : s_dead;
+        }
+
+        const auto s  = size / 2;
+        const auto nw = build(lvl - 1, x, y, width, height, isLive);
+        const auto ne = build(lvl - 1, x + s, y, width, height, isLive);
+        const auto sw = build(lvl - 1, x, y + s, width, height, isLive);
+        const auto se = build(lvl - 1, x + s, y + s, width, height, isLive);
+        return join(nw, ne, sw, se);
+    }
+
+    Node_id setCell(Node_id id, Coord_type xOrigin, Coord_type yOrigin, Coord_type x, Coord_type y, bool live)
+    {
+        const auto node = m_nodes[id];
+        if (node.m_level == 0) {
+            return live ? s_live : s_dead;
+        }
+
+        const auto s    = Coord_type{ 1 } << (node.m_level - 1);
+        const bool east = x >= xOrigin + s;
+        const bool sout = y >= yOrigin + s;
+
+        auto children = std::array{ node.m_nw, node.m_ne, node.m_sw, node.m_se };
+        auto& child   = children[(std::size_t)(sout * 2 + east)];
+        child         = setCell(child, xOrigin + east * s, yOrigin + sout * s, x, y, live);
+
+        return join(children[0], children[1], children[2], children[3]);
+    }
+
+    // 4x4 cells -> the center 2x2 cells, one generation later
+    Node_id baseCase(const Node& node)
+    {
+        std::uint16_t bits = 0;    // bit (row * 4 + col)
+        auto          put  = [&](Node_id quad, int row, int col) {
+            const auto& q = m_nodes[quad];
+            bits |= (std::uint16_t)((q.m_nw == s_live) << (row * 4 + col));
+            bits |= (std::uint16_t)((q.m_ne == s_live) << (row * 4 + col + 1));
+            bits |= (std::uint16_t)((q.m_sw == s_live) << ((row + 1) * 4 + col));
+            bits |= (std::uint16_t)((q.m_se == s_live) << ((row + 1) * 4 + col + 1));
+        };
+        put(node.m_nw, 0, 0);
+        put(node.m_ne, 0, 2);
+        put(node.m_sw, 2, 0);
+        put(node.m_se, 2, 2);
+
+        auto next = [&](int row, int col) {
+            int neighbor = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx != 0 || dy != 0) {
+                        neighbor += (bits >> ((row + dy) * 4 + col + dx)) & 1;
+                    }
+                }
+            }
+            const bool live = (bits >> (row * 4 + col)) & 1;
+            return ((live ? m_survival : m_birth) >> neighbor) & 1 ? s_live : s_dead;
+        };
+
+        return join(next(1, 1), next(1, 2), next(2, 1), next(2, 2));
+    }
+
+    Node_id center(Node_id id)
+    {
+        const auto n = m_nodes[id];
+        return join(m_nodes[n.m_nw].m_se, m_nodes[n.m_ne].m_sw, m_nodes[n.m_sw].m_ne, m_nodes[n.m_se].m_nw);
+    }
+
+    Node_id centerHorizontal(Node_id west, Node_id east)
+    {
+        const auto w = m_nodes[west];
+        const auto e = m_nodes[east];
+        return join(w.m_ne, e.m_nw, w.m_se, e.m_sw);
+    }
+
+    Node_id centerVertical(Node_id north, Node_id south)
+    {
+        const auto n = m_nodes[north];
+        const auto s = m_nodes[south];
+        return join(n.m_sw, n.m_se, s.m_nw, s.m_ne);
+    }
+
+    // center of the node (one level down) after 2^min(m_step, level - 2) generations
+    Node_id successor(Node_id id)
+    {
+        const auto node = m_nodes[id];
+        if (node.m_result != s_none) {
+            return node.m_result;
+        }
+        if (node.m_population == 0) {
+            return m_nodes[id].m_result = empty(node.m_level - 1);
+        }
+        if (node.m_level == 2) {
+            return m_nodes[id].m_result = baseCase(node);
+        }
+
+        // 9 overlapping sub-nodes, one level down
+        const std::array<Node_id, 9> sub{
+            node.m_nw,
+            centerHorizontal(node.m_nw, node.m_ne),
+            node.m_ne,
+            centerVertical(node.m_nw, node.m_sw),
+            center(id),
+            centerVertical(node.m_ne, node.m_se),
+            node.m_sw,
+            centerHorizontal(node.m_sw, node.m_se),
+            node.m_se,
+        };
+
+        // at full speed both halves advance the pattern, otherwise only the second one does
+        const bool fullSpeed = m_step >= node.m_level - 2;
+
+        std::array<Node_id, 9> r;
+        for (std::size_t i = 0; i < sub.size(); ++i) {
+            r[i] = fullSpeed ? successor(sub[i]) : center(sub[i]);
+        }
+
+        const auto nw = successor(join(r[0], r[1], r[3], r[4]));
+        const auto ne = successor(join(r[1], r[2], r[4], r[5]));
+        const auto sw = successor(join(r[3], r[4], r[6], r[7]));
+        const auto se = successor(join(r[4], r[5], r[7], r[8]));
+
+        return m_nodes[id].m_result = join(nw, ne, sw, se);
+    }
+
+    template <typename Fn>
+    void forEachLive(
+        Node_id    id,
+        Coord_type x,
+        Coord_type y,
+        Coord_type xStart,
+        Coord_type xEnd,
+        Coord_type yStart,
+        Coord_type yEnd,
+        Fn&        fn
+    ) const
+    {
+        const auto& node = m_nodes[id];
+        const auto  size = Coord_type{ 1 } << node.m_level;
+        if (node.m_population == 0 || x >= xEnd || y >= yEnd || x + size <= xStart || y + size <= yStart) {
+            return;
+        }
+        if (node.m_level == 0) {
+            fn(x, y);
+            return;
+        }
+
+        const auto s = size / 2;
+        forEachLive(node.m_nw, x, y, xStart, xEnd, yStart, yEnd, fn);
+        forEachLive(node.m_ne, x + s, y, xStart, xEnd, yStart, yEnd, fn);
+        forEachLive(node.m_sw, x, y + s, xStart, xEnd, yStart, yEnd, fn);
+        forEachLive(node.m_se, x + s, y + s, xStart, xEnd, yStart, yEnd, fn);
+    }
+
+    // keep only the nodes reachable from the root (and the empty nodes), drop every memoized result.
+    // children always have a lower index than their parent, so a single pass in index order can remap them.
+    void collect()
+    {
+        const auto before = m_nodes.size();
+
+        std::vector<bool>    marked(m_nodes.size(), false);
+        std::vector<Node_id> stack{ m_root };
+        stack.insert(stack.end(), m_empty.begin(), m_empty.end());
+        marked[s_dead] = marked[s_live] = true;
+
+        while (!stack.empty()) {
+            const auto id = stack.back();
+            stack.pop_back();
+            if (marked[id]) {
+                continue;
+            }
+            marked[id]       = true;
+            const auto& node = m_nodes[id];
+            stack.insert(stack.end(), { node.m_nw, node.m_ne, node.m_sw, node.m_se });
+        }
+
+        std::vector<Node_id> remap(m_nodes.size(), s_none);
+        std::vector<Node>    nodes;
+        for (Node_id id = 0; id < m_nodes.size(); ++id) {
+            if (!marked[id]) {
+                continue;
+            }
+            auto node = m_nodes[id];
+            if (node.m_level > 0) {
+                node.m_nw = remap[node.m_nw];
+                node.m_ne = remap[node.m_ne];
+                node.m_sw = remap[node.m_sw];
+                node.m_se = remap[node.m_se];
+            }
+            node.m_result = s_none;
+            remap[id]     = (Node_id)nodes.size();
+            nodes.push_back(node);
+        }
+
+        m_nodes = std::move(nodes);
+        m_root  = remap[m_root];
+        for (auto& e : m_empty) {
+            e = remap[e];
+        }
+
+        auto buckets = s_initialBuckets;
+        while (buckets < m_nodes.size()) {
+            buckets *= 2;
+        }
+        rehash(buckets);
+
+        spdlog::debug("(HashLife) Garbage collected [{}] nodes, [{}] left", before - m_nodes.size(), m_nodes.size());
+    }
+};
+
+#endif /* end of include guard: HASHLIFE_HPP_N4E7TQ1C */
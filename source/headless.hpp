@@ -0,0 +1,333 @@
+#ifndef HEADLESS_HPP_P7DK2XRC
+#define HEADLESS_HPP_P7DK2XRC
+
+#include "alloc_counter.hpp"
+#include "game.hpp"
+#include "pattern.hpp"
+#include "shard.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Runs the simulation without any window or OpenGL context, for measuring the simulation throughput on machines
+// without a display. Each run prints a single line of JSON on stdout, so the logs should go somewhere else.
+class Headless
+{
+public:
+    struct Param
+    {
+        int                               m_gridWidth;
+        int                               m_gridHeight;
+        float                             m_density;
+        int                               m_generations;    // number of updateState(), 2^step generations for HASHLIFE
+        std::uint64_t                     m_seed;
+        std::size_t                       m_threads;
+        int                               m_hashLifeStep;
+        std::size_t                       m_hashLifeCacheLimit;
+        bool                              m_trackActiveTiles;
+        Rule                              m_rule;
+        std::vector<Grid::UpdateStrategy> m_strategies;    // all of them must support m_rule, see Grid::supportsRule()
+
+        std::optional<std::filesystem::path> m_pattern;    // instead of the random population
+        std::optional<std::pair<int, int>>   m_patternOffset;
+        std::filesystem::path                m_mappedFile;    // holds the cells of the MAPPED strategy
+        Grid::Placement                      m_placement = Grid::Placement::DEFAULT;
+        bool                                 m_census    = false;    // count the cells while ticking, see Grid::Census
+        Grid::Boundary                       m_boundary  = Grid::Boundary::TORUS;    // all of m_strategies support it
+
+        // this process is shard m_shardRank of the grid, instead of running m_strategies (see Shard). with a view
+        // factor (the same on every shard), rank 0 gathers the grid scaled down by it at the end and writes it to
+        // m_shardViewFile (see Shard::gatherView())
+        std::vector<std::string> m_shardAddresses;
+        std::size_t              m_shardRank       = 0;
+        int                      m_shardViewFactor = 0;    // 0 for no view
+        std::filesystem::path    m_shardViewFile   = "shard_view.pgm";
+    };
+
+    struct Result
+    {
+        std::string   m_strategy;
+        bool          m_activeTiles     = false;
+        double        m_populateSeconds = 0.0;
+        double        m_wallSeconds     = 0.0;
+        int           m_ticks           = 0;
+        std::uint64_t m_generations     = 0;
+        double        m_tickP50         = 0.0;    // in milliseconds
+        double        m_tickP99         = 0.0;
+
+        PhaseStats::Traffics        m_traffics = {};          // of the ticks, with the workers pinned
+        std::optional<Grid::Census> m_census;                 // of the last generation, if asked for
+        std::optional<double>       m_allocationsPerTick;    // past the first tick, if AllocCounter::s_enabled
+    };
+
+    // run every strategy one after the other, return the process exit code
+    static int run(const Param& param)
+    {
+        spdlog::info(
+            "(Headless) Running {} ticks on a {}x{} grid with {} threads, seed: [{}], rule: [{}]",
+            param.m_generations,
+            param.m_gridWidth,
+            param.m_gridHeight,
+            param.m_threads,
+            param.m_seed,
+            param.m_rule.name()
+        );
+
+        if (!param.m_shardAddresses.empty()) {
+            return runSharded(param);
+        }
+
+        for (auto strategy : param.m_strategies) {
+            print(param, runOne(param, strategy));
+        }
+        return 0;
+    }
+
+    static Result runOne(const Param& param, Grid::UpdateStrategy strategy)
+    {
+        using Clock = std::chrono::steady_clock;
+        auto seconds = [](Clock::duration duration) { return std::chrono::duration<double>(duration).count(); };
+
+        Grid grid{
+            param.m_gridWidth, param.m_gridHeight, strategy, param.m_threads, param.m_mappedFile, param.m_placement,
+        };
+        grid.setSeed(param.m_seed);
+        grid.setRule(param.m_rule);
+        grid.setBoundary(param.m_boundary);
+        grid.setHashLifeStep(param.m_hashLifeStep);
+        grid.setHashLifeCacheLimit(param.m_hashLifeCacheLimit);
+        if (param.m_trackActiveTiles) {
+            grid.setActiveTileTracking(true);
+        }
+
+        std::optional<Grid::Census> census;
+        if (param.m_census) {
+            grid.setCensusObserver([&](const Grid::Census& last) { census = last; });
+        }
+
+        const auto populateStart = Clock::now();
+        if (param.m_pattern) {
+            const auto pattern = Pattern{ *param.m_pattern };
+            if (param.m_patternOffset) {
+                grid.load(pattern, param.m_patternOffset->first, param.m_patternOffset->second);
+            } else {
+                grid.load(pattern);
+            }
+        } else {
+            grid.populate(param.m_density);
+        }
+        const auto populateEnd = Clock::now();
+
+        std::vector<double> ticks;
+        ticks.reserve((std::size_t)param.m_generations);
+
+        (void)PhaseStats::drainTraffic();    // the populate isn't part of it
+
+        // the first tick sizes the scratch buffers, the steady state is the ticks after it
+        AllocCounter::ScopedTrack track{ AllocCounter::Track::TICK };
+
+        const auto start = Clock::now();
+        for (int i = 0; i < param.m_generations; ++i) {
+            const auto tickStart = Clock::now();
+            grid.updateState();
+            ticks.push_back(seconds(Clock::now() - tickStart) * 1e3);
+
+            if (i == 0) {
+                (void)AllocCounter::drain();
+            }
+        }
+        const auto end = Clock::now();
+
+        const auto allocations = AllocCounter::drain()[(std::size_t)AllocCounter::Track::TICK];
+        const auto steadyTicks = std::max(param.m_generations - 1, 1);
+
+        return {
+            .m_strategy           = Grid::strategyName(strategy),
+            .m_activeTiles        = grid.isTrackingActiveTiles(),
+            .m_populateSeconds    = seconds(populateEnd - populateStart),
+            .m_wallSeconds        = seconds(end - start),
+            .m_ticks              = param.m_generations,
+            .m_generations        = grid.generation(),
+            .m_tickP50            = percentile(ticks, 0.50),
+            .m_tickP99            = percentile(ticks, 0.99),
+            .m_traffics           = PhaseStats::drainTraffic(),
+            .m_census             = census,
+            .m_allocationsPerTick = AllocCounter::s_enabled ? std::optional{ (double)allocations / steadyTicks }
+                                                            : std::nullopt,
+        };
+    }
+
+    // every shard prints its own line, the population is the one of the whole grid on rank 0 only
+    static int runSharded(const Param& param)
+    {
+        if (param.m_boundary != Grid::Boundary::TORUS) {
+            throw std::runtime_error{ "the shards only wrap around, the boundary must be 'torus'" };
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto seconds = [](Clock::duration duration) { return std::chrono::duration<double>(duration).count(); };
+
+        Shard shard{ {
+            .m_width     = param.m_gridWidth,
+            .m_height    = param.m_gridHeight,
+            .m_rank      = param.m_shardRank,
+            .m_addresses = param.m_shardAddresses,
+            .m_threads   = param.m_threads,
+            .m_rule      = param.m_rule,
+        } };
+
+        const auto populateStart = Clock::now();
+        shard.populate(param.m_density, param.m_seed);
+        const auto populateEnd = Clock::now();
+
+        std::vector<double> ticks;
+        ticks.reserve((std::size_t)param.m_generations);
+
+        const auto start = Clock::now();
+        for (int i = 0; i < param.m_generations; ++i) {
+            const auto tickStart = Clock::now();
+            shard.step();
+            ticks.push_back(seconds(Clock::now() - tickStart) * 1e3);
+        }
+        const auto end = Clock::now();
+
+        Grid::Grid_type view;
+        const auto      population = param.m_shardViewFactor > 0 ? shard.gatherView(param.m_shardViewFactor, view)
+                                                                 : shard.gatherPopulation();
+        if (shard.rank() == 0 && param.m_shardViewFactor > 0) {
+            writeView(param.m_shardViewFile, view);
+            spdlog::info(
+                "(Headless) View of [{}x{}] written to [{}]", view.width(), view.height(), param.m_shardViewFile.string()
+            );
+        }
+
+        const auto cells = (double)param.m_gridWidth * (double)shard.rows();
+        const auto wall  = std::max(seconds(end - start), 1e-9);
+
+        const auto line = std::format(
+            R"({{"strategy":"shard","rank":{},"shards":{},"rule":"{}","width":{},"height":{},"rows":{},"threads":{},)"
+            R"("seed":{},"density":{},"populate_s":{:.6f},"generations":{},"wall_s":{:.6f},"generations_per_s":{:.3f},)"
+            R"("cells_per_s":{:.1f},"tick_p50_ms":{:.4f},"tick_p99_ms":{:.4f},"population":{}}})",
+            shard.rank(),
+            shard.count(),
+            param.m_rule.name(),
+            param.m_gridWidth,
+            param.m_gridHeight,
+            shard.rows(),
+            param.m_threads,
+            param.m_seed,
+            param.m_density,
+            seconds(populateEnd - populateStart),
+            shard.generation(),
+            seconds(end - start),
+            (double)shard.generation() / wall,
+            cells * (double)shard.generation() / wall,
+            percentile(ticks, 0.50),
+            percentile(ticks, 0.99),
+            population
+        );
+        std::fputs(line.c_str(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+        return 0;
+    }
+
+private:
+    // as a binary PGM, the densities as they are: black is empty, white full
+    static void writeView(const std::filesystem::path& path, const Grid::Grid_type& view)
+    {
+        auto* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error{ std::format("can't open '{}' to write the view", path.string()) };
+        }
+
+        const auto header = std::format("P5\n{} {}\n255\n", view.width(), view.height());
+        bool       ok     = std::fputs(header.c_str(), file) >= 0;
+        for (long y = 0; ok && y < view.height(); ++y) {
+            ok = std::fwrite(view.row(y), 1, (std::size_t)view.width(), file) == (std::size_t)view.width();
+        }
+        if (std::fclose(file) != 0 || !ok) {
+            throw std::runtime_error{ std::format("can't write the view to '{}'", path.string()) };
+        }
+    }
+
+    // nearest rank, `values` is reordered
+    static double percentile(std::vector<double>& values, double p)
+    {
+        if (values.empty()) {
+            return 0.0;
+        }
+        const auto rank = std::min((std::size_t)(p * (double)values.size()), values.size() - 1);
+        std::nth_element(values.begin(), values.begin() + (long)rank, values.end());
+        return values[rank];
+    }
+
+    static void print(const Param& param, const Result& result)
+    {
+        const auto cells = (double)param.m_gridWidth * param.m_gridHeight;
+        const auto wall  = std::max(result.m_wallSeconds, 1e-9);
+
+        std::string nodes;
+        for (std::size_t node = 0; node < PhaseStats::s_maxNodes; ++node) {
+            if (result.m_traffics[node].m_bytes > 0) {
+                nodes += std::format("{}{:.3f}", nodes.empty() ? "" : ",", result.m_traffics[node].gbPerSecond());
+            }
+        }
+
+        auto line = std::format(
+            R"({{"strategy":"{}","rule":"{}","width":{},"height":{},"threads":{},"seed":{},"density":{},)"
+            R"("active_tiles":{},"populate_s":{:.6f},"ticks":{},"generations":{},"wall_s":{:.6f},)"
+            R"("generations_per_s":{:.3f},)"
+            R"("cells_per_s":{:.1f},"tick_p50_ms":{:.4f},"tick_p99_ms":{:.4f},"placement":"{}","node_gb_per_s":[{}],)"
+            R"("boundary":"{}"}})",
+            result.m_strategy,
+            param.m_rule.name(),
+            param.m_gridWidth,
+            param.m_gridHeight,
+            param.m_threads,
+            param.m_seed,
+            param.m_density,
+            result.m_activeTiles,
+            result.m_populateSeconds,
+            result.m_ticks,
+            result.m_generations,
+            result.m_wallSeconds,
+            (double)result.m_generations / wall,
+            cells * (double)result.m_generations / wall,
+            result.m_tickP50,
+            result.m_tickP99,
+            Grid::placementName(param.m_placement),
+            nodes,
+            Grid::boundaryName(param.m_boundary)
+        );
+        if (result.m_census) {
+            line.pop_back();
+            line += std::format(
+                R"(,"population":{},"births":{},"deaths":{}}})",
+                result.m_census->m_population,
+                result.m_census->m_births,
+                result.m_census->m_deaths
+            );
+        }
+        if (result.m_allocationsPerTick) {
+            line.pop_back();
+            line += std::format(R"(,"allocations_per_tick":{:.2f}}})", *result.m_allocationsPerTick);
+        }
+        std::fputs(line.c_str(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }
+};
+
+#endif /* end of include guard: HEADLESS_HPP_P7DK2XRC */
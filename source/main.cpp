@@ -1,10 +1,58 @@
+#include "alloc_counter.hpp"
 #include "application.hpp"
 #include "game.hpp"
+#include "headless.hpp"
+#include "renderer.hpp"
+#include "simulation.hpp"
 
 #include <CLI/CLI.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <new>
+#include <optional>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef GOL_COUNT_ALLOCATIONS
+// every heap allocation of the process goes through these, the nothrow and sized forms end up here too
+void* operator new(std::size_t size)
+{
+    AllocCounter::count();
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    AllocCounter::count();
+    const auto align = static_cast<std::size_t>(alignment);
+    if (auto* ptr = std::aligned_alloc(align, (std::max(size, std::size_t{ 1 }) + align - 1) / align * align)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
 
 int main(int argc, char** argv)
 {
@@ -18,34 +66,193 @@ int main(int argc, char** argv)
     bool        noVsync  = false;
     bool        debug    = false;
     auto        strategy = Grid::UpdateStrategy::INTERLEAVED;
+    int         hlStep   = 0;
+    std::size_t hlCache  = HashLife::s_defaultCacheLimit;
+    bool        tiles    = false;
+    int         genTick  = 1;
+    bool        gpu      = false;
+    auto        render   = Renderer::RenderMode::INDICES;
+    bool        lod      = false;
+    bool        pinned   = false;
+    bool        numa     = false;
+    std::string ruleSpec = "B3/S23";
+    auto        boundary = Grid::Boundary::TORUS;
+    std::string stats    = "phase_stats.csv";
+
+    std::optional<std::filesystem::path> pattern;
+    std::pair<int, int>                  patternOffset;
+    std::optional<std::filesystem::path> resume;
+    std::filesystem::path                snapshot   = "snapshot.gol";
+    std::uint64_t                        checkpoint = 0;
+    std::uint64_t                        jumpTo     = 0;
+    auto                                 onCycle    = Simulation::CycleAction::REPORT;
+    bool                                 census     = false;
+    std::size_t                          censusKeep = 0;
+
+    bool                                 headless      = false;
+    int                                  generations   = 1000;
+    std::optional<std::uint64_t>         seed;
+    std::size_t                          threads       = std::max(std::thread::hardware_concurrency(), 1u);
+    std::optional<std::filesystem::path> mappedFile;
+    std::vector<std::string>             shards;
+    std::size_t                          shardRank     = 0;
+    int                                  shardView     = 0;
+    std::filesystem::path                shardViewFile = "shard_view.pgm";
 
     app.add_option("-l,--length", length, "The length of the world grid")->required(true);
     app.add_option("-w,--width", width, "The width of the world grid")->required(true);
     app.add_option("-t,--delay", delay, "Delay for each update (in milliseconds)");
     app.add_option("-d,--density", density, "Start density")->check(CLI::Range(0.0f, 1.0f));
+    app.add_option("--pattern", pattern, "Start from a pattern file instead (RLE, plaintext or Life 1.06)")
+        ->check(CLI::ExistingFile);
+    app.add_option("--pattern-offset", patternOffset, "Column and row of the lower left cell of the pattern, else centered");
+    app.add_option("--resume", resume, "Start from a snapshot (see --snapshot)")->check(CLI::ExistingFile);
+    app.add_option("--snapshot", snapshot, "Where the snapshots are saved (F5, --checkpoint), and restored from (F9)");
+    app.add_option("--checkpoint", checkpoint, "Save a snapshot every n generations, 0 to never");
+    app.add_option("--jump-to", jumpTo, "Fast-forward to this generation on start, without drawing the ones before it");
+    app.add_option("--on-cycle", onCycle, "What to do once the states repeat (off skips the hashing)")
+        ->transform(CLI::CheckedTransformer(Simulation::s_cycleActionMap, CLI::ignore_case));
+    app.add_flag("--census", census, "Count the population, births and deaths of every generation (stats overlay)");
+    app.add_option("--census-history", censusKeep, "Number of generations of the census kept, 0 for the last one only");
     app.add_flag("--paused", pause, "Start the simulation on a paused state");
     app.add_flag("--no-vsync", noVsync, "Turn off vsync");
     app.add_flag("--debug", debug, "Print debugging info");
+    app.add_option("--stats-file", stats, "Where the phase timings are saved every second with --debug (.json or .csv)");
 
+    app.add_option("--rule", ruleSpec, "Rule in B/S notation, a C part makes it Generations (B2/S/C3 is Brian's Brain)")
+        ->check([](const std::string& spec) {
+            try {
+                (void)Rule{ spec };
+                return std::string{};
+            } catch (std::exception& e) {
+                return std::string{ e.what() };
+            }
+        });
+    app.add_option("--boundary", boundary, "What the cells on the edges see past them")
+        ->transform(CLI::CheckedTransformer(Grid::s_boundaryMap, CLI::ignore_case));
     app.add_option("--update-strategy", strategy, "The strategy to be used on updates (multithreaded)")
         ->transform(CLI::CheckedTransformer(Grid::s_updateStrategyMap, CLI::ignore_case));
+    app.add_option("--hashlife-step", hlStep, "Advance 2^step generations per tick (hashlife strategy)")
+        ->check(CLI::Range(0, 56));
+    app.add_option("--hashlife-cache", hlCache, "Number of quadtree nodes kept before garbage collection (hashlife strategy)");
+    app.add_flag("--active-tiles", tiles, "Skip tiles that didn't change (interleaved, chunked and stealing strategies)");
+    app.add_option("--generations-per-tick", genTick, "Generations computed per tick, only the last one is shown")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--render-mode", render, "How the cells are sent to the GPU (ignored with --gpu)")
+        ->transform(CLI::CheckedTransformer(Renderer::s_renderModeMap, CLI::ignore_case));
+    app.add_flag("--lod", lod, "Draw a density pyramid, built by the simulation, when zoomed out past a cell per pixel");
+    app.add_flag("--pin-threads", pinned, "Pin every worker thread to its own cpu");
+    app.add_flag("--numa", numa, "Pin the workers node after node and place each row on the node of its worker");
+    app.add_flag("--gpu", gpu, "Run the simulation on the GPU (the update strategy is only used to populate)");
+
+    app.add_flag("--headless", headless, "Only run the simulation, without window, and print the results as JSON lines");
+    app.add_option("--generations", generations, "Number of updates per update strategy (headless)")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--seed", seed, "Seed of the populations, taken from the clock if not set");
+    app.add_option("--threads", threads, "Number of worker threads (headless)")->check(CLI::PositiveNumber);
+    app.add_option(
+        "--mapped-file", mappedFile, "Cells of the mapped strategy, replaced (headless only runs mapped when set)"
+    );
+    app.add_option("--shards", shards, "host:port of every shard in rank order, run as one of them (headless)")
+        ->delimiter(',');
+    app.add_option("--shard-rank", shardRank, "Which of the shards this process is (headless)");
+    app.add_option("--shard-view", shardView, "Scale down of the view rank 0 gathers at the end, 0 for none (headless)")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--shard-view-file", shardViewFile, "Where rank 0 writes the view, as a PGM image (headless)");
 
     CLI11_PARSE(app, argc, argv);
 
+    const auto offset    = app.count("--pattern-offset") > 0 ? std::optional{ patternOffset } : std::nullopt;
+    const auto clockSeed = static_cast<std::uint64_t>(std::time(nullptr));
+    const auto rule      = Rule{ ruleSpec };
+    const auto placement = numa ? Grid::Placement::NUMA : (pinned ? Grid::Placement::PINNED : Grid::Placement::DEFAULT);
+
+    if (headless) {
+        // keep stdout machine-readable
+        spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+    }
     if (debug) {
         spdlog::set_level(spdlog::level::debug);
     }
 
+    if (headless) {
+        std::vector<Grid::UpdateStrategy> strategies;
+        if (app.count("--update-strategy") > 0) {
+            strategies.push_back(strategy);
+        } else {
+            // MAPPED writes its file, only when asked for one
+            for (const auto& [name, value] : Grid::s_updateStrategyMap) {
+                if (value == Grid::UpdateStrategy::MAPPED && !mappedFile) {
+                    continue;
+                }
+                if (Grid::supportsRule(value, rule) && Grid::supportsBoundary(value, boundary)) {
+                    strategies.push_back(value);
+                }
+            }
+        }
+
+        try {
+            return Headless::run({
+                .m_gridWidth          = length,
+                .m_gridHeight         = width,
+                .m_density            = density,
+                .m_generations        = generations,
+                .m_seed               = seed.value_or(clockSeed),
+                .m_threads            = threads,
+                .m_hashLifeStep       = hlStep,
+                .m_hashLifeCacheLimit = hlCache,
+                .m_trackActiveTiles   = tiles,
+                .m_rule               = rule,
+                .m_strategies         = std::move(strategies),
+                .m_pattern            = pattern,
+                .m_patternOffset      = offset,
+                .m_mappedFile         = mappedFile.value_or(Grid::s_defaultMappedFile),
+                .m_placement          = placement,
+                .m_census             = census,
+                .m_boundary           = boundary,
+                .m_shardAddresses     = std::move(shards),
+                .m_shardRank          = shardRank,
+                .m_shardViewFactor    = shardView,
+                .m_shardViewFile      = shardViewFile,
+            });
+        } catch (std::exception& e) {
+            spdlog::critical("(main) Exception occurred: {}", e.what());
+            return 1;
+        }
+    }
+
     try {
         Application application{ {
-            .m_windowWidth    = 800,
-            .m_windowHeight   = 600,
-            .m_gridWidth      = length,
-            .m_gridHeight     = width,
-            .m_startDensity   = density,
-            .m_delay          = delay,    // s to ms
-            .m_vsync          = !noVsync,
-            .m_updateStrategy = strategy,
+            .m_windowWidth        = 800,
+            .m_windowHeight       = 600,
+            .m_gridWidth          = length,
+            .m_gridHeight         = width,
+            .m_startDensity       = density,
+            .m_delay              = delay,    // s to ms
+            .m_vsync              = !noVsync,
+            .m_updateStrategy     = strategy,
+            .m_hashLifeStep       = hlStep,
+            .m_hashLifeCacheLimit = hlCache,
+            .m_trackActiveTiles   = tiles,
+            .m_generationsPerTick = genTick,
+            .m_gpu                = gpu,
+            .m_renderMode         = render,
+            .m_levelOfDetail      = lod,
+            .m_placement          = placement,
+            .m_seed               = seed.value_or(clockSeed),
+            .m_rule               = rule,
+            .m_boundary           = boundary,
+            .m_statsFile          = debug ? std::optional<std::filesystem::path>{ stats } : std::nullopt,
+            .m_pattern            = pattern,
+            .m_patternOffset      = offset,
+            .m_resume             = resume,
+            .m_snapshotFile       = snapshot,
+            .m_mappedFile         = mappedFile.value_or(Grid::s_defaultMappedFile),
+            .m_checkpointInterval = checkpoint,
+            .m_jumpTo             = jumpTo,
+            .m_cycleAction        = onCycle,
+            .m_census             = census,
+            .m_censusHistory      = censusKeep,
         } };
         application.run();
     } catch (std::exception& e) {
@@ -0,0 +1,155 @@
+#ifndef MAPPED_FILE_HPP_W3ZC8PLA
+#define MAPPED_FILE_HPP_W3ZC8PLA
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// A whole file mapped read-only into memory, the pages are only read from the disk when touched so files larger than
+// the memory are fine as long as they are read through once. An empty file maps to an empty span.
+//
+// create() maps a new file read-write instead, the memory is the file: the pages written to are written back to the
+// disk by the kernel, whenever it needs the memory or the mapping goes away.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& path)
+    {
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error{ std::format("can't open '{}': {}", path.string(), std::strerror(errno)) };
+        }
+
+        struct stat info = {};
+        if (::fstat(fd, &info) != 0) {
+            const auto error = errno;
+            ::close(fd);
+            throw std::runtime_error{ std::format("can't stat '{}': {}", path.string(), std::strerror(error)) };
+        }
+
+        m_size = (std::size_t)info.st_size;
+        if (m_size > 0) {
+            auto* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                const auto error = errno;
+                ::close(fd);
+                throw std::runtime_error{ std::format("can't map '{}': {}", path.string(), std::strerror(error)) };
+            }
+            m_data = static_cast<char*>(data);
+            ::madvise(data, m_size, MADV_SEQUENTIAL);    // a hint, read from start to end (by bands on each thread)
+        }
+
+        ::close(fd);    // the mapping keeps the file alive
+    }
+
+    // `size` bytes of zeroes, replacing the file if it exists. the file is sparse, it only takes space on the disk
+    // where it was written to
+    static MappedFile create(const std::filesystem::path& path, std::size_t size)
+    {
+        const auto fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error{ std::format("can't create '{}': {}", path.string(), std::strerror(errno)) };
+        }
+
+        auto fail = [&](std::string_view what) {
+            const auto error = errno;
+            ::close(fd);
+            throw std::runtime_error{ std::format("can't {} '{}': {}", what, path.string(), std::strerror(error)) };
+        };
+
+        if (::ftruncate(fd, (off_t)size) != 0) {
+            fail("resize");
+        }
+
+        auto file = MappedFile{};
+        if (size > 0) {
+            auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                fail("map");
+            }
+            file.m_data     = static_cast<char*>(data);
+            file.m_size     = size;
+            file.m_writable = true;
+        }
+
+        ::close(fd);
+        return file;
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_data{ std::exchange(other.m_data, nullptr) }
+        , m_size{ std::exchange(other.m_size, 0) }
+        , m_writable{ std::exchange(other.m_writable, false) }
+    {
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other) {
+            unmap();
+            m_data     = std::exchange(other.m_data, nullptr);
+            m_size     = std::exchange(other.m_size, 0);
+            m_writable = std::exchange(other.m_writable, false);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { unmap(); }
+
+    std::span<const char> bytes() const { return { m_data, m_size }; }
+    std::size_t           size() const { return m_size; }
+
+    // only for the files mapped by create()
+    std::span<char> writableBytes()
+    {
+        if (!m_writable) {
+            throw std::logic_error{ "the file is mapped read-only" };
+        }
+        return { m_data, m_size };
+    }
+
+    // madvise() over [offset, offset + length), widened to whole pages; only a hint, failures are ignored
+    void advise(std::size_t offset, std::size_t length, int advice) const
+    {
+        static const auto s_pageSize = (std::size_t)::sysconf(_SC_PAGESIZE);
+
+        offset = std::min(offset, m_size);
+        length = std::min(length, m_size - offset);
+
+        const auto start = offset / s_pageSize * s_pageSize;
+        if (length > 0) {
+            ::madvise(m_data + start, offset + length - start, advice);
+        }
+    }
+
+private:
+    char*       m_data     = nullptr;
+    std::size_t m_size     = 0;
+    bool        m_writable = false;
+
+    MappedFile() = default;
+
+    void unmap()
+    {
+        if (m_data != nullptr) {
+            ::munmap(m_data, m_size);
+        }
+    }
+};
+
+#endif /* end of include guard: MAPPED_FILE_HPP_W3ZC8PLA */
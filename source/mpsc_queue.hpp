@@ -0,0 +1,96 @@
+#ifndef MPSC_QUEUE_HPP_T5GJ2WLC
+#define MPSC_QUEUE_HPP_T5GJ2WLC
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+// Fixed capacity multi-producer, single-consumer queue, lock-free (Vyukov's bounded queue). Each slot carries a
+// sequence number telling whose turn it is: producers claim a slot by bumping the tail, fill it, then hand it to the
+// consumer by bumping its sequence; the consumer hands it back to the producers one lap later the same way. Nothing is
+// allocated after construction.
+//
+// A producer that claimed a slot but didn't fill it yet holds back the consumer (pop() returns nothing until it's done),
+// not the other producers.
+template <std::movable T, std::size_t Capacity>
+    requires std::default_initializable<T> && (std::has_single_bit(Capacity))
+class MpscQueue
+{
+public:
+    MpscQueue()
+    {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&)            = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // any thread; false if the queue is full, `value` is left untouched then
+    bool push(T&& value)
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            auto&      slot     = m_slots[tail & s_mask];
+            const auto sequence = slot.m_sequence.load(std::memory_order_acquire);
+            const auto diff     = (std::intptr_t)sequence - (std::intptr_t)tail;
+
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                    slot.m_value = std::move(value);
+                    slot.m_sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;    // the consumer didn't release this slot yet: a whole lap behind
+            } else {
+                tail = m_tail.load(std::memory_order_relaxed);    // another producer took it
+            }
+        }
+    }
+
+    bool push(const T& value)
+    {
+        auto copy = value;
+        return push(std::move(copy));
+    }
+
+    // consumer thread only
+    std::optional<T> pop()
+    {
+        auto&      slot     = m_slots[m_head & s_mask];
+        const auto sequence = slot.m_sequence.load(std::memory_order_acquire);
+        if ((std::intptr_t)sequence - (std::intptr_t)(m_head + 1) < 0) {
+            return std::nullopt;
+        }
+
+        auto value = std::exchange(slot.m_value, T{});    // don't keep whatever it owns alive until the next lap
+        slot.m_sequence.store(m_head + Capacity, std::memory_order_release);
+        ++m_head;
+        return value;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t s_mask = Capacity - 1;
+
+    struct Slot
+    {
+        std::atomic<std::size_t> m_sequence;
+        T                        m_value;
+    };
+
+    std::array<Slot, Capacity> m_slots;
+
+    alignas(64) std::atomic<std::size_t> m_tail = 0;    // producers
+    alignas(64) std::size_t m_head              = 0;    // consumer only
+};
+
+#endif /* end of include guard: MPSC_QUEUE_HPP_T5GJ2WLC */
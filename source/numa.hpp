@@ -0,0 +1,144 @@
+#ifndef NUMA_HPP_E2HV7MLC
+#define NUMA_HPP_E2HV7MLC
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// The NUMA nodes of the machine and the CPUs on each of them, read once from sysfs (no libnuma). Only the CPUs the
+// process may run on are kept. Without NUMA, or without sysfs, the machine is a single node with all of them.
+class NumaTopology
+{
+public:
+    static const NumaTopology& get()
+    {
+        static const NumaTopology s_topology = detect();
+        return s_topology;
+    }
+
+    std::size_t nodeCount() const { return m_nodes.size(); }
+
+    std::span<const int> cpusOf(std::size_t node) const { return m_nodes[node]; }
+
+    // node after node, the order the workers are pinned in
+    std::vector<int> cpus() const
+    {
+        std::vector<int> cpus;
+        for (const auto& node : m_nodes) {
+            cpus.insert(cpus.end(), node.begin(), node.end());
+        }
+        return cpus;
+    }
+
+    std::size_t nodeOf(int cpu) const
+    {
+        for (std::size_t node = 0; node < m_nodes.size(); ++node) {
+            if (std::ranges::find(m_nodes[node], cpu) != m_nodes[node].end()) {
+                return node;
+            }
+        }
+        return 0;
+    }
+
+    // the node the calling thread is running on right now
+    std::size_t currentNode() const { return nodeOf(::sched_getcpu()); }
+
+    // a failure is only logged, the thread then keeps running wherever the scheduler puts it
+    static bool pin(std::thread::native_handle_type thread, int cpu)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (const auto error = ::pthread_setaffinity_np(thread, sizeof(set), &set); error != 0) {
+            spdlog::warn("(NumaTopology) Can't pin a thread to cpu [{}]: error [{}]", cpu, error);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::vector<std::vector<int>> m_nodes;    // never empty, nor any of its nodes
+
+    static NumaTopology detect()
+    {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        ::sched_getaffinity(0, sizeof(allowed), &allowed);
+
+        auto isAllowed = [&](int cpu) { return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed); };
+
+        // the ids of the nodes online may have holes (a node offline, or without memory on some machines)
+        NumaTopology topology;
+        for (const int node : parseCpuList(readLine("/sys/devices/system/node/online"))) {
+            auto cpus = parseCpuList(readLine(std::format("/sys/devices/system/node/node{}/cpulist", node)));
+            std::erase_if(cpus, [&](int cpu) { return !isAllowed(cpu); });
+            if (!cpus.empty()) {
+                topology.m_nodes.push_back(std::move(cpus));
+            }
+        }
+
+        if (topology.m_nodes.empty()) {
+            auto& cpus = topology.m_nodes.emplace_back();
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (isAllowed(cpu)) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (cpus.empty()) {
+                cpus.push_back(0);
+            }
+        }
+
+        spdlog::info("(NumaTopology) Found [{}] node(s)", topology.m_nodes.size());
+        return topology;
+    }
+
+    // the first line of a sysfs file, empty if there is no such file
+    static std::string readLine(const std::string& path)
+    {
+        std::ifstream file{ path };
+        std::string   line;
+        if (!file || !std::getline(file, line)) {
+            return {};
+        }
+        return line;
+    }
+
+    // the kernel's list format: "0-3,8-11,16", of cpus or of nodes
+    static std::vector<int> parseCpuList(std::string_view list)
+    {
+        std::vector<int> cpus;
+        while (!list.empty()) {
+            const auto comma = list.find(',');
+            const auto range = list.substr(0, comma);
+            list             = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+            const auto dash = range.find('-');
+
+            int first = 0;
+            std::from_chars(range.data(), range.data() + range.size(), first);
+            int last = first;
+            if (dash != std::string_view::npos) {
+                std::from_chars(range.data() + dash + 1, range.data() + range.size(), last);
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+};
+
+#endif /* end of include guard: NUMA_HPP_E2HV7MLC */
@@ -0,0 +1,404 @@
+#ifndef PATTERN_HPP_K2MD7QXT
+#define PATTERN_HPP_K2MD7QXT
+
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A pattern file, decoded straight from its memory mapping: nothing but the read position is kept between the file and
+// the fn(x, y) called for every live cell, with (0, 0) the top left cell of the pattern. The constructor reads through
+// the file once to find its bounds and where each band of s_bandRows rows starts, decodeChunk() then turns one band
+// into cells; the bands of RLE and plaintext files don't share any row so they can be decoded on different threads.
+//
+// Supported formats:
+//  - RLE (.rle), the `x = .., y = ..` header gives the size, the rule is kept as-is (see rule())
+//  - plaintext (.cells), `O` or `*` is a live cell, lines starting with `!` are comments
+//  - Life 1.06 (.lif, .life), one `x y` per live cell; the coordinates are in no particular order, so the whole file is
+//    a single chunk
+class Pattern
+{
+public:
+    enum class Format
+    {
+        RLE,
+        PLAINTEXT,
+        LIFE_106,
+    };
+
+    explicit Pattern(const std::filesystem::path& path)
+        : m_file{ path }
+        , m_text{ m_file.bytes().data(), m_file.size() }
+        , m_format{ detectFormat(path, m_text) }
+    {
+        try {
+            switch (m_format) {
+            case Format::RLE: scanRle(); break;
+            case Format::PLAINTEXT: scanPlaintext(); break;
+            case Format::LIFE_106: scanLife106(); break;
+            }
+        } catch (const std::exception& e) {
+            throw std::runtime_error{ std::format("invalid pattern '{}': {}", path.string(), e.what()) };
+        }
+    }
+
+    Format             format() const { return m_format; }
+    int                width() const { return m_width; }
+    int                height() const { return m_height; }
+    const std::string& rule() const { return m_rule; }    // only given by RLE files, empty otherwise
+    std::size_t        numOfChunks() const { return m_chunks.size(); }
+
+    std::string_view formatName() const
+    {
+        switch (m_format) {
+        case Format::RLE: return "rle";
+        case Format::PLAINTEXT: return "plaintext";
+        case Format::LIFE_106: return "life 1.06";
+        }
+        return "unknown";
+    }
+
+    // fn(x, y) for every live cell of the chunk, each once; cells outside of width() x height() are dropped
+    void decodeChunk(std::size_t index, std::invocable<int, int> auto&& fn) const
+    {
+        const auto& chunk = m_chunks[index];
+        const auto  text  = m_text.substr(chunk.m_begin, chunk.m_end - chunk.m_begin);
+
+        auto emit = [&](long x, long y) {
+            if (x >= 0 && y >= 0 && x < m_width && y < m_height) {
+                fn((int)x, (int)y);
+            }
+        };
+
+        switch (m_format) {
+        case Format::RLE: decodeRle(text, chunk.m_row, emit); break;
+        case Format::PLAINTEXT: decodePlaintext(text, chunk.m_row, emit); break;
+        case Format::LIFE_106: decodeLife106(text, emit); break;
+        }
+    }
+
+    // every chunk one after the other
+    void decode(std::invocable<int, int> auto&& fn) const
+    {
+        for (std::size_t i = 0; i < m_chunks.size(); ++i) {
+            decodeChunk(i, fn);
+        }
+    }
+
+private:
+    // a band of rows, [m_begin, m_end) in the file, starting at m_row
+    struct Chunk
+    {
+        std::size_t m_begin;
+        std::size_t m_end;
+        long        m_row;
+    };
+
+    static constexpr long s_bandRows = 64;
+    static constexpr long s_maxSize  = std::numeric_limits<int>::max();
+
+    MappedFile         m_file;
+    std::string_view   m_text;
+    Format             m_format;
+    int                m_width  = 0;
+    int                m_height = 0;
+    long               m_xMin   = 0;    // Life 1.06 coordinates are relative to anywhere, they are moved to (0, 0)
+    long               m_yMin   = 0;
+    std::string        m_rule;
+    std::vector<Chunk> m_chunks;
+
+    static Format detectFormat(const std::filesystem::path& path, std::string_view text)
+    {
+        if (text.starts_with("#Life 1.06")) {
+            return Format::LIFE_106;
+        }
+        if (text.starts_with("#Life 1.05")) {
+            throw std::runtime_error{ std::format("'{}': Life 1.05 patterns are not supported", path.string()) };
+        }
+
+        auto extension = path.extension().string();
+        std::ranges::transform(extension, extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+        if (extension == ".rle") {
+            return Format::RLE;
+        } else if (extension == ".cells") {
+            return Format::PLAINTEXT;
+        } else if (extension == ".lif" || extension == ".life") {
+            return Format::LIFE_106;
+        }
+
+        // no telling extension: RLE files have their header line right after the comments
+        while (!text.empty()) {
+            const auto line = nextLine(text);
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+            return line.starts_with("x ") || line.starts_with("x=") ? Format::RLE : Format::PLAINTEXT;
+        }
+        return Format::PLAINTEXT;
+    }
+
+    // RLE
+    // ---
+
+    void scanRle()
+    {
+        auto rest = m_text;
+        auto line = std::string_view{};
+        do {
+            if (rest.empty()) {
+                throw std::runtime_error{ "missing the 'x = .., y = ..' header" };
+            }
+            line = nextLine(rest);
+        } while (line.empty() || line.front() == '#');
+
+        bool hasWidth  = false;
+        bool hasHeight = false;
+        while (!line.empty()) {
+            const auto comma = line.find(',');
+            const auto field = line.substr(0, comma);
+            line             = comma == std::string_view::npos ? std::string_view{} : line.substr(comma + 1);
+
+            const auto equal = field.find('=');
+            if (equal == std::string_view::npos) {
+                throw std::runtime_error{ std::format("unexpected '{}' in the header", trim(field)) };
+            }
+            const auto key   = trim(field.substr(0, equal));
+            auto       value = trim(field.substr(equal + 1));
+
+            if (key == "x") {
+                m_width  = (int)parseNumber(value, 0, s_maxSize);
+                hasWidth = true;
+            } else if (key == "y") {
+                m_height  = (int)parseNumber(value, 0, s_maxSize);
+                hasHeight = true;
+            } else if (key == "rule") {
+                m_rule = value;
+            }
+        }
+        if (!hasWidth || !hasHeight) {
+            throw std::runtime_error{ "missing the 'x = .., y = ..' header" };
+        }
+
+        // only the run counts and the row ends matter to know where the bands start
+        const auto data  = (std::size_t)(rest.data() - m_text.data());
+        auto       begin = data;
+        long       row   = 0;
+        long       band  = 0;
+        long       count = 0;
+
+        for (auto pos = data; pos < m_text.size(); ++pos) {
+            const auto c = m_text[pos];
+            if (isDigit(c)) {
+                count = std::min(count * 10 + (c - '0'), s_maxSize);
+            } else if (c == '$') {
+                row   += std::max(count, 1l);
+                count  = 0;
+                if (row >= band + s_bandRows) {
+                    m_chunks.push_back({ begin, pos + 1, band });
+                    begin = pos + 1;
+                    band  = row;
+                }
+            } else if (c == '!') {
+                m_chunks.push_back({ begin, pos, band });
+                return;
+            } else if (std::isalpha((unsigned char)c) || c == '.') {
+                count = 0;
+            } else if (!std::isspace((unsigned char)c)) {
+                throw std::runtime_error{ std::format("unexpected '{}' in the cells", c) };
+            }
+        }
+        m_chunks.push_back({ begin, m_text.size(), band });    // the final '!' is missing, be lenient
+    }
+
+    static void decodeRle(std::string_view text, long row, auto&& emit)
+    {
+        long col   = 0;
+        long count = 0;
+
+        for (const auto c : text) {
+            if (isDigit(c)) {
+                count = std::min(count * 10 + (c - '0'), s_maxSize);
+                continue;
+            }
+
+            const auto run = std::max(count, 1l);
+            if (c == '$') {
+                row += run;
+                col  = 0;
+            } else if (c == 'b' || c == '.') {
+                col += run;
+            } else if (std::isalpha((unsigned char)c)) {
+                for (long i = 0; i < run; ++i) {
+                    emit(col + i, row);
+                }
+                col += run;
+            } else if (c == '!') {
+                return;
+            } else {
+                continue;    // whitespace, keep the count
+            }
+            count = 0;
+        }
+    }
+
+    // Plaintext
+    // ---------
+
+    void scanPlaintext()
+    {
+        auto rest  = m_text;
+        auto begin = std::size_t{ 0 };
+        long row   = 0;
+        long band  = 0;
+        long width = 0;
+
+        while (!rest.empty()) {
+            const auto start = (std::size_t)(rest.data() - m_text.data());
+            const auto line  = nextLine(rest);
+            if (line.starts_with('!')) {
+                continue;
+            }
+
+            if (row == band + s_bandRows) {
+                m_chunks.push_back({ begin, start, band });
+                begin = start;
+                band  = row;
+            }
+            width = std::max(width, (long)line.size());
+            ++row;
+        }
+        m_chunks.push_back({ begin, m_text.size(), band });
+
+        if (row > s_maxSize || width > s_maxSize) {
+            throw std::runtime_error{ "too large" };
+        }
+        m_width  = (int)width;
+        m_height = (int)row;
+    }
+
+    static void decodePlaintext(std::string_view text, long row, auto&& emit)
+    {
+        while (!text.empty()) {
+            const auto line = nextLine(text);
+            if (line.starts_with('!')) {
+                continue;
+            }
+            for (std::size_t col = 0; col < line.size(); ++col) {
+                if (line[col] == 'O' || line[col] == '*') {
+                    emit((long)col, row);
+                }
+            }
+            ++row;
+        }
+    }
+
+    // Life 1.06
+    // ---------
+
+    void scanLife106()
+    {
+        auto rest = m_text;
+        long xMin = std::numeric_limits<long>::max();
+        long yMin = std::numeric_limits<long>::max();
+        long xMax = std::numeric_limits<long>::min();
+        long yMax = std::numeric_limits<long>::min();
+
+        forEachCoord(rest, [&](long x, long y) {
+            xMin = std::min(xMin, x);
+            yMin = std::min(yMin, y);
+            xMax = std::max(xMax, x);
+            yMax = std::max(yMax, y);
+        });
+
+        m_chunks.push_back({ 0, m_text.size(), 0 });
+        if (xMin > xMax) {
+            return;    // no cell at all
+        }
+        if (xMax - xMin >= s_maxSize || yMax - yMin >= s_maxSize) {
+            throw std::runtime_error{ "too large" };
+        }
+
+        m_xMin   = xMin;
+        m_yMin   = yMin;
+        m_width  = (int)(xMax - xMin + 1);
+        m_height = (int)(yMax - yMin + 1);
+    }
+
+    void decodeLife106(std::string_view text, auto&& emit) const
+    {
+        forEachCoord(text, [&](long x, long y) { emit(x - m_xMin, y - m_yMin); });
+    }
+
+    static void forEachCoord(std::string_view text, auto&& fn)
+    {
+        constexpr auto limit = std::numeric_limits<int>::max() / 2;
+        while (!text.empty()) {
+            auto line = nextLine(text);
+            if (line.empty() || line.front() == '#') {
+                continue;
+            }
+            const auto x = parseNumber(line, -limit, limit);
+            const auto y = parseNumber(line, -limit, limit);
+            if (!trim(line).empty()) {
+                throw std::runtime_error{ std::format("unexpected '{}' after the coordinates", trim(line)) };
+            }
+            fn(x, y);
+        }
+    }
+
+    // helpers
+    // -------
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    static std::string_view trim(std::string_view text)
+    {
+        const auto first = text.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    // the line at the start of `text` without its line ending, `text` is moved past it
+    static std::string_view nextLine(std::string_view& text)
+    {
+        const auto end  = text.find('\n');
+        auto       line = text.substr(0, end);
+        text            = text.substr(end == std::string_view::npos ? text.size() : end + 1);    // keep its position
+
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    // the number at the start of `text` (after blanks), `text` is moved past it
+    static long parseNumber(std::string_view& text, long min, long max)
+    {
+        text = text.substr(std::min(text.find_first_not_of(" \t"), text.size()));
+
+        long value          = 0;
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc{} || value < min || value > max) {
+            const auto near = text.substr(0, 16);
+            throw std::runtime_error{ std::format("expected a number in [{}, {}] at '{}'", min, max, near) };
+        }
+
+        text.remove_prefix((std::size_t)(end - text.data()));
+        return value;
+    }
+};
+
+#endif /* end of include guard: PATTERN_HPP_K2MD7QXT */
@@ -0,0 +1,326 @@
+#ifndef PHASE_STATS_HPP_R4TN8QWE
+#define PHASE_STATS_HPP_R4TN8QWE
+
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <limits>
+#include <string_view>
+
+// Lock-free histogram of durations, recording is a handful of relaxed atomic operations so it can stay enabled all the
+// time. The buckets are log-linear: 8 buckets per power of two (like HdrHistogram with 3 bits of precision), so any
+// percentile is off by at most 12.5% from the real value while all of it fits in 2 KiB.
+class PhaseHistogram
+{
+public:
+    struct Summary
+    {
+        std::uint64_t m_count = 0;
+        double        m_total = 0.0;    // in milliseconds, the rest too
+        double        m_min   = 0.0;
+        double        m_p50   = 0.0;
+        double        m_p99   = 0.0;
+        double        m_max   = 0.0;
+    };
+
+    void record(std::chrono::nanoseconds duration)
+    {
+        const auto ns = (std::uint64_t)std::max(duration.count(), std::int64_t{ 0 });
+
+        m_buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_total.fetch_add(ns, std::memory_order_relaxed);
+
+        auto min = m_min.load(std::memory_order_relaxed);
+        while (ns < min && !m_min.compare_exchange_weak(min, ns, std::memory_order_relaxed)) { }
+        auto max = m_max.load(std::memory_order_relaxed);
+        while (ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed)) { }
+    }
+
+    // summarize what was recorded since the last drain() and start over; a record() racing with it lands in either
+    // one, but it is never lost
+    Summary drain()
+    {
+        std::array<std::uint32_t, s_numBuckets> counts;
+
+        std::uint64_t count = 0;
+        for (std::size_t i = 0; i < s_numBuckets; ++i) {
+            counts[i]  = m_buckets[i].exchange(0, std::memory_order_relaxed);
+            count     += counts[i];
+        }
+
+        const auto total = m_total.exchange(0, std::memory_order_relaxed);
+        const auto min   = m_min.exchange(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        const auto max   = m_max.exchange(0, std::memory_order_relaxed);
+
+        if (count == 0) {
+            return {};
+        }
+
+        // nearest rank, reported as the upper bound of the bucket it falls in (but never outside of [min, max])
+        auto percentile = [&](double p) {
+            const auto    rank = std::max((std::uint64_t)(p * (double)count + 0.5), std::uint64_t{ 1 });
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < s_numBuckets; ++i) {
+                if ((seen += counts[i]) >= rank) {
+                    return std::clamp(upperBoundOf(i), min, max);
+                }
+            }
+            return max;
+        };
+
+        auto ms = [](std::uint64_t ns) { return (double)ns / 1e6; };
+
+        return {
+            .m_count = count,
+            .m_total = ms(total),
+            .m_min   = ms(min),
+            .m_p50   = ms(percentile(0.50)),
+            .m_p99   = ms(percentile(0.99)),
+            .m_max   = ms(max),
+        };
+    }
+
+private:
+    static constexpr int         s_subBits    = 3;
+    static constexpr std::size_t s_subBuckets = 1 << s_subBits;
+    static constexpr std::size_t s_numBuckets = (64 - s_subBits + 1) * s_subBuckets;
+
+    // values below s_subBuckets have a bucket each, then each power of two is split in s_subBuckets
+    static constexpr std::size_t bucketOf(std::uint64_t ns)
+    {
+        if (ns < s_subBuckets) {
+            return (std::size_t)ns;
+        }
+        const auto exponent = std::bit_width(ns) - 1;    // >= s_subBits
+        const auto shift    = exponent - s_subBits;
+        const auto sub      = (ns >> shift) & (s_subBuckets - 1);
+        return (std::size_t)(shift + 1) * s_subBuckets + sub;
+    }
+
+    static constexpr std::uint64_t upperBoundOf(std::size_t bucket)
+    {
+        if (bucket < s_subBuckets) {
+            return bucket;
+        }
+        const auto shift = bucket / s_subBuckets - 1;
+        const auto lower = (std::uint64_t)(s_subBuckets + bucket % s_subBuckets) << shift;
+        return lower + ((std::uint64_t{ 1 } << shift) - 1);
+    }
+
+    std::array<std::atomic<std::uint32_t>, s_numBuckets> m_buckets = {};
+
+    std::atomic<std::uint64_t> m_total = 0;
+    std::atomic<std::uint64_t> m_min   = std::numeric_limits<std::uint64_t>::max();
+    std::atomic<std::uint64_t> m_max   = 0;
+};
+
+// Process-wide timing of each phase of a tick and of a frame, recorded from whichever thread runs the phase. Read by
+// draining every histogram at once (see PhaseStats::drain()), usually once per second.
+//
+// NOTE: the phases touching OpenGL only measure the CPU side of the calls, the GPU runs them asynchronously
+class PhaseStats
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Phase
+    {
+        UPDATE,            // the update kernel, on the simulation thread (the step dispatch on the GPU one)
+        HANDOFF,           // publishing the new state to the renderer
+        SIM_LOCK_WAIT,     // the simulation waiting for the grid mutex
+        EDIT_LOCK_WAIT,    // posting an edit waiting for the grid mutex, only when the command queue is full
+        PREPARE,           // collecting the visible live cells (customizeIndices(), the instances)
+        UPLOAD,            // sending them to the GPU (buffer data, the texture stream)
+        DRAW,              // the draw calls
+        FRAME,             // the whole frame on the render thread, without the swap
+
+        numOfPhases,
+    };
+
+    static constexpr auto s_numOfPhases = (std::size_t)Phase::numOfPhases;
+
+    static constexpr std::array<std::string_view, s_numOfPhases> s_phaseNames{
+        "update", "handoff", "sim_lock_wait", "edit_lock_wait", "prepare", "upload", "draw", "frame",
+    };
+
+    using Summaries = std::array<PhaseHistogram::Summary, s_numOfPhases>;
+
+    static constexpr std::size_t s_maxNodes = 8;    // the nodes past it are counted as the last one
+
+    // what the update kernel went through on the workers of a NUMA node, only recorded with the workers pinned (see
+    // Grid::Placement)
+    struct Traffic
+    {
+        std::uint64_t m_bytes;
+        double        m_busy;    // in milliseconds, summed over the workers
+
+        // of a single worker while it's working, the one to compare between the nodes
+        double gbPerSecond() const { return m_busy > 0.0 ? (double)m_bytes / (m_busy * 1e6) : 0.0; }
+    };
+
+    using Traffics = std::array<Traffic, s_maxNodes>;
+
+    // records the time from its construction to stop() or its destruction, whichever comes first
+    class [[nodiscard]] ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Phase phase)
+            : m_phase{ phase }
+            , m_start{ Clock::now() }
+        {
+        }
+
+        ~ScopedTimer() { stop(); }
+
+        ScopedTimer(const ScopedTimer&)            = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        void stop()
+        {
+            if (!m_stopped) {
+                record(m_phase, Clock::now() - m_start);
+                m_stopped = true;
+            }
+        }
+
+    private:
+        Phase             m_phase;
+        Clock::time_point m_start;
+        bool              m_stopped = false;
+    };
+
+    static ScopedTimer measure(Phase phase) { return ScopedTimer{ phase }; }
+
+    static void record(Phase phase, Clock::duration duration)
+    {
+        s_histograms[(std::size_t)phase].record(std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+    }
+
+    static void recordTraffic(std::size_t node, std::uint64_t bytes, Clock::duration busy)
+    {
+        auto& [nodeBytes, nodeBusy] = s_traffic[std::min(node, s_maxNodes - 1)];
+        nodeBytes.fetch_add(bytes, std::memory_order_relaxed);
+        nodeBusy.fetch_add(
+            (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(), std::memory_order_relaxed
+        );
+    }
+
+    static Traffics drainTraffic()
+    {
+        Traffics traffics{};
+        for (std::size_t i = 0; i < s_maxNodes; ++i) {
+            traffics[i] = {
+                .m_bytes = s_traffic[i].m_bytes.exchange(0, std::memory_order_relaxed),
+                .m_busy  = (double)s_traffic[i].m_busy.exchange(0, std::memory_order_relaxed) / 1e6,
+            };
+        }
+        return traffics;
+    }
+
+    static Summaries drain()
+    {
+        Summaries summaries;
+        for (std::size_t i = 0; i < s_numOfPhases; ++i) {
+            summaries[i] = s_histograms[i].drain();
+        }
+        return summaries;
+    }
+
+    // one line per phase: `time,phase,count,total_ms,min_ms,p50_ms,p99_ms,max_ms`, `time` in seconds
+    static void writeCsvHeader(std::FILE* file)
+    {
+        std::fputs("time,phase,count,total_ms,min_ms,p50_ms,p99_ms,max_ms\n", file);
+    }
+
+    static void writeCsv(std::FILE* file, double time, const Summaries& summaries)
+    {
+        for (std::size_t i = 0; i < s_numOfPhases; ++i) {
+            const auto& [count, total, min, p50, p99, max] = summaries[i];
+
+            const auto line = std::format(
+                "{:.3f},{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n", time, s_phaseNames[i], count, total, min, p50, p99, max
+            );
+            std::fputs(line.c_str(), file);
+        }
+        std::fflush(file);
+    }
+
+    // one JSON object per line per drain, keyed by phase name, then the traffic of the nodes that had any and the
+    // allocations of each track when they are counted
+    static void writeJson(
+        std::FILE*                  file,
+        double                      time,
+        const Summaries&            summaries,
+        const Traffics&             traffics    = {},
+        const AllocCounter::Counts& allocations = {}
+    )
+    {
+        auto line = std::format(R"({{"time":{:.3f})", time);
+        for (std::size_t i = 0; i < s_numOfPhases; ++i) {
+            const auto& [count, total, min, p50, p99, max] = summaries[i];
+
+            line += std::format(
+                R"(,"{}":{{"count":{},"total_ms":{:.4f},"min_ms":{:.4f},"p50_ms":{:.4f},"p99_ms":{:.4f},"max_ms":{:.4f}}})",
+                s_phaseNames[i],
+                count,
+                total,
+                min,
+                p50,
+                p99,
+                max
+            );
+        }
+
+        bool anyNode = false;
+        for (std::size_t node = 0; node < s_maxNodes; ++node) {
+            const auto& traffic = traffics[node];
+            if (traffic.m_bytes == 0) {
+                continue;
+            }
+            line += std::format(
+                R"({}{{"node":{},"bytes":{},"busy_ms":{:.4f},"gb_per_s":{:.3f}}})",
+                anyNode ? "," : R"(,"nodes":[)",
+                node,
+                traffic.m_bytes,
+                traffic.m_busy,
+                traffic.gbPerSecond()
+            );
+            anyNode = true;
+        }
+        if (anyNode) {
+            line += "]";
+        }
+
+        if constexpr (AllocCounter::s_enabled) {
+            line += std::format(
+                R"(,"allocations":{{"tick":{},"frame":{},"other":{}}})",
+                allocations[(std::size_t)AllocCounter::Track::TICK],
+                allocations[(std::size_t)AllocCounter::Track::FRAME],
+                allocations[(std::size_t)AllocCounter::Track::OTHER]
+            );
+        }
+
+        line += "}\n";
+        std::fputs(line.c_str(), file);
+        std::fflush(file);
+    }
+
+private:
+    struct NodeTraffic
+    {
+        std::atomic<std::uint64_t> m_bytes;    // zeroed by the constructor, like the next one
+        std::atomic<std::uint64_t> m_busy;     // in nanoseconds
+    };
+
+    static inline std::array<PhaseHistogram, s_numOfPhases> s_histograms;
+    static inline std::array<NodeTraffic, s_maxNodes>        s_traffic;
+};
+
+#endif /* end of include guard: PHASE_STATS_HPP_R4TN8QWE */
@@ -1,6 +1,7 @@
 #ifndef PLANE_HPP
 #define PLANE_HPP
 
+#include "phase_stats.hpp"
 #include "unrolled_matrix.hpp"
 
 #include <glbinding/gl/gl.h>
@@ -40,27 +41,28 @@ public:
 
     void draw(DrawMode mode)
     {
-        // clang-format off
-        const auto& indices = [&] { switch (mode) {
-            case DrawMode::FULL: return m_fullIndices;
-            case DrawMode::PARTIAL: return m_shownIndices;
-        } }();
-        // clang-format on
+        // no copy, the indices are uploaded straight from the member
+        const auto& indices = mode == DrawMode::FULL ? m_fullIndices : m_shownIndices;
 
-        gl::glBindBuffer(gl::GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-        gl::glBufferData(
-            gl::GL_ELEMENT_ARRAY_BUFFER,
-            static_cast<gl::GLsizeiptr>(indices.size() * sizeof(std::remove_cvref_t<decltype(indices)>::value_type)),
-            indices.data(),
-            gl::GL_DYNAMIC_DRAW
-        );
+        {
+            auto timer = PhaseStats::measure(PhaseStats::Phase::UPLOAD);
+            gl::glBindBuffer(gl::GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+
+            // the storage is orphaned before being written: the driver hands out a fresh one instead of waiting for the
+            // draw of the last frame to be done with it. its size only grows (doubling)
+            const auto size = static_cast<gl::GLsizeiptr>(indices.size() * sizeof(unsigned int));
+            m_eboCapacity   = size > m_eboCapacity ? std::max(size, m_eboCapacity * 2) : m_eboCapacity;
+            gl::glBufferData(gl::GL_ELEMENT_ARRAY_BUFFER, m_eboCapacity, nullptr, gl::GL_STREAM_DRAW);
+            gl::glBufferSubData(gl::GL_ELEMENT_ARRAY_BUFFER, 0, size, indices.data());
+        }
 
+        auto timer = PhaseStats::measure(PhaseStats::Phase::DRAW);
         gl::glBindVertexArray(m_vao);
         gl::glDrawElements(gl::GL_TRIANGLES, (gl::GLsizei)indices.size(), gl::GL_UNSIGNED_INT, 0);
         gl::glBindVertexArray(0);
     }
 
-    // exclusive: [xStart, xEnd), [yStart, yEnd), return new indices,
+    // exclusive: [xStart, xEnd), [yStart, yEnd), the shown indices are rebuilt in place (their capacity is kept)
     template <typename TT, std::invocable<const TT&> Func>
         requires std::same_as<bool, std::invoke_result_t<Func, const TT&>>
     void customizeIndices(
@@ -72,27 +74,22 @@ public:
         Func&&                    comp
     )
     {
-        std::vector<unsigned int> indices;
+        m_shownIndices.clear();
 
-        // convert 2D coordinate to 1D indices with each 2D point corresponds to 6 points in 1D indices
-        for (int x{ xStart }; x < xEnd; ++x) {
-            for (int y{ yStart }; y < yEnd; ++y) {
+        // convert 2D coordinate to 1D indices with each 2D point corresponds to 6 points in 1D indices. row by row, the
+        // reference is row-major
+        for (int y{ yStart }; y < yEnd; ++y) {
+            for (int x{ xStart }; x < xEnd; ++x) {
                 if (!comp(reference(x, y))) {
                     continue;
                 }
 
                 auto idx{ static_cast<std::size_t>((x * m_subdivision.y + y) * 6) };
 
-                indices.push_back(m_fullIndices[idx++]);
-                indices.push_back(m_fullIndices[idx++]);
-                indices.push_back(m_fullIndices[idx++]);
-                indices.push_back(m_fullIndices[idx++]);
-                indices.push_back(m_fullIndices[idx++]);
-                indices.push_back(m_fullIndices[idx++]);
+                const auto quad = m_fullIndices.begin() + (std::ptrdiff_t)idx;
+                m_shownIndices.insert(m_shownIndices.end(), quad, quad + 6);
             }
         }
-
-        m_shownIndices = indices;
     }
 
     void resetIndices()
@@ -115,6 +112,8 @@ private:
     unsigned int m_vbo;
     unsigned int m_ebo;
 
+    gl::GLsizeiptr m_eboCapacity = 0;    // in bytes
+
     std::vector<Vec_type>     m_vertices;
     std::vector<unsigned int> m_fullIndices;
     std::vector<unsigned int> m_shownIndices{};
@@ -141,13 +140,9 @@ private:
             gl::GL_STATIC_DRAW
         );
 
+        m_eboCapacity = static_cast<gl::GLsizeiptr>(m_fullIndices.size() * sizeof(decltype(m_fullIndices)::value_type));
         gl::glBindBuffer(gl::GL_ELEMENT_ARRAY_BUFFER, m_ebo);
-        gl::glBufferData(
-            gl::GL_ELEMENT_ARRAY_BUFFER,
-            static_cast<gl::GLsizeiptr>(m_fullIndices.size() * sizeof(decltype(m_fullIndices)::value_type)),
-            m_fullIndices.data(),
-            gl::GL_DYNAMIC_DRAW
-        );
+        gl::glBufferData(gl::GL_ELEMENT_ARRAY_BUFFER, m_eboCapacity, m_fullIndices.data(), gl::GL_STREAM_DRAW);
 
         // vertex attribute
         //-----------------
@@ -169,6 +164,7 @@ private:
     {
         gl::glDeleteVertexArrays(1, &m_vao);
         gl::glDeleteBuffers(1, &m_vbo);
+        gl::glDeleteBuffers(1, &m_ebo);
     }
 
     void generateVerticesAndIndices(float sideLength)
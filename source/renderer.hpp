@@ -2,8 +2,12 @@
 #define RENDERER_HPP_23RYFJ3HF3
 
 #include "camera.hpp"
+#include "cell_instances.hpp"
+#include "delta_texture.hpp"
 #include "game.hpp"
+#include "grid_texture.hpp"
 #include "grid_tile.hpp"
+#include "phase_stats.hpp"
 #include "plane.hpp"
 
 #include <glbinding/gl/gl.h>
@@ -12,7 +16,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <optional>
+#include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 class Renderer
 {
@@ -26,6 +35,21 @@ public:
         numOfGridModes,
     };
 
+    enum class RenderMode
+    {
+        INDICES,      // one quad per cell, the index buffer is rebuilt from the live cells every frame
+        TEXTURE,      // the visible region is streamed into a texture and drawn on a single quad
+        INSTANCED,    // one instanced quad per visible live cell, nothing is allocated per grid cell
+        DELTA,        // a texture of the whole grid, only the cells that changed since the last frame are uploaded
+    };
+
+    static inline const std::map<std::string, RenderMode> s_renderModeMap{
+        { "indices", RenderMode::INDICES },
+        { "texture", RenderMode::TEXTURE },
+        { "instanced", RenderMode::INSTANCED },
+        { "delta", RenderMode::DELTA },
+    };
+
     struct Border
     {
         int m_xStart = 0;
@@ -63,7 +87,7 @@ public:
     Renderer(Renderer&&)                 = delete;
     Renderer& operator=(Renderer&&)      = delete;
 
-    Renderer(const glfw_cpp::Window& window, const Grid& grid)
+    Renderer(const glfw_cpp::Window& window, const Grid& grid, RenderMode renderMode = RenderMode::INDICES)
         : m_borderTile{
             GridTile::PlaneInfo{
                 .m_subdivision    = { 1, 1 },
@@ -85,9 +109,9 @@ public:
                 },
             },
         }
-        , m_gridTile{
+        , m_stateTile{
             GridTile::PlaneInfo{
-                .m_subdivision    = { grid.width(), grid.height() },
+                .m_subdivision    = { 1, 1 },
                 .m_textureScaling = { grid.width(), grid.height() },
                 .m_position       = { (float)grid.width() / 2.0f, (float)grid.height() / 2.0f, 0.0f },
                 .m_color          = { 1.0f, 1.0f, 1.0f },
@@ -108,6 +132,7 @@ public:
         }
         , m_camera{}
         , m_gridMode{ GridMode::AUTO }
+        , m_renderMode{ renderMode }
     {
         m_camera.speed = 100.0f;
 
@@ -126,61 +151,68 @@ public:
 
     void render(const glfw_cpp::Window& window, const Grid::Grid_type& gridData, bool isPaused)
     {
-        const auto& dim           = window.properties().m_dimension;
-        m_cache.m_windowDimension = {
-            .m_width  = dim.m_width,
-            .m_height = dim.m_height,
-        };
-        m_cache.m_gridDimension = {
-            .m_width  = (int)gridData.width(),    // might throw if first element not exist
-            .m_height = (int)gridData.height(),
-        };
+        const auto [projMat, viewMat] = prepareFrame(window, (int)gridData.width(), (int)gridData.height(), isPaused);
 
-        if (isPaused) {
-            gl::glClearColor(0.0f, 0.0f, 0.02f, 1.0f);
-        } else {
-            gl::glClearColor(0.1f, 0.1f, 0.11f, 1.0f);
-        }
-        gl::glClear(gl::GL_COLOR_BUFFER_BIT | gl::GL_DEPTH_BUFFER_BIT);
-
-        gl::glViewport(0, 0, dim.m_width, dim.m_height);
+        switch (m_renderMode) {
+        case RenderMode::INDICES:
+            updateGrid(m_visibleBorder, gridData);
 
-        // orthogonal frustum
-        // clang-format off
-        const float left  { -dim.m_width  / static_cast<float>(m_camera.zoom) };
-        const float right {  dim.m_width  / static_cast<float>(m_camera.zoom) };
-        const float bottom{ -dim.m_height / static_cast<float>(m_camera.zoom) };
-        const float top   {  dim.m_height / static_cast<float>(m_camera.zoom) };
-        const float near  { -10.0f };
-        const float far   {  10.0f };
-        // clang-format on
+            // draw
+            drawBorder(projMat, viewMat, isPaused);
+            drawGrid(projMat, viewMat);
+            break;
+        case RenderMode::TEXTURE:
+            streamGrid(m_visibleBorder, gridData);
+            drawState(projMat, viewMat, *m_cellTexture, isPaused);
+            break;
+        case RenderMode::INSTANCED:
+            updateInstances(m_visibleBorder, gridData);
 
-        // projection matrix
-        auto projMat{ glm::ortho(left, right, bottom, top, near, far) };
+            drawBorder(projMat, viewMat, isPaused);
+            m_cellInstances->draw(projMat, viewMat);
+            break;
+        case RenderMode::DELTA:
+            // needs the changes carried by a Grid::Frame, drawn like TEXTURE without them
+            streamGrid(m_visibleBorder, gridData);
+            drawState(projMat, viewMat, *m_cellTexture, isPaused);
+            break;
+        }
+    }
 
-        // view matrix
-        auto viewMat{ m_camera.getViewMatrix() };
+    // a published state; only RenderMode::DELTA makes use of the changes it carries (see Grid::setChangeTracking()).
+    // zoomed out past a cell per pixel, a level of the density pyramid it carries (see Grid::setLevelOfDetail()) is
+    // drawn instead whatever the mode, about a block per pixel
+    void render(const glfw_cpp::Window& window, const Grid::Frame& frame, bool isPaused)
+    {
+        if (const auto level = levelOfDetail(frame.m_levels.size())) {
+            const auto& cells             = frame.m_cells;
+            const auto [projMat, viewMat] = prepareFrame(window, (int)cells.width(), (int)cells.height(), isPaused);
 
-        const auto& xPos{ m_camera.position.x };
-        const auto& yPos{ m_camera.position.y };
-        const auto  width  = (float)m_cache.m_gridDimension.m_width;
-        const auto  height = (float)m_cache.m_gridDimension.m_height;
+            auto& texture = streamLevel(*level, m_visibleBorder, frame.m_levels[*level]);
+            drawState(projMat, viewMat, texture, isPaused, 2 << *level);
+            return;
+        }
 
-        constexpr float offset{ 1.5f };
+        if (m_renderMode != RenderMode::DELTA) {
+            render(window, frame.m_cells, isPaused);
+            return;
+        }
 
-        // culling
-        // clang-format off
-        const int rowLeftBorder  { static_cast<int>( xPos + left       - offset > 0      ? xPos + left   - offset : 0) };
-        const int rowRightBorder { static_cast<int>( xPos + right + 1  + offset < width  ? xPos + right  + offset : width) };
-        const int colTopBorder   { static_cast<int>( yPos + top        + offset < height ? yPos + top    + offset : height) };
-        const int colBottomBorder{ static_cast<int>( yPos + bottom + 1 - offset > 0      ? yPos + bottom - offset : 0) };
-        // clang-format on
+        const auto& cells             = frame.m_cells;
+        const auto [projMat, viewMat] = prepareFrame(window, (int)cells.width(), (int)cells.height(), isPaused);
 
-        updateGrid({ rowLeftBorder, rowRightBorder, colBottomBorder, colTopBorder }, gridData);
+        if (!m_deltaTexture) {
+            m_deltaTexture.emplace((int)cells.width(), (int)cells.height(), "u_state", 1);
+        }
+        m_deltaTexture->update(frame);
+        drawState(projMat, viewMat, m_deltaTexture->texture(), isPaused);
+    }
 
-        // draw
-        drawBorder(projMat, viewMat, isPaused);
-        drawGrid(projMat, viewMat);
+    // same as above, but the state is already on the GPU (see GpuSimulation); nothing is read back
+    void render(const glfw_cpp::Window& window, const GridTexture& state, bool isPaused)
+    {
+        const auto [projMat, viewMat] = prepareFrame(window, state.width(), state.height(), isPaused);
+        drawState(projMat, viewMat, state, isPaused);
     }
 
     void processCameraMovement(Camera::CameraMovement movement, float deltaTime)
@@ -233,6 +265,20 @@ public:
         setCameraSpeed(speed);
     }
 
+    // the part of the grid drawn on the last render() call
+    const Border& getVisibleBorder() const
+    {
+        return m_visibleBorder;
+    }
+
+    // the levels of the density pyramid the current zoom draws from (see Grid::setLevelOfDetail()), 0 while a cell is
+    // at least half a pixel
+    std::size_t levelsOfDetail() const
+    {
+        const auto cellsPerPixel = 2.0f / m_camera.zoom;    // see the frustum in prepareFrame()
+        return cellsPerPixel < 2.0f ? 0 : (std::size_t)std::log2(cellsPerPixel);
+    }
+
     glm::vec3 getCameraPosition()
     {
         return m_camera.position;
@@ -305,46 +351,226 @@ public:
         );
     }
 
+    // draw the cells that aren't LIVE anymore as dimmer ones (the fade, see Rule), only where the whole state goes
+    // through a texture: RenderMode::TEXTURE and the GPU simulation. DELTA only knows about the LIVE cells
+    void setTrail(bool enable) { m_trail = enable; }
+    bool isDrawingTrail() const { return m_trail; }
+
 private:
-    GridTile m_borderTile;
-    GridTile m_gridTile;
-    Camera   m_camera;
-    GridMode m_gridMode;
-    Cache    m_cache;
+    GridTile                     m_borderTile;
+    std::optional<GridTile>      m_gridTile;         // one quad per cell, only built for RenderMode::INDICES
+    GridTile                     m_stateTile;        // a single quad, the cells come from a GridTexture
+    std::optional<GridTexture>   m_cellTexture;      // RenderMode::TEXTURE, the visible region of the cpu state
+    std::optional<CellInstances> m_cellInstances;    // RenderMode::INSTANCED
+    std::optional<DeltaTexture>  m_deltaTexture;     // RenderMode::DELTA, the whole cpu state
+    std::vector<GridTexture>     m_levelTextures;    // the levels of the density pyramid drawn so far, by level
+    Camera                       m_camera;
+    GridMode                     m_gridMode;
+    RenderMode                   m_renderMode;
+    bool                         m_trail = false;
+    Cache                        m_cache;
+    Border                       m_visibleBorder;
+
+    // clear the screen, compute the matrices and the visible part of the grid
+    std::pair<glm::mat4, glm::mat4> prepareFrame(
+        const glfw_cpp::Window& window,
+        int                     gridWidth,
+        int                     gridHeight,
+        bool                    isPaused
+    )
+    {
+        const auto& dim           = window.properties().m_dimension;
+        m_cache.m_windowDimension = {
+            .m_width  = dim.m_width,
+            .m_height = dim.m_height,
+        };
+        m_cache.m_gridDimension = {
+            .m_width  = gridWidth,
+            .m_height = gridHeight,
+        };
+
+        if (isPaused) {
+            gl::glClearColor(0.0f, 0.0f, 0.02f, 1.0f);
+        } else {
+            gl::glClearColor(0.1f, 0.1f, 0.11f, 1.0f);
+        }
+        gl::glClear(gl::GL_COLOR_BUFFER_BIT | gl::GL_DEPTH_BUFFER_BIT);
+
+        gl::glViewport(0, 0, dim.m_width, dim.m_height);
+
+        // orthogonal frustum
+        // clang-format off
+        const float left  { -dim.m_width  / static_cast<float>(m_camera.zoom) };
+        const float right {  dim.m_width  / static_cast<float>(m_camera.zoom) };
+        const float bottom{ -dim.m_height / static_cast<float>(m_camera.zoom) };
+        const float top   {  dim.m_height / static_cast<float>(m_camera.zoom) };
+        const float near  { -10.0f };
+        const float far   {  10.0f };
+        // clang-format on
+
+        // projection matrix
+        auto projMat{ glm::ortho(left, right, bottom, top, near, far) };
+
+        // view matrix
+        auto viewMat{ m_camera.getViewMatrix() };
+
+        const auto& xPos{ m_camera.position.x };
+        const auto& yPos{ m_camera.position.y };
+        const auto  width  = (float)m_cache.m_gridDimension.m_width;
+        const auto  height = (float)m_cache.m_gridDimension.m_height;
+
+        constexpr float offset{ 1.5f };
+
+        // culling
+        // clang-format off
+        const int rowLeftBorder  { static_cast<int>( xPos + left       - offset > 0      ? xPos + left   - offset : 0) };
+        const int rowRightBorder { static_cast<int>( xPos + right + 1  + offset < width  ? xPos + right  + offset : width) };
+        const int colTopBorder   { static_cast<int>( yPos + top        + offset < height ? yPos + top    + offset : height) };
+        const int colBottomBorder{ static_cast<int>( yPos + bottom + 1 - offset > 0      ? yPos + bottom - offset : 0) };
+        // clang-format on
+
+        m_visibleBorder = { rowLeftBorder, rowRightBorder, colBottomBorder, colTopBorder };
+
+        return { projMat, viewMat };
+    }
 
     void updateGrid(const Border& border, const Grid::Grid_type& gridData)
     {
+        if (!m_gridTile) {
+            const auto width  = (int)gridData.width();
+            const auto height = (int)gridData.height();
+
+            m_gridTile.emplace(
+                GridTile::PlaneInfo{
+                    .m_subdivision    = { width, height },
+                    .m_textureScaling = { width, height },
+                    .m_position       = { (float)width / 2.0f, (float)height / 2.0f, 0.0f },
+                    .m_color          = { 1.0f, 1.0f, 1.0f },
+                    .m_scale          = { width, height, 0.0f },
+                },
+                GridTile::ShaderInfo{
+                    .m_vertexShaderDir   = "./resources/shaders/grid_shader.vert",
+                    .m_fragmentShaderDir = "./resources/shaders/grid_shader.frag",
+                },
+                GridTile::TextureInfo{
+                    .m_textureDir  = "./resources/textures/cell.png",
+                    .m_textureSpec = {
+                        .m_minFilter  = gl::GL_LINEAR,
+                        .m_magFilter  = gl::GL_LINEAR,
+                        .m_wrapFilter = gl::GL_REPEAT,
+                    },
+                }
+            );
+        }
+
+        auto timer = PhaseStats::measure(PhaseStats::Phase::PREPARE);
+
         const auto& [x1, x2, y1, y2] = border;
-        m_gridTile.m_plane.customizeIndices(x1, x2, y1, y2, gridData, [](const Grid::Cell& cell) {
+        m_gridTile->m_plane.customizeIndices(x1, x2, y1, y2, gridData, [](const Grid::Cell& cell) {
             return cell == Grid::LIVE_STATE;
         });
     }
 
-    void drawBorder(const glm::mat4& projMat, const glm::mat4& viewMat, bool isPaused)
+    void updateInstances(const Border& border, const Grid::Grid_type& gridData)
     {
-        bool shouldDraw{};
+        if (!m_cellInstances) {
+            m_cellInstances.emplace(
+                "./resources/textures/cell.png",
+                ImageTexture::Specification{
+                    .m_minFilter  = gl::GL_LINEAR,
+                    .m_magFilter  = gl::GL_LINEAR,
+                    .m_wrapFilter = gl::GL_REPEAT,
+                }
+            );
+        }
 
+        const auto& [x1, x2, y1, y2] = border;
+        m_cellInstances->update(x1, x2, y1, y2, gridData);
+    }
+
+    // only the visible part is copied, cells outside of it are stale on the texture but are not drawn either
+    void streamGrid(const Border& border, const Grid::Grid_type& gridData)
+    {
+        if (!m_cellTexture) {
+            m_cellTexture.emplace((int)gridData.width(), (int)gridData.height(), "u_state", 1);
+        }
+
+        const auto& [x1, x2, y1, y2] = border;
+        if (x1 >= x2 || y1 >= y2) {
+            return;
+        }
+
+        auto timer = PhaseStats::measure(PhaseStats::Phase::UPLOAD);    // the copy into the pixel buffer is the upload
+
+        m_cellTexture->stream(x1, y1, x2 - x1, y2 - y1, gridData.row(y1) + x1, (int)gridData.stride());
+    }
+
+    // the level of the density pyramid (out of `levels`) with about a block per pixel, none if a cell is larger than that
+    std::optional<std::size_t> levelOfDetail(std::size_t levels) const
+    {
+        const auto wanted = levelsOfDetail();
+        if (levels == 0 || wanted == 0) {
+            return std::nullopt;
+        }
+        return std::min(wanted, levels) - 1;
+    }
+
+    // like streamGrid(), the blocks covering the visible part of the grid
+    GridTexture& streamLevel(std::size_t level, const Border& border, const Grid::Grid_type& blocks)
+    {
+        while (m_levelTextures.size() <= level) {
+            const auto size = m_levelTextures.size();
+            const auto& dim = m_cache.m_gridDimension;
+            m_levelTextures.emplace_back(
+                ((dim.m_width - 1) >> (size + 1)) + 1, ((dim.m_height - 1) >> (size + 1)) + 1, "u_state", 1
+            );
+        }
+
+        auto& texture = m_levelTextures[level];
+        if (texture.width() != blocks.width() || texture.height() != blocks.height()) {
+            return texture;    // a frame of another grid, can't happen
+        }
+
+        const auto shift = (int)level + 1;
+        const auto x1    = border.m_xStart >> shift;
+        const auto y1    = border.m_yStart >> shift;
+        const auto x2    = std::min(((border.m_xEnd - 1) >> shift) + 1, texture.width());
+        const auto y2    = std::min(((border.m_yEnd - 1) >> shift) + 1, texture.height());
+        if (x1 >= x2 || y1 >= y2) {
+            return texture;
+        }
+
+        auto timer = PhaseStats::measure(PhaseStats::Phase::UPLOAD);
+
+        texture.stream(x1, y1, x2 - x1, y2 - y1, blocks.row(y1) + x1, (int)blocks.stride());
+        return texture;
+    }
+
+    bool shouldDrawBorder() const
+    {
         switch (m_gridMode) {
         case GridMode::ON:
-        {
-            shouldDraw = true;
-            break;
-        }
+            return true;
         case GridMode::AUTO:
         {
             const auto    winWidth{ m_cache.m_windowDimension.m_width };
             const float   xDelta{ winWidth / m_camera.zoom };        // (number of cells per width of screen)/2
             constexpr int minNumberOfCellsPerScreenHeight{ 100 };    // change accordingly
-            if (xDelta <= minNumberOfCellsPerScreenHeight / 2.0f) {
-                shouldDraw = true;
-            }
-            break;
+            return xDelta <= minNumberOfCellsPerScreenHeight / 2.0f;
         }
         default:
-            shouldDraw = false;
+            return false;
         }
+    }
 
-        if (!shouldDraw) {
+    static glm::vec3 borderColor(bool isPaused)
+    {
+        return isPaused ? glm::vec3{ 0.7f, 1.0f, 0.7f } : glm::vec3{ 1.0f, 1.0f, 1.0f };
+    }
+
+    void drawBorder(const glm::mat4& projMat, const glm::mat4& viewMat, bool isPaused)
+    {
+        if (!shouldDrawBorder()) {
             return;
         }
 
@@ -362,11 +588,7 @@ private:
         m_borderTile.m_shader.setUniform("u_model", model);
 
         // change color if simulation::pause
-        if (isPaused) {
-            m_borderTile.m_color = { 0.7f, 1.0f, 0.7f };
-        } else {
-            m_borderTile.m_color = { 1.0f, 1.0f, 1.0f };
-        }
+        m_borderTile.m_color = borderColor(isPaused);
 
         // draw
         m_borderTile.draw(Plane::DrawMode::FULL);
@@ -374,17 +596,46 @@ private:
 
     void drawGrid(const glm::mat4& projMat, const glm::mat4& viewMat)
     {
-        m_gridTile.m_shader.use();
-        m_gridTile.m_shader.setUniform("u_view", viewMat);
-        m_gridTile.m_shader.setUniform("u_projection", projMat);
+        m_gridTile->m_shader.use();
+        m_gridTile->m_shader.setUniform("u_view", viewMat);
+        m_gridTile->m_shader.setUniform("u_projection", projMat);
+
+        glm::mat4 model{ 1.0f };
+        model = glm::translate(model, m_gridTile->m_position);
+        model = glm::scale(model, m_gridTile->m_scale);
+
+        m_gridTile->m_shader.setUniform("u_model", model);
+
+        m_gridTile->draw(Plane::DrawMode::PARTIAL);
+    }
+
+    // the grid lines are drawn by the same pass (see grid_shader.frag), instead of drawBorder()
+    // `blockSize` cells per texel of `state`, a level of the density pyramid past 1
+    void drawState(
+        const glm::mat4&   projMat,
+        const glm::mat4&   viewMat,
+        const GridTexture& state,
+        bool               isPaused,
+        int                blockSize = 1
+    )
+    {
+        m_stateTile.m_shader.use();
+        m_stateTile.m_shader.setUniform("u_view", viewMat);
+        m_stateTile.m_shader.setUniform("u_projection", projMat);
+        m_stateTile.m_shader.setUniform("u_stateMode", true);
+        m_stateTile.m_shader.setUniform("u_gridLines", shouldDrawBorder());
+        m_stateTile.m_shader.setUniform("u_gridColor", borderColor(isPaused));
+        m_stateTile.m_shader.setUniform("u_trail", m_trail);
+        m_stateTile.m_shader.setUniform("u_blockSize", (float)blockSize);
 
         glm::mat4 model{ 1.0f };
-        model = glm::translate(model, m_gridTile.m_position);
-        model = glm::scale(model, m_gridTile.m_scale);
+        model = glm::translate(model, m_stateTile.m_position);
+        model = glm::scale(model, m_stateTile.m_scale);
 
-        m_gridTile.m_shader.setUniform("u_model", model);
+        m_stateTile.m_shader.setUniform("u_model", model);
 
-        m_gridTile.draw(Plane::DrawMode::PARTIAL);
+        state.activate(m_stateTile.m_shader);
+        m_stateTile.draw(Plane::DrawMode::FULL);
     }
 };
 
@@ -0,0 +1,206 @@
+#ifndef RULE_HPP_T6JD2XQM
+#define RULE_HPP_T6JD2XQM
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// Outer totalistic rule on the byte states of a cell, in B/S notation: `B3/S23` is Conway's Life, `B36/S23` HighLife.
+// An optional number of states makes it a Generations rule: `B2/S/C3` is Brian's Brain. Only LIVE cells count as
+// neighbors, and the next state of every (state, neighbor count) pair is precomputed into a table, so any rule costs a
+// single lookup per cell.
+//
+// The states between dead and LIVE are the fade. With a Life-like rule (C2, the default) a cell that dies drops by 1
+// every generation from LIVE - 1 down to 0, it's only for the looks and the cell can be born again anytime. With
+// Generations, a cell that doesn't survive goes through the C - 2 dying states spread evenly below LIVE, and can only
+// be born again once it's back to 0.
+class Rule
+{
+public:
+    using Cell = std::uint8_t;
+
+    static constexpr Cell s_live      = 0xff;
+    static constexpr Cell s_dead      = 0x00;
+    static constexpr int  s_maxStates = 256;
+
+    // a string usable as a template argument, see make()
+    template <std::size_t N>
+    struct Literal
+    {
+        char m_chars[N];
+
+        consteval Literal(const char (&chars)[N]) { std::copy_n(chars, N, m_chars); }
+
+        constexpr std::string_view view() const { return { m_chars, N - 1 }; }
+    };
+
+    // parsed and tabulated at compile time, a malformed rule doesn't compile: `Rule::make<"B3/S23">()`
+    template <Literal Spec>
+    static consteval Rule make()
+    {
+        return Rule{ Spec.view() };
+    }
+
+    // `B<digits>/S<digits>[/C<states>]`, the parts in any order and case insensitive; throws if malformed
+    constexpr explicit Rule(std::string_view spec)
+    {
+        const auto whole       = spec;
+        bool       hasBirth    = false;
+        bool       hasSurvival = false;
+        bool       hasStates   = false;
+
+        while (!spec.empty()) {
+            // NOTE: not string_view::find(), gcc 12 can't evaluate it on a template argument
+            std::size_t slash = 0;
+            while (slash < spec.size() && spec[slash] != '/') {
+                ++slash;
+            }
+            const auto part = spec.substr(0, slash);
+            spec            = slash == spec.size() ? std::string_view{} : spec.substr(slash + 1);
+
+            if (part.empty()) {
+                fail(whole, "empty part");
+            }
+
+            switch (part[0]) {
+            case 'B':
+            case 'b': m_birth = parseCounts(part.substr(1), hasBirth); break;
+            case 'S':
+            case 's': m_survival = parseCounts(part.substr(1), hasSurvival); break;
+            case 'C':
+            case 'c': m_states = parseStates(part.substr(1), hasStates); break;
+            default: fail(part, "expected a B, S or C part");
+            }
+        }
+
+        if (!hasBirth || !hasSurvival) {
+            fail(whole, "both the B and the S parts are needed");
+        }
+
+        m_decay = m_states == 2 ? 1 : (Cell)((s_live + m_states - 2) / (m_states - 1));
+
+        for (int neighbors = 0; neighbors <= 8; ++neighbors) {
+            const bool born    = (m_birth >> neighbors) & 1;
+            const bool survive = (m_survival >> neighbors) & 1;
+
+            for (int state = 0; state <= s_live; ++state) {
+                const auto cell    = (Cell)state;
+                const auto decayed = cell > m_decay ? (Cell)(cell - m_decay) : s_dead;
+
+                auto& next = m_table[(std::size_t)neighbors * 256 + cell];
+                if (cell == s_live) {
+                    next = survive ? s_live : decayed;
+                } else {
+                    next = born && (cell == s_dead || isLifeLike()) ? s_live : decayed;
+                }
+            }
+        }
+
+        writeName();
+    }
+
+    constexpr Cell next(Cell cell, int neighbors) const { return m_table[(std::size_t)neighbors * 256 + cell]; }
+
+    // bit n set: born (or survives) on n neighbors
+    constexpr std::uint16_t birthMask() const { return m_birth; }
+    constexpr std::uint16_t survivalMask() const { return m_survival; }
+
+    constexpr int  states() const { return m_states; }
+    constexpr Cell decay() const { return m_decay; }    // lost per generation by a cell that isn't LIVE
+    constexpr bool isLifeLike() const { return m_states == 2; }
+
+    // canonical form: the counts in order, the C part only for Generations
+    constexpr std::string_view name() const { return { m_name.data(), m_nameLength }; }
+
+    constexpr bool operator==(const Rule& other) const
+    {
+        return m_birth == other.m_birth && m_survival == other.m_survival && m_states == other.m_states;
+    }
+
+private:
+    std::array<Cell, 9 * 256> m_table{};
+    std::uint16_t             m_birth    = 0;
+    std::uint16_t             m_survival = 0;
+    int                       m_states   = 2;
+    Cell                      m_decay    = 1;
+    std::array<char, 32>      m_name{};    // "B012345678/S012345678/C256" at worst
+    std::size_t               m_nameLength = 0;
+
+    // reaching this during constant evaluation is what makes a malformed Rule::make() fail to compile
+    static void fail(std::string_view part, std::string_view reason)
+    {
+        throw std::runtime_error{ std::format("invalid rule at '{}': {}", part, reason) };
+    }
+
+    static constexpr std::uint16_t parseCounts(std::string_view digits, bool& seen)
+    {
+        if (std::exchange(seen, true)) {
+            fail(digits, "repeated part");
+        }
+
+        std::uint16_t mask = 0;
+        for (auto c : digits) {
+            if (c < '0' || c > '8') {
+                fail(digits, "neighbor counts go from 0 to 8");
+            }
+            const auto bit = std::uint16_t(1u << (c - '0'));
+            if (mask & bit) {
+                fail(digits, "repeated neighbor count");
+            }
+            mask |= bit;
+        }
+        return mask;
+    }
+
+    static constexpr int parseStates(std::string_view digits, bool& seen)
+    {
+        if (std::exchange(seen, true)) {
+            fail(digits, "repeated part");
+        }
+
+        int states = 0;
+        for (auto c : digits) {
+            if (c < '0' || c > '9' || (states = states * 10 + (c - '0')) > s_maxStates) {
+                fail(digits, "the number of states goes from 2 to 256");
+            }
+        }
+        if (digits.empty() || states < 2) {
+            fail(digits, "the number of states goes from 2 to 256");
+        }
+        return states;
+    }
+
+    constexpr void writeName()
+    {
+        auto put    = [&](char c) { m_name[m_nameLength++] = c; };
+        auto counts = [&](char prefix, std::uint16_t mask) {
+            put(prefix);
+            for (int n = 0; n <= 8; ++n) {
+                if ((mask >> n) & 1) {
+                    put((char)('0' + n));
+                }
+            }
+        };
+
+        counts('B', m_birth);
+        put('/');
+        counts('S', m_survival);
+
+        if (!isLifeLike()) {
+            put('/');
+            put('C');
+            for (int divisor = 100; divisor > 0; divisor /= 10) {
+                if (m_states >= divisor) {
+                    put((char)('0' + m_states / divisor % 10));
+                }
+            }
+        }
+    }
+};
+
+#endif /* end of include guard: RULE_HPP_T6JD2XQM */
@@ -38,6 +38,7 @@ public:
 
     Shader(Shader&& other) noexcept
         : m_id{ std::exchange(other.m_id, 0) }
+        , m_uniformLocCache{ std::move(other.m_uniformLocCache) }
     {
     }
 
@@ -45,7 +46,8 @@ public:
     {
         if (this != &other) {
             gl::glDeleteProgram(m_id);
-            m_id = std::exchange(other.m_id, 0);
+            m_id              = std::exchange(other.m_id, 0);
+            m_uniformLocCache = std::move(other.m_uniformLocCache);
         }
         return *this;
     }
@@ -183,18 +185,19 @@ private:
         GEOMETRY,
     };
 
-    static inline std::map<std::string, gl::GLint, std::less<>> s_uniformLocCache;    // uniform location cache (not thread-safe)
+    // uniform location cache, per program since the same name can have different locations on different programs
+    std::map<std::string, gl::GLint, std::less<>> m_uniformLocCache;
 
     gl::GLint getLoc(std::string_view name)
     {
-        if (auto found{ s_uniformLocCache.find(name) }; found != s_uniformLocCache.end()) {
+        if (auto found{ m_uniformLocCache.find(name) }; found != m_uniformLocCache.end()) {
             return found->second;
         } else {
             gl::GLint loc{ gl::glGetUniformLocation(m_id, name.data()) };
             if (loc == -1) {
                 spdlog::warn("(Shader) [{}] Uniform of name '{}' can't be found", m_id, name);
             }
-            s_uniformLocCache.emplace(name, loc);
+            m_uniformLocCache.emplace(name, loc);
             return loc;
         }
     }
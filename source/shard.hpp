@@ -0,0 +1,662 @@
+#ifndef SHARD_HPP_R5JM2XQT
+#define SHARD_HPP_R5JM2XQT
+
+#include "bit_matrix.hpp"
+#include "game.hpp"
+#include "rule.hpp"
+#include "threadpool.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A TCP connection to another shard, move-only. Blocking unless setNonBlocking() was called, it then goes through
+// sendSome() and recvSome() only. Every failure throws, a shard can't go on without its neighbors anyway.
+class ShardLink
+{
+public:
+    // `address` is host:port
+    static std::pair<std::string, std::string> splitAddress(const std::string& address)
+    {
+        const auto colon = address.rfind(':');
+        if (colon == std::string::npos || colon == 0 || colon + 1 == address.size()) {
+            throw std::invalid_argument{ std::format("'{}' is not of the form host:port", address) };
+        }
+        return { address.substr(0, colon), address.substr(colon + 1) };
+    }
+
+    // listen on `port` of every interface
+    static ShardLink listen(const std::string& port)
+    {
+        auto link = ShardLink{ open(nullptr, port, AI_PASSIVE, [](int fd, const addrinfo& info) {
+            const int yes = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+            return ::bind(fd, info.ai_addr, info.ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0;
+        }) };
+        return link;
+    }
+
+    // the other shards are started in any order, so the connection is retried until `timeout` runs out
+    static ShardLink connect(const std::string& host, const std::string& port, std::chrono::seconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            try {
+                auto link = ShardLink{ open(host.c_str(), port, 0, [](int fd, const addrinfo& info) {
+                    return ::connect(fd, info.ai_addr, info.ai_addrlen) == 0;
+                }) };
+                link.setNoDelay();
+                return link;
+            } catch (std::runtime_error&) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    throw;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+            }
+        }
+    }
+
+    ShardLink accept() const
+    {
+        const auto fd = ::accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error{ std::format("can't accept a shard: {}", std::strerror(errno)) };
+        }
+        auto link = ShardLink{ fd };
+        link.setNoDelay();
+        return link;
+    }
+
+    ShardLink(ShardLink&& other) noexcept
+        : m_fd{ std::exchange(other.m_fd, -1) }
+    {
+    }
+
+    ShardLink& operator=(ShardLink&& other) noexcept
+    {
+        if (this != &other) {
+            close();
+            m_fd = std::exchange(other.m_fd, -1);
+        }
+        return *this;
+    }
+
+    ShardLink(const ShardLink&)            = delete;
+    ShardLink& operator=(const ShardLink&) = delete;
+
+    ~ShardLink() { close(); }
+
+    void send(std::span<const std::byte> bytes) const
+    {
+        while (!bytes.empty()) {
+            const auto sent = ::send(m_fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                throw std::runtime_error{ std::format("can't send to a shard: {}", std::strerror(errno)) };
+            }
+            bytes = bytes.subspan((std::size_t)sent);
+        }
+    }
+
+    void recv(std::span<std::byte> bytes) const
+    {
+        while (!bytes.empty()) {
+            const auto received = ::recv(m_fd, bytes.data(), bytes.size(), 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received == 0) {
+                throw std::runtime_error{ "a shard closed its connection" };
+            }
+            if (received < 0) {
+                throw std::runtime_error{ std::format("can't receive from a shard: {}", std::strerror(errno)) };
+            }
+            bytes = bytes.subspan((std::size_t)received);
+        }
+    }
+
+    // send what the socket takes right away, `bytes` is left with the rest
+    void sendSome(std::span<const std::byte>& bytes) const
+    {
+        while (!bytes.empty()) {
+            const auto sent = ::send(m_fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (sent <= 0) {
+                throw std::runtime_error{ std::format("can't send to a shard: {}", std::strerror(errno)) };
+            }
+            bytes = bytes.subspan((std::size_t)sent);
+        }
+    }
+
+    // receive what is already there, `bytes` is left with what is still to come
+    void recvSome(std::span<std::byte>& bytes) const
+    {
+        while (!bytes.empty()) {
+            const auto received = ::recv(m_fd, bytes.data(), bytes.size(), 0);
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (received == 0) {
+                throw std::runtime_error{ "a shard closed its connection" };
+            }
+            if (received < 0) {
+                throw std::runtime_error{ std::format("can't receive from a shard: {}", std::strerror(errno)) };
+            }
+            bytes = bytes.subspan((std::size_t)received);
+        }
+    }
+
+    void setNonBlocking()
+    {
+        if (::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK) < 0) {
+            throw std::runtime_error{ std::format("can't make a shard link non-blocking: {}", std::strerror(errno)) };
+        }
+    }
+
+    int fd() const { return m_fd; }
+
+    template <typename T>
+    void send(std::span<const T> values) const
+    {
+        send(std::as_bytes(values));
+    }
+
+    template <typename T>
+    void recv(std::span<T> values) const
+    {
+        recv(std::as_writable_bytes(values));
+    }
+
+private:
+    int m_fd = -1;
+
+    explicit ShardLink(int fd)
+        : m_fd{ fd }
+    {
+    }
+
+    // the first address of `host`:`port` that `setup(fd, info)` succeeds on
+    static int open(const char* host, const std::string& port, int flags, auto&& setup)
+    {
+        addrinfo hints    = {};
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = flags;
+
+        addrinfo* infos = nullptr;
+        if (const auto error = ::getaddrinfo(host, port.c_str(), &hints, &infos); error != 0) {
+            throw std::runtime_error{ std::format("can't resolve '{}:{}': {}", host ? host : "", port, ::gai_strerror(error)) };
+        }
+
+        int fd     = -1;
+        int reason = 0;
+        for (auto* info = infos; info != nullptr && fd < 0; info = info->ai_next) {
+            fd = ::socket(info->ai_family, info->ai_socktype | SOCK_CLOEXEC, info->ai_protocol);
+            if (fd >= 0 && !setup(fd, *info)) {
+                reason = errno;
+                ::close(fd);
+                fd = -1;
+            }
+        }
+        ::freeaddrinfo(infos);
+
+        if (fd < 0) {
+            throw std::runtime_error{ std::format("can't reach '{}:{}': {}", host ? host : "", port, std::strerror(reason)) };
+        }
+        return fd;
+    }
+
+    // the halo rows are small and waited for right away
+    void setNoDelay()
+    {
+        const int yes = 1;
+        ::setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+
+    void close()
+    {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+};
+
+// One partition of a torus too large for a single machine, run as one process of a group. The torus is cut into bands
+// of whole rows, one per shard in rank order: the left and right edges wrap within a band so each shard only has two
+// neighbors, the shards above and below it, and the halo is one row each way per generation.
+//
+// The cells are bit-packed (BitMatrix, Life-like rules only) with a halo row above and below the band. step() hands the
+// exchange of the two edge rows and the two halo rows to a thread kept for the whole run, which polls both links at
+// once, while the rows that don't need the halos are updated; only the two edge rows wait for them. The shards run in
+// lockstep, each one waits for the rows of the generation it's on.
+//
+// Every shard is given the address of every other one; a shard listens on its own address, connects to the one below
+// it (which accepts it as the one above) and, but for rank 0, to rank 0 which sums the population and gathers the view
+// (see gatherPopulation() and gatherView()).
+class Shard
+{
+public:
+    struct Param
+    {
+        int                      m_width;
+        int                      m_height;
+        std::size_t              m_rank;
+        std::vector<std::string> m_addresses;    // host:port of every shard, in rank order
+        std::size_t              m_threads;
+        Rule                     m_rule;
+        std::chrono::seconds     m_connectTimeout = std::chrono::seconds{ 60 };
+    };
+
+    Shard(const Param& param)
+        : m_width{ param.m_width }
+        , m_height{ param.m_height }
+        , m_rank{ param.m_rank }
+        , m_count{ param.m_addresses.size() }
+        , m_rowStart{ bandStart(param.m_rank) }
+        , m_rows{ bandStart(param.m_rank + 1) - m_rowStart }
+        , m_rule{ param.m_rule }
+        , m_front{ m_width, m_rows + 2 }
+        , m_back{ m_width, m_rows + 2 }
+        , m_threadPool{ param.m_threads, ThreadPool::Mode::WORK_STEALING }
+    {
+        if (m_count == 0 || m_rank >= m_count) {
+            throw std::invalid_argument{ std::format("rank {} is not one of the {} shards", m_rank, m_count) };
+        }
+        if ((std::size_t)m_height < m_count) {
+            throw std::invalid_argument{ std::format("{} rows can't be split into {} shards", m_height, m_count) };
+        }
+        if (!m_rule.isLifeLike()) {
+            throw std::invalid_argument{ std::format("the shards only run Life-like rules, not '{}'", m_rule.name()) };
+        }
+
+        spdlog::info(
+            "(Shard) Rank [{}] of [{}], rows [{}, {}) of a {}x{} grid",
+            m_rank,
+            m_count,
+            m_rowStart,
+            m_rowStart + m_rows,
+            m_width,
+            m_height
+        );
+
+        if (m_count > 1) {
+            connect(param.m_addresses, param.m_connectTimeout);
+            m_exchanger = std::jthread{ [this](std::stop_token stop) { runExchanger(stop); } };
+        }
+    }
+
+    Shard(const Shard&)            = delete;
+    Shard& operator=(const Shard&) = delete;
+
+    // random population of the whole grid, cell (x, y) is live with probability `density`. it only depends on `seed`
+    // and the position of the cell, not on the number of shards
+    void populate(float density, std::uint64_t seed)
+    {
+        const auto threshold = (double)std::clamp(density, 0.0f, 1.0f);
+        m_threadPool.parallelFor(0, m_rows, 1, [&](long y) {
+            const auto index = (std::uint64_t)(m_rowStart + y) * (std::uint64_t)m_width;
+            for (long x = 0; x < m_width; ++x) {
+                const auto random = (double)(Grid::splitMix64(seed + index + (std::uint64_t)x) >> 11) * 0x1.0p-53;
+                m_front.set(x, y + 1, random < threshold);
+            }
+        });
+        m_generation = 0;
+    }
+
+    void step()
+    {
+        const auto words    = (std::size_t)m_front.wordsPerRow();
+        auto       row      = [&](long y) { return std::span{ m_front.row(y), words }; };
+        auto       nextRows = [&](long first, long last) {
+            m_threadPool.parallelFor(first, last, 1, [&](long y) {
+                m_front.nextRow(
+                    m_front.row(y - 1),
+                    m_front.row(y),
+                    m_front.row(y + 1),
+                    m_back.row(y),
+                    m_rule.birthMask(),
+                    m_rule.survivalMask()
+                );
+            });
+        };
+
+        if (m_count == 1) {
+            std::ranges::copy(row(m_rows), row(0).begin());
+            std::ranges::copy(row(1), row(m_rows + 1).begin());
+            nextRows(1, m_rows + 1);
+        } else {
+            {
+                std::scoped_lock lock{ m_exchangeMutex };
+                ++m_exchangeRequested;
+            }
+            m_exchangeCv.notify_all();
+
+            nextRows(2, m_rows);    // the interior, the edge rows are only read from
+
+            std::unique_lock lock{ m_exchangeMutex };
+            m_exchangeCv.wait(lock, [&] { return m_exchangeDone == m_exchangeRequested; });
+            if (m_exchangeError) {
+                std::rethrow_exception(std::exchange(m_exchangeError, nullptr));
+            }
+            lock.unlock();
+
+            nextRows(1, 2);
+            if (m_rows > 1) {
+                nextRows(m_rows, m_rows + 1);
+            }
+        }
+
+        m_front.swap(m_back);
+        ++m_generation;
+    }
+
+    // collective, every shard must call it. returns the population of the whole grid on rank 0, of the band on the
+    // others
+    std::uint64_t gatherPopulation()
+    {
+        std::uint64_t population = 0;
+        for (long y = 1; y <= m_rows; ++y) {
+            const auto* words = m_front.row(y);
+            for (long i = 0; i < m_front.wordsPerRow(); ++i) {
+                population += (std::uint64_t)std::popcount(words[i]);
+            }
+        }
+
+        if (m_rank != 0) {
+            m_gather.front().send(std::span<const std::uint64_t>{ &population, 1 });
+            return population;
+        }
+
+        for (const auto& link : m_gather) {
+            std::uint64_t band = 0;
+            link.recv(std::span<std::uint64_t>{ &band, 1 });
+            population += band;
+        }
+        return population;
+    }
+
+    // collective, every shard must call it with the same `factor`. rank 0 gets the grid scaled down by `factor`
+    // (rounded up) into `view`, each cell being the density of the block it stands for like a level of detail of the
+    // grid (see Grid::Frame::m_levels): LIVE when full, never 0 with any live cell. the others leave `view` untouched.
+    // returns the population of the whole grid on rank 0, of the band on the others
+    std::uint64_t gatherView(int factor, Grid::Grid_type& view)
+    {
+        if (factor < 1) {
+            throw std::invalid_argument{ std::format("the view is scaled down by at least 1, not {}", factor) };
+        }
+
+        const auto viewWidth  = (m_width + factor - 1) / factor;
+        const auto viewHeight = (m_height + factor - 1) / factor;
+        const auto firstRow   = m_rowStart / factor;
+        const auto lastRow    = (m_rowStart + m_rows - 1) / factor;
+
+        // the population of each block (partial for the blocks the band only covers some rows of)
+        std::vector<std::uint32_t> counts((std::size_t)((lastRow - firstRow + 1) * viewWidth), 0);
+        for (long y = 0; y < m_rows; ++y) {
+            auto*       blocks = counts.data() + ((m_rowStart + y) / factor - firstRow) * viewWidth;
+            const auto* words  = m_front.row(y + 1);
+            for (long i = 0; i < m_front.wordsPerRow(); ++i) {
+                for (auto word = words[i]; word != 0; word &= word - 1) {
+                    ++blocks[(i * BitMatrix::s_wordBits + std::countr_zero(word)) / factor];
+                }
+            }
+        }
+
+        if (m_rank != 0) {
+            const auto header = std::array<std::uint32_t, 2>{ (std::uint32_t)firstRow, (std::uint32_t)counts.size() };
+            m_gather.front().send(std::span<const std::uint32_t>{ header });
+            m_gather.front().send(std::span<const std::uint32_t>{ counts });
+            return sum(counts);
+        }
+
+        std::vector<std::uint32_t> total((std::size_t)(viewWidth * viewHeight), 0);
+        auto add = [&](long first, std::span<const std::uint32_t> partial) {
+            for (std::size_t i = 0; i < partial.size(); ++i) {
+                total[(std::size_t)(first * viewWidth) + i] += partial[i];
+            }
+        };
+
+        add(firstRow, counts);
+        for (const auto& link : m_gather) {
+            auto header = std::array<std::uint32_t, 2>{};
+            link.recv(std::span<std::uint32_t>{ header });
+            if ((std::size_t)header[0] * (std::size_t)viewWidth + header[1] > total.size()) {
+                throw std::runtime_error{ "a shard sent a view out of the grid" };
+            }
+            counts.resize(header[1]);
+            link.recv(std::span{ counts });
+            add(header[0], counts);
+        }
+
+        if (view.width() != viewWidth || view.height() != viewHeight) {
+            view = Grid::Grid_type{ viewWidth, viewHeight };
+        }
+        for (long y = 0; y < viewHeight; ++y) {
+            const auto blockHeight = std::min((long)factor, m_height - y * factor);
+            auto*      out         = view.row(y);
+            for (long x = 0; x < viewWidth; ++x) {
+                const auto cells = (std::uint64_t)(blockHeight * std::min((long)factor, m_width - x * factor));
+                const auto live  = (std::uint64_t)total[(std::size_t)(y * viewWidth + x)];
+                out[x]           = (Grid::Cell)((live * Grid::LIVE_STATE + cells - 1) / cells);
+            }
+        }
+        return sum(total);
+    }
+
+    std::size_t   rank() const { return m_rank; }
+    std::size_t   count() const { return m_count; }
+    long          rows() const { return m_rows; }
+    std::uint64_t generation() const { return m_generation; }
+
+private:
+    enum class LinkKind : std::uint32_t
+    {
+        HALO,      // from the shard above
+        GATHER,    // to rank 0
+    };
+
+    long        m_width;
+    long        m_height;
+    std::size_t m_rank;
+    std::size_t m_count;
+    long        m_rowStart;
+    long        m_rows;
+    Rule        m_rule;
+
+    BitMatrix m_front;    // rows 0 and m_rows + 1 are the halos
+    BitMatrix m_back;
+
+    std::optional<ShardLink> m_up;
+    std::optional<ShardLink> m_down;
+    std::vector<ShardLink>   m_gather;    // rank 0: from every other shard in rank order, others: to rank 0
+
+    ThreadPool    m_threadPool;
+    std::uint64_t m_generation = 0;
+
+    // the halo exchange of the generation step() is on, see runExchanger()
+    std::mutex                  m_exchangeMutex;
+    std::condition_variable_any m_exchangeCv;
+    std::uint64_t               m_exchangeRequested = 0;    // guarded by m_exchangeMutex, like the next two
+    std::uint64_t               m_exchangeDone      = 0;
+    std::exception_ptr          m_exchangeError;
+    std::jthread                m_exchanger;    // last, so it's stopped before anything it uses is destroyed
+
+    long bandStart(std::size_t rank) const
+    {
+        return (long)((std::uint64_t)m_height * rank / std::max(m_count, std::size_t{ 1 }));
+    }
+
+    static std::uint64_t sum(std::span<const std::uint32_t> counts)
+    {
+        std::uint64_t total = 0;
+        for (auto count : counts) {
+            total += count;
+        }
+        return total;
+    }
+
+    // wait for step() to ask for an exchange, run it, tell step() it's done; until the shard is destroyed
+    void runExchanger(std::stop_token stop)
+    {
+        std::unique_lock lock{ m_exchangeMutex };
+        while (m_exchangeCv.wait(lock, stop, [&] { return m_exchangeDone != m_exchangeRequested; })) {
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                exchangeHalos();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+
+            m_exchangeError = error;
+            ++m_exchangeDone;
+            m_exchangeCv.notify_all();
+        }
+    }
+
+    // send the two edge rows and receive the two halo rows, both links polled at once on non-blocking sockets: neither
+    // link waits on the other, so a row larger than the socket buffers can't lock the ring (each shard sending up while
+    // its neighbor above sends down, say)
+    void exchangeHalos()
+    {
+        struct Transfer
+        {
+            const ShardLink&           m_link;
+            std::span<const std::byte> m_out;
+            std::span<std::byte>       m_in;
+        };
+
+        const auto words = (std::size_t)m_front.wordsPerRow();
+        auto       row   = [&](long y) { return std::as_writable_bytes(std::span{ m_front.row(y), words }); };
+
+        auto transfers = std::array<Transfer, 2>{ {
+            { *m_up, row(1), row(0) },
+            { *m_down, row(m_rows), row(m_rows + 1) },
+        } };
+
+        while (true) {
+            std::array<pollfd, 2> fds{};
+            bool                  pending = false;
+            for (std::size_t i = 0; i < transfers.size(); ++i) {
+                const auto& [link, out, in] = transfers[i];
+                const auto events           = (out.empty() ? 0 : POLLOUT) | (in.empty() ? 0 : POLLIN);
+                fds[i]                      = { events != 0 ? link.fd() : -1, (short)events, 0 };
+                pending                    |= events != 0;
+            }
+            if (!pending) {
+                return;
+            }
+
+            if (::poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error{ std::format("can't poll the shard links: {}", std::strerror(errno)) };
+            }
+
+            // an error or a hang up shows when sending or receiving
+            for (std::size_t i = 0; i < transfers.size(); ++i) {
+                auto& [link, out, in] = transfers[i];
+                const auto revents    = fds[i].revents;
+                if (!out.empty() && (revents & (POLLOUT | POLLERR | POLLHUP)) != 0) {
+                    link.sendSome(out);
+                }
+                if (!in.empty() && (revents & (POLLIN | POLLERR | POLLHUP)) != 0) {
+                    link.recvSome(in);
+                }
+            }
+        }
+    }
+
+    // every connection starts with who is on the other end, and the size of the grid it runs to catch mismatched runs
+    void connect(const std::vector<std::string>& addresses, std::chrono::seconds timeout)
+    {
+        using Hello = std::array<std::uint32_t, 4>;
+
+        const auto hello = [&](LinkKind kind) {
+            return Hello{ (std::uint32_t)m_rank, (std::uint32_t)kind, (std::uint32_t)m_width, (std::uint32_t)m_height };
+        };
+        const auto connectTo = [&](std::size_t rank, LinkKind kind) {
+            const auto [host, port] = ShardLink::splitAddress(addresses[rank]);
+            auto link               = ShardLink::connect(host, port, timeout);
+            link.send(std::span<const std::uint32_t>{ hello(kind) });
+            return link;
+        };
+
+        const auto listener = ShardLink::listen(ShardLink::splitAddress(addresses[m_rank]).second);
+
+        m_down = connectTo((m_rank + 1) % m_count, LinkKind::HALO);
+        if (m_rank != 0) {
+            m_gather.push_back(connectTo(0, LinkKind::GATHER));
+        }
+
+        std::vector<std::optional<ShardLink>> gathers(m_rank == 0 ? m_count : 0);
+        for (auto expected = m_rank == 0 ? m_count : 1; expected > 0; --expected) {
+            auto link  = listener.accept();
+            auto other = Hello{};
+            link.recv(std::span<std::uint32_t>{ other });
+
+            const auto [rank, kind, width, height] = other;
+            if (width != (std::uint32_t)m_width || height != (std::uint32_t)m_height) {
+                throw std::runtime_error{ std::format("shard {} runs a {}x{} grid, not {}x{}", rank, width, height, m_width, m_height) };
+            }
+
+            if (kind == (std::uint32_t)LinkKind::HALO && rank == (m_rank + m_count - 1) % m_count && !m_up) {
+                m_up = std::move(link);
+            } else if (kind == (std::uint32_t)LinkKind::GATHER && m_rank == 0 && rank > 0 && rank < m_count
+                       && !gathers[rank]) {
+                gathers[rank] = std::move(link);
+            } else {
+                throw std::runtime_error{ std::format("unexpected connection from shard {}", rank) };
+            }
+        }
+
+        for (auto& gather : gathers) {
+            if (gather) {
+                m_gather.push_back(std::move(*gather));
+            }
+        }
+        m_up->setNonBlocking();
+        m_down->setNonBlocking();
+        spdlog::info("(Shard) Rank [{}] connected to its neighbors", m_rank);
+    }
+};
+
+#endif /* end of include guard: SHARD_HPP_R5JM2XQT */
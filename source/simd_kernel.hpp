@@ -0,0 +1,291 @@
+#ifndef SIMD_KERNEL_HPP_P2M8VX4L
+#define SIMD_KERNEL_HPP_P2M8VX4L
+
+#include "rule.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <immintrin.h>
+#    define SIMD_KERNEL_X86
+#elif defined(__aarch64__)
+#    include <arm_neon.h>
+#    define SIMD_KERNEL_NEON
+#endif
+
+// Vectorized update of the interior of a byte grid row, under any Rule (the same as Grid::updateState). The lanes don't
+// look the table of the rule up, they apply the masks it's made of: born or survived to LIVE, else decayed toward 0.
+//
+// The caller passes pointers to the first cell to be updated on the row above, the row itself, and the row below;
+// the kernel reads one cell before and one cell after the range on every row, so it can't be used on the border.
+class SimdKernel
+{
+public:
+    using Cell   = std::uint8_t;
+    using Row_fn = void (*)(const Cell*, const Cell*, const Cell*, Cell*, std::size_t, const Rule&);
+
+    enum class InstructionSet
+    {
+        SCALAR,
+        SSE2,
+        AVX2,
+        NEON,
+    };
+
+    static constexpr Cell s_live = Rule::s_live;
+
+    // picked once at runtime depending on what the cpu supports
+    static InstructionSet instructionSet()
+    {
+        static const InstructionSet s_set = detect();
+        return s_set;
+    }
+
+    static std::string_view instructionSetName()
+    {
+        switch (instructionSet()) {
+        case InstructionSet::SCALAR: return "scalar";
+        case InstructionSet::SSE2: return "sse2";
+        case InstructionSet::AVX2: return "avx2";
+        case InstructionSet::NEON: return "neon";
+        }
+        return "unknown";
+    }
+
+    static void updateRow(
+        const Cell* up,
+        const Cell* mid,
+        const Cell* down,
+        Cell*       out,
+        std::size_t count,
+        const Rule& rule
+    )
+    {
+        static const Row_fn s_fn = [] {
+            switch (instructionSet()) {
+#if defined(SIMD_KERNEL_X86)
+            case InstructionSet::AVX2: return &rowAvx2;
+            case InstructionSet::SSE2: return &rowSse2;
+#elif defined(SIMD_KERNEL_NEON)
+            case InstructionSet::NEON: return &rowNeon;
+#endif
+            default: return &rowScalar;
+            }
+        }();
+        s_fn(up, mid, down, out, count, rule);
+    }
+
+    static void rowScalar(
+        const Cell* up,
+        const Cell* mid,
+        const Cell* down,
+        Cell*       out,
+        std::size_t count,
+        const Rule& rule
+    )
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = next(up + i, mid + i, down + i, rule);
+        }
+    }
+
+private:
+    static InstructionSet detect()
+    {
+#if defined(SIMD_KERNEL_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return InstructionSet::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return InstructionSet::SSE2;
+        }
+        return InstructionSet::SCALAR;
+#elif defined(SIMD_KERNEL_NEON)
+        return InstructionSet::NEON;    // mandatory on aarch64
+#else
+        return InstructionSet::SCALAR;
+#endif
+    }
+
+    static Cell next(const Cell* up, const Cell* mid, const Cell* down, const Rule& rule)
+    {
+        // clang-format off
+        const int neighbor = (up[-1]   == s_live) + (up[0]   == s_live) + (up[1]   == s_live)
+                           + (mid[-1]  == s_live)                       + (mid[1]  == s_live)
+                           + (down[-1] == s_live) + (down[0] == s_live) + (down[1] == s_live);
+        // clang-format on
+
+        return rule.next(mid[0], neighbor);
+    }
+
+    // byte n is 0xff if bit n of the mask is set, so that a byte shuffle indexed by the neighbor counts looks them up
+    static std::array<Cell, 16> expandMask(std::uint16_t mask)
+    {
+        std::array<Cell, 16> bytes{};
+        for (std::size_t n = 0; n < bytes.size(); ++n) {
+            bytes[n] = ((mask >> n) & 1) ? 0xff : 0x00;
+        }
+        return bytes;
+    }
+
+#if defined(SIMD_KERNEL_X86)
+    // comparing against LIVE gives 0xff (-1) per live cell, subtracting the masks counts the neighbors. a dead cell can
+    // be born, a dying one too but only with a Life-like rule (`anyBornable`); LIVE | anything is LIVE, so the born and
+    // survived lanes are simply or-ed over the decayed cells.
+    // NOTE: lambdas don't inherit the target attribute, hence the spelled out loops
+    __attribute__((target("avx2"))) static void rowAvx2(
+        const Cell* up,
+        const Cell* mid,
+        const Cell* down,
+        Cell*       out,
+        std::size_t count,
+        const Rule& rule
+    )
+    {
+        const auto birthBytes    = expandMask(rule.birthMask());
+        const auto survivalBytes = expandMask(rule.survivalMask());
+
+        const auto live        = _mm256_set1_epi8((char)s_live);
+        const auto zero        = _mm256_setzero_si256();
+        const auto decay       = _mm256_set1_epi8((char)rule.decay());
+        const auto anyBornable = _mm256_set1_epi8(rule.isLifeLike() ? (char)0xff : 0);
+        const auto birth       = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)birthBytes.data()));
+        const auto survival    = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)survivalBytes.data()));
+
+        std::size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            auto neighbor = _mm256_setzero_si256();
+            for (const Cell* row : { up + i, mid + i, down + i }) {
+                neighbor = _mm256_sub_epi8(neighbor, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(row - 1)), live));
+                neighbor = _mm256_sub_epi8(neighbor, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(row + 1)), live));
+            }
+            for (const Cell* row : { up + i, down + i }) {
+                neighbor = _mm256_sub_epi8(neighbor, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)row), live));
+            }
+
+            const auto cell     = _mm256_loadu_si256((const __m256i*)(mid + i));
+            const auto alive    = _mm256_cmpeq_epi8(cell, live);
+            const auto dead     = _mm256_cmpeq_epi8(cell, zero);
+            const auto bornable = _mm256_or_si256(dead, _mm256_andnot_si256(alive, anyBornable));
+            const auto born     = _mm256_and_si256(bornable, _mm256_shuffle_epi8(birth, neighbor));
+            const auto survived = _mm256_and_si256(alive, _mm256_shuffle_epi8(survival, neighbor));
+
+            const auto decayed = _mm256_subs_epu8(cell, decay);
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_or_si256(decayed, _mm256_or_si256(born, survived)));
+        }
+
+        rowScalar(up + i, mid + i, down + i, out + i, count - i, rule);
+    }
+
+    // same as rowAvx2(), but SSE2 has no byte shuffle: the counts are compared against each count set in the masks
+    __attribute__((target("sse2"))) static void rowSse2(
+        const Cell* up,
+        const Cell* mid,
+        const Cell* down,
+        Cell*       out,
+        std::size_t count,
+        const Rule& rule
+    )
+    {
+        __m128i     birthCounts[9];    // not std::array, the alignment attribute of __m128i would be dropped
+        __m128i     survivalCounts[9];
+        std::size_t numBirthCounts    = 0;
+        std::size_t numSurvivalCounts = 0;
+        for (int n = 0; n <= 8; ++n) {
+            if ((rule.birthMask() >> n) & 1) {
+                birthCounts[numBirthCounts++] = _mm_set1_epi8((char)n);
+            }
+            if ((rule.survivalMask() >> n) & 1) {
+                survivalCounts[numSurvivalCounts++] = _mm_set1_epi8((char)n);
+            }
+        }
+
+        const auto live        = _mm_set1_epi8((char)s_live);
+        const auto zero        = _mm_setzero_si128();
+        const auto decay       = _mm_set1_epi8((char)rule.decay());
+        const auto anyBornable = _mm_set1_epi8(rule.isLifeLike() ? (char)0xff : 0);
+
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto neighbor = _mm_setzero_si128();
+            for (const Cell* row : { up + i, mid + i, down + i }) {
+                neighbor = _mm_sub_epi8(neighbor, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row - 1)), live));
+                neighbor = _mm_sub_epi8(neighbor, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row + 1)), live));
+            }
+            for (const Cell* row : { up + i, down + i }) {
+                neighbor = _mm_sub_epi8(neighbor, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)row), live));
+            }
+
+            auto birth = _mm_setzero_si128();
+            for (std::size_t n = 0; n < numBirthCounts; ++n) {
+                birth = _mm_or_si128(birth, _mm_cmpeq_epi8(neighbor, birthCounts[n]));
+            }
+            auto survival = _mm_setzero_si128();
+            for (std::size_t n = 0; n < numSurvivalCounts; ++n) {
+                survival = _mm_or_si128(survival, _mm_cmpeq_epi8(neighbor, survivalCounts[n]));
+            }
+
+            const auto cell     = _mm_loadu_si128((const __m128i*)(mid + i));
+            const auto alive    = _mm_cmpeq_epi8(cell, live);
+            const auto bornable = _mm_or_si128(_mm_cmpeq_epi8(cell, zero), _mm_andnot_si128(alive, anyBornable));
+            const auto born     = _mm_and_si128(bornable, birth);
+            const auto survived = _mm_and_si128(alive, survival);
+
+            const auto decayed = _mm_subs_epu8(cell, decay);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_or_si128(decayed, _mm_or_si128(born, survived)));
+        }
+
+        rowScalar(up + i, mid + i, down + i, out + i, count - i, rule);
+    }
+#elif defined(SIMD_KERNEL_NEON)
+    static void rowNeon(
+        const Cell* up,
+        const Cell* mid,
+        const Cell* down,
+        Cell*       out,
+        std::size_t count,
+        const Rule& rule
+    )
+    {
+        const auto birthBytes    = expandMask(rule.birthMask());
+        const auto survivalBytes = expandMask(rule.survivalMask());
+
+        const auto live        = vdupq_n_u8(s_live);
+        const auto zero        = vdupq_n_u8(0);
+        const auto decay       = vdupq_n_u8(rule.decay());
+        const auto anyBornable = vdupq_n_u8(rule.isLifeLike() ? 0xff : 0);
+        const auto birth       = vld1q_u8(birthBytes.data());
+        const auto survival    = vld1q_u8(survivalBytes.data());
+
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            auto neighbor = vdupq_n_u8(0);
+            for (const Cell* row : { up + i, mid + i, down + i }) {
+                neighbor = vsubq_u8(neighbor, vceqq_u8(vld1q_u8(row - 1), live));
+                neighbor = vsubq_u8(neighbor, vceqq_u8(vld1q_u8(row + 1), live));
+            }
+            for (const Cell* row : { up + i, down + i }) {
+                neighbor = vsubq_u8(neighbor, vceqq_u8(vld1q_u8(row), live));
+            }
+
+            const auto cell     = vld1q_u8(mid + i);
+            const auto alive    = vceqq_u8(cell, live);
+            const auto bornable = vorrq_u8(vceqq_u8(cell, zero), vbicq_u8(anyBornable, alive));
+            const auto born     = vandq_u8(bornable, vqtbl1q_u8(birth, neighbor));
+            const auto survived = vandq_u8(alive, vqtbl1q_u8(survival, neighbor));
+
+            const auto decayed = vqsubq_u8(cell, decay);
+            vst1q_u8(out + i, vorrq_u8(decayed, vorrq_u8(born, survived)));
+        }
+
+        rowScalar(up + i, mid + i, down + i, out + i, count - i, rule);
+    }
+#endif
+};
+
+#endif /* end of include guard: SIMD_KERNEL_HPP_P2M8VX4L */
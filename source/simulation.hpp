@@ -1,29 +1,117 @@
 #ifndef SIMULATION_HPP_WHFEDHF3
 #define SIMULATION_HPP_WHFEDHF3
 
+#include "alloc_counter.hpp"
 #include "game.hpp"
+#include "mpsc_queue.hpp"
+#include "phase_stats.hpp"
+#include "snapshot.hpp"
 
+#include <spdlog/spdlog.h>
 #include <sync_cpp/sync.hpp>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <concepts>
 #include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 // Enter a lazy state if the simulation is paused: function provide to the Simulation::run() will be called every
 // `s_lazyUpdateTime` ms instead of every `m_delay` ms
+//
+// Edits are posted as commands from any thread (see post()) and applied by the simulation thread in batches between
+// two ticks, so the thread posting them never waits for a tick to finish.
+//
+// A fast-forward (see FastForward and JumpTo) runs the generations back to back, paused or not and whatever the delay,
+// in slices of about a frame: the grid is locked and the hooked function called once per slice, not per generation.
+//
+// With cycle detection on (see setCycleAction()), the hash of every generation is kept for the last s_hashHistory of
+// them; a state seen again is a cycle. A fast-forward then skips the whole periods left instead of computing them.
+//
+// With the census on (see setCensus()), the population, births and deaths of the last generation are kept, along with
+// those of the ones before it if asked for.
 class Simulation
 {
 public:
     using Duration = std::chrono::milliseconds;
 
+    // clang-format off
+    struct PaintCell   { int m_x; int m_y; Grid::Cell m_cell; };
+    struct PaintLine   { int m_x1; int m_y1; int m_x2; int m_y2; Grid::Cell m_cell; };    // both ends included
+    struct Clear       { };
+    struct Populate    { std::optional<float> m_density; };    // drawn from the seed if not set, see Grid::populate()
+    struct SetPause    { bool m_pause; };
+    struct Save        { std::filesystem::path m_path; };    // see SnapshotWriter, written in the background
+    struct Restore     { std::filesystem::path m_path; };
+    struct FastForward { std::uint64_t m_generations; };
+    struct JumpTo      { std::uint64_t m_generation; };    // ignored if the grid is already past it
+    // clang-format on
+
+    // out of bound cells are ignored
+    using Command = std::variant<PaintCell, PaintLine, Clear, Populate, SetPause, Save, Restore, FastForward, JumpTo>;
+
+    struct Progress
+    {
+        std::uint64_t m_from;
+        std::uint64_t m_to;
+        std::uint64_t m_generation;
+
+        float fraction() const
+        {
+            const auto total = m_to - m_from;
+            return total == 0 ? 1.0f : (float)(std::min(m_generation, m_to) - m_from) / (float)total;
+        }
+    };
+
+    // what is done once the states repeat
+    enum class CycleAction
+    {
+        OFF,       // the states are not even hashed
+        REPORT,    // logged, see getCycle()
+        PAUSE,     // same, and the simulation is paused (not during a fast-forward)
+    };
+
+    static inline const std::map<std::string, CycleAction> s_cycleActionMap{
+        { "off", CycleAction::OFF },
+        { "report", CycleAction::REPORT },
+        { "pause", CycleAction::PAUSE },
+    };
+
+    struct Cycle
+    {
+        std::uint64_t m_period;
+        std::uint64_t m_since;         // the first generation of the cycle that was hashed
+        std::uint64_t m_detectedAt;    // m_since + m_period
+    };
+
+    static constexpr std::size_t s_commandCapacity = 1024;
+    static constexpr std::size_t s_hashHistory     = 64;    // the longest period detected
+
     Simulation(
-        Grid::Coord_type     gridWidth,
-        Grid::Coord_type     gridHeight,
-        Grid::UpdateStrategy updateStrategy,
-        std::size_t          delay
+        Grid::Coord_type             gridWidth,
+        Grid::Coord_type             gridHeight,
+        Grid::UpdateStrategy         updateStrategy,
+        std::size_t                  delay,
+        const std::filesystem::path& mappedFile = Grid::s_defaultMappedFile,
+        Grid::Placement              placement  = Grid::Placement::DEFAULT
     )
-        : m_grid{ m_mutex, gridWidth, gridHeight, updateStrategy }
+        : m_grid{
+            m_mutex, gridWidth, gridHeight, updateStrategy, std::max(std::thread::hardware_concurrency(), 1u),
+            mappedFile, placement,
+        }
         , m_delay{ delay }
         , m_ignoreDelay{ false }
         , m_paused{ false }
@@ -44,17 +132,35 @@ public:
     void launch(Fn&& fn)
     {
         m_thread = std::jthread{ [this, fn = std::forward<Fn>(fn)](const std::stop_token& st) {
+            AllocCounter::setTrack(AllocCounter::Track::TICK);
+
             while (!st.stop_requested()) {
                 auto tpsCounter{ m_tickRateCounter.update() };
 
+                auto lockWait = PhaseStats::measure(PhaseStats::Phase::SIM_LOCK_WAIT);
                 m_grid.write([&](Grid& grid) {
-                    if (!m_paused) {
-                        grid.updateState();
+                    lockWait.stop();
+                    applyCommands(grid);
+                    if (isFastForwarding()) {
+                        auto timer = PhaseStats::measure(PhaseStats::Phase::UPDATE);
+                        fastForward(grid);
+                    } else if (!m_paused) {
+                        auto timer = PhaseStats::measure(PhaseStats::Phase::UPDATE);
+                        grid.advance(m_generationsPerTick);
+                        checkpoint(grid);
                     }
+                    m_generation = grid.generation();
+                    grid.setViewport(getViewport());
+                    grid.setLevelOfDetail(m_levelOfDetail);
+
+                    auto timer = PhaseStats::measure(PhaseStats::Phase::HANDOFF);
                     fn(grid);
                 });
 
                 // sleep routine
+                if (isFastForwarding()) {
+                    continue;
+                }
                 if (bool paused = m_paused.load(); paused || !m_ignoreDelay) {
                     Duration         delay{ m_delay.load() };
                     std::unique_lock lock{ m_mutex };
@@ -70,7 +176,64 @@ public:
     {
         wakeUp();
         if (m_paused) {
-            m_grid.write(&Grid::updateState);
+            m_grid.write([this](Grid& grid) {
+                AllocCounter::ScopedTrack track{ AllocCounter::Track::TICK };
+                applyCommands(grid);
+                grid.advance(m_generationsPerTick);
+            });
+        }
+    }
+
+    // any thread, the command is applied before the next tick. only if the queue is full (s_commandCapacity commands
+    // pending) this waits for the grid, everything pending is then applied right away
+    void post(Command command)
+    {
+        if (m_commands.push(std::move(command))) {
+            wakeUp();
+            return;
+        }
+
+        spdlog::debug("(Simulation) Command queue is full, applying the commands on the posting thread");
+
+        auto lockWait = PhaseStats::measure(PhaseStats::Phase::EDIT_LOCK_WAIT);
+        m_grid.write([&](Grid& grid) {
+            lockWait.stop();
+            applyCommands(grid);
+            apply(grid, command);
+        });
+        wakeUp();
+    }
+
+    // call `fn(x, y)` on each cell of the line from (x1, y1) to (x2, y2)
+    static void forEachCellOnLine(int x1, int y1, int x2, int y2, std::invocable<int, int> auto&& fn)
+    {
+        if (x1 == x2 && y1 == y2) {
+            fn(x1, y1);
+            return;
+        }
+
+        const auto grad{ (float)(y2 - y1) / (float)(x2 - x1) };
+        const auto grad_inv{ (float)(x2 - x1) / (float)(y2 - y1) };
+
+        // TODO: use a more sophisticated algorithm
+        if (std::abs(grad) <= 1.0f) {
+            if (x1 > x2) {
+                std::swap(x1, x2);
+                std::swap(y1, y2);
+            }
+            for (int col{ x1 }; col <= x2; ++col) {
+                const auto row{ static_cast<int>(grad * (float)(col - x1) + (float)y1) };
+                fn(col, row);
+            }
+        } else {
+            if (y1 > y2) {
+                std::swap(x1, x2);
+                std::swap(y1, y2);
+            }
+            for (int row{ y1 }; row <= y2; ++row) {
+                const auto col{ static_cast<int>(grad_inv * (float)(row - y1) + (float)x1) };
+                fn(col, row);
+            }
         }
     }
 
@@ -108,13 +271,335 @@ public:
     bool        isIgnoringDelay() const { return m_ignoreDelay; }
     bool        toggleIgnoreDelay() { return m_ignoreDelay = !m_ignoreDelay; }
 
+    // the hooked function (and so the renderer) only sees every n-th generation
+    void setGenerationsPerTick(int generations) { m_generationsPerTick = std::max(generations, 1); }
+    int  getGenerationsPerTick() const { return m_generationsPerTick; }
+
     decltype(auto) write(auto&&... args) { return m_grid.write(std::forward<decltype(args)>(args)...); }
     decltype(auto) read(auto&&... args) const { return m_grid.read(std::forward<decltype(args)>(args)...); }
 
     float getTickRate() const { return m_tickRateCounter.get(); }
 
+    // as of the last tick
+    std::uint64_t getGeneration() const { return m_generation; }
+
+    // must be called before launch(); not supported by the HASHLIFE strategy (see Grid::setHashObserver())
+    void setCycleAction(CycleAction action)
+    {
+        m_cycleAction = action;
+        m_grid.write([&](Grid& grid) {
+            if (action == CycleAction::OFF) {
+                grid.setHashObserver({});
+            } else {
+                grid.setHashObserver([this](std::uint64_t generation, std::uint64_t hash) {
+                    recordHash(generation, hash);
+                });
+            }
+        });
+    }
+
+    // the one the grid is in, none if not found yet or if the grid was edited since
+    std::optional<Cycle> getCycle() const
+    {
+        std::scoped_lock lock{ m_cycleMutex };
+        return m_cycle;
+    }
+
+    // must be called before launch(); `history` is the number of generations kept by getCensusHistory(), as a ring
+    void setCensus(bool enable, std::size_t history = 0)
+    {
+        {
+            std::scoped_lock lock{ m_censusMutex };
+            m_census.reset();
+            m_censusHistory.assign(enable ? history : 0, Grid::Census{});
+            m_censusNext  = 0;
+            m_censusCount = 0;
+        }
+
+        m_grid.write([&](Grid& grid) {
+            if (!enable) {
+                grid.setCensusObserver({});
+            } else {
+                grid.setCensusObserver([this](const Grid::Census& census) { recordCensus(census); });
+            }
+        });
+    }
+
+    // the one of the last generation computed, none if the census is off or nothing was computed yet
+    std::optional<Grid::Census> getCensus() const
+    {
+        std::scoped_lock lock{ m_censusMutex };
+        return m_census;
+    }
+
+    // oldest first, at most the history length given to setCensus()
+    std::vector<Grid::Census> getCensusHistory() const
+    {
+        std::scoped_lock lock{ m_censusMutex };
+
+        std::vector<Grid::Census> history;
+        history.reserve(m_censusCount);
+        const auto size = m_censusHistory.size();
+        for (std::size_t i = 0; i < m_censusCount; ++i) {
+            history.push_back(m_censusHistory[(m_censusNext + size - m_censusCount + i) % size]);
+        }
+        return history;
+    }
+
+    bool isFastForwarding() const { return m_fastForwardTo != 0; }
+
+    // none if not fast-forwarding; the generation is the one of the last slice
+    std::optional<Progress> getFastForwardProgress() const
+    {
+        const auto to = m_fastForwardTo.load();
+        if (to == 0) {
+            return std::nullopt;
+        }
+        return Progress{ .m_from = m_fastForwardFrom, .m_to = to, .m_generation = m_generation };
+    }
+
+    // any thread, the grid stays at the generation the current slice ends on
+    void cancelFastForward()
+    {
+        if (m_fastForwardTo.exchange(0) != 0) {
+            spdlog::info("(Simulation) Fast-forward cancelled");
+        }
+    }
+
+    // save a snapshot to `path` every `generations` generations (0 to stop), the previous one is overwritten; must be
+    // called before launch()
+    void setCheckpoint(std::filesystem::path path, std::uint64_t generations)
+    {
+        m_checkpointPath     = std::move(path);
+        m_checkpointInterval = generations;
+        m_nextCheckpoint     = generations;
+    }
+
+    // the region of the grid currently visible, forwarded to the grid on every tick
+    void setViewport(Grid::Region viewport)
+    {
+        std::scoped_lock lock{ m_viewportMutex };
+        m_viewport = viewport;
+    }
+
+    Grid::Region getViewport() const
+    {
+        std::scoped_lock lock{ m_viewportMutex };
+        return m_viewport;
+    }
+
+    // the levels of the density pyramid the renderer draws from, forwarded to the grid on every tick
+    void setLevelOfDetail(std::size_t levels) { m_levelOfDetail = levels; }
+
 private:
-    static constexpr Duration s_lazyUpdateTime{ 33 };    // about 30 tps
+    static constexpr Duration s_lazyUpdateTime{ 33 };      // about 30 tps
+    static constexpr Duration s_fastForwardSlice{ 16 };    // about a frame at 60 fps
+
+    // the queue is only ever popped under the grid lock, which makes whoever holds it the single consumer
+    void applyCommands(Grid& grid)
+    {
+        while (auto command = m_commands.pop()) {
+            apply(grid, *command);
+        }
+    }
+
+    void apply(Grid& grid, Command& command)
+    {
+        std::visit(
+            [&](auto& cmd) {
+                using C = std::decay_t<decltype(cmd)>;
+                if constexpr (std::same_as<C, PaintCell>) {
+                    if (grid.isInBound(cmd.m_x, cmd.m_y)) {
+                        grid.set(cmd.m_x, cmd.m_y, cmd.m_cell);
+                        resetCycle();
+                    }
+                } else if constexpr (std::same_as<C, PaintLine>) {
+                    forEachCellOnLine(cmd.m_x1, cmd.m_y1, cmd.m_x2, cmd.m_y2, [&](int x, int y) {
+                        if (grid.isInBound(x, y)) {
+                            grid.set(x, y, cmd.m_cell);
+                        }
+                    });
+                    resetCycle();
+                } else if constexpr (std::same_as<C, Clear>) {
+                    grid.clear();
+                    resetCycle();
+                } else if constexpr (std::same_as<C, Populate>) {
+                    resetCycle();
+                    spdlog::info("(Simulation) Populating grid...");
+                    grid.populate(cmd.m_density);
+                    spdlog::info("(Simulation) Populating grid done.");
+                } else if constexpr (std::same_as<C, SetPause>) {
+                    m_paused = cmd.m_pause;
+                } else if constexpr (std::same_as<C, Save>) {
+                    if (!save(grid, cmd.m_path)) {
+                        const auto path = cmd.m_path.string();
+                        spdlog::warn("(Simulation) The last snapshot is still being written, '{}' skipped", path);
+                    }
+                } else if constexpr (std::same_as<C, Restore>) {
+                    restore(grid, cmd.m_path);
+                    resetCycle();
+                } else if constexpr (std::same_as<C, FastForward>) {
+                    startFastForward(grid.generation(), grid.generation() + cmd.m_generations);
+                } else if constexpr (std::same_as<C, JumpTo>) {
+                    if (cmd.m_generation <= grid.generation()) {
+                        spdlog::warn(
+                            "(Simulation) Already at generation {}, can't jump to {}", grid.generation(), cmd.m_generation
+                        );
+                    } else {
+                        startFastForward(grid.generation(), cmd.m_generation);
+                    }
+                }
+            },
+            command
+        );
+    }
+
+    // only the copy of the state happens here, under the grid lock
+    bool save(Grid& grid, const std::filesystem::path& path)
+    {
+        auto info = Snapshot::Info{
+            .m_generation = grid.generation(),
+            .m_strategy   = Grid::strategyName(grid.updateStrategy()),
+            .m_rule       = std::string{ grid.rule().name() },
+        };
+        return m_snapshots.save(path, std::move(info), [&](Snapshot::Cells& cells) { grid.copyTo(cells, true); });
+    }
+
+    static void restore(Grid& grid, const std::filesystem::path& path)
+    {
+        try {
+            spdlog::info("(Simulation) Restoring '{}'...", path.string());
+            grid.restore(Snapshot{ path });
+            spdlog::info("(Simulation) Restored generation {}", grid.generation());
+        } catch (const std::exception& e) {
+            spdlog::error("(Simulation) Failed to restore '{}': {}", path.string(), e.what());
+        }
+    }
+
+    void startFastForward(std::uint64_t from, std::uint64_t to)
+    {
+        if (to <= from) {
+            return;
+        }
+        m_fastForwardFrom = from;
+        m_fastForwardTo   = to;
+        spdlog::info("(Simulation) Fast-forwarding from generation {} to {}", from, to);
+    }
+
+    // a slice: as many generations as fit in s_fastForwardSlice, going by how long the previous ones took, with none
+    // of them published but the last one (see Grid::setFastForward())
+    void fastForward(Grid& grid)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const auto deadline      = Clock::now() + s_fastForwardSlice;
+        auto       perGeneration = Clock::duration::zero();
+
+        grid.setFastForward(true);
+        auto target = m_fastForwardTo.load();
+        while (target > grid.generation()) {
+            const auto now = Clock::now();
+            if (now >= deadline) {
+                break;
+            }
+
+            const auto current = grid.generation();
+            auto       step    = std::uint64_t{ 1 };
+            if (perGeneration > Clock::duration::zero()) {
+                step = std::max((std::uint64_t)((deadline - now) / perGeneration), std::uint64_t{ 1 });
+            }
+            step = std::min({ step, target - current, (std::uint64_t)std::numeric_limits<int>::max() });
+
+            grid.advance((int)step);
+            checkpoint(grid);
+
+            // the whole periods left of a known cycle end on the state the grid is already in
+            if (m_cycleFound && target > grid.generation()) {
+                if (const auto cycles = (target - grid.generation()) / m_cyclePeriod; cycles > 0) {
+                    grid.skipCycles(m_cyclePeriod, cycles);
+                    spdlog::info("(Simulation) Skipped {} periods of {} generations", cycles, m_cyclePeriod);
+                }
+            }
+
+            perGeneration = (Clock::now() - now) / (long)std::max(grid.generation() - current, std::uint64_t{ 1 });
+            target        = m_fastForwardTo.load();    // 0 once cancelled
+        }
+        grid.setFastForward(false);
+
+        // a new target may have been set since, only a finished one is cleared
+        if (target != 0 && grid.generation() >= target && m_fastForwardTo.compare_exchange_strong(target, 0)) {
+            spdlog::info("(Simulation) Fast-forward done, at generation {}", grid.generation());
+        }
+    }
+
+    // on the simulation thread, by the grid after every generation (see setCycleAction()); once a cycle is found the
+    // history is left alone until the grid is edited
+    void recordHash(std::uint64_t generation, std::uint64_t hash)
+    {
+        if (m_cycleFound) {
+            return;
+        }
+
+        if (const auto seen = m_hashes.find(hash); seen && *seen < generation) {
+            foundCycle({ .m_period = generation - *seen, .m_since = *seen, .m_detectedAt = generation });
+            return;
+        }
+        m_hashes.record(generation, hash);
+    }
+
+    void foundCycle(const Cycle& cycle)
+    {
+        m_cycleFound  = true;
+        m_cyclePeriod = cycle.m_period;
+        {
+            std::scoped_lock lock{ m_cycleMutex };
+            m_cycle = cycle;
+        }
+
+        spdlog::info(
+            "(Simulation) Cycle of period {} since generation {}, found at generation {}",
+            cycle.m_period,
+            cycle.m_since,
+            cycle.m_detectedAt
+        );
+
+        if (m_cycleAction == CycleAction::PAUSE && !isFastForwarding()) {
+            spdlog::info("(Simulation) Pausing on the cycle");
+            m_paused = true;
+        }
+    }
+
+    // on the simulation thread, by the grid after every generation (see setCensus())
+    void recordCensus(const Grid::Census& census)
+    {
+        std::scoped_lock lock{ m_censusMutex };
+        m_census = census;
+        if (!m_censusHistory.empty()) {
+            m_censusHistory[m_censusNext] = census;
+            m_censusNext                  = (m_censusNext + 1) % m_censusHistory.size();
+            m_censusCount                 = std::min(m_censusCount + 1, m_censusHistory.size());
+        }
+    }
+
+    void resetCycle()
+    {
+        m_hashes.clear();
+        m_cycleFound = false;
+
+        std::scoped_lock lock{ m_cycleMutex };
+        m_cycle.reset();
+    }
+
+    // still busy writing the last checkpoint: try again on the next tick
+    void checkpoint(Grid& grid)
+    {
+        if (m_checkpointInterval == 0 || grid.generation() < m_nextCheckpoint) {
+            return;
+        }
+        if (save(grid, m_checkpointPath)) {
+            m_nextCheckpoint = (grid.generation() / m_checkpointInterval + 1) * m_checkpointInterval;
+        }
+    }
 
     class TickRateCounter
     {
@@ -152,6 +637,87 @@ private:
         std::size_t          m_index{ 0 };
     };
 
+    // the hashes of the last s_hashHistory generations: a ring in the order they were recorded, and an open addressing
+    // table from hash to generation over the same entries, so a lookup is O(1) and nothing is allocated per tick
+    class HashHistory
+    {
+    public:
+        // the generation the hash was last recorded at, if still in the history
+        std::optional<std::uint64_t> find(std::uint64_t hash) const
+        {
+            for (auto slot = home(hash); m_slots[slot].m_used; slot = (slot + 1) % s_numSlots) {
+                if (m_slots[slot].m_hash == hash) {
+                    return m_slots[slot].m_generation;
+                }
+            }
+            return std::nullopt;
+        }
+
+        void record(std::uint64_t generation, std::uint64_t hash)
+        {
+            // the oldest leaves the table along with the ring, unless its hash was recorded again since
+            if (m_count == s_hashHistory) {
+                const auto& [oldest, oldestHash] = m_ring[m_next];
+                if (find(oldestHash) == oldest) {
+                    erase(oldestHash);
+                }
+            }
+
+            m_ring[m_next] = { generation, hash };
+            m_next         = (m_next + 1) % s_hashHistory;
+            m_count        = std::min(m_count + 1, s_hashHistory);
+
+            auto slot = home(hash);
+            while (m_slots[slot].m_used && m_slots[slot].m_hash != hash) {
+                slot = (slot + 1) % s_numSlots;
+            }
+            m_slots[slot] = { .m_hash = hash, .m_generation = generation, .m_used = true };
+        }
+
+        void clear()
+        {
+            m_slots.fill({});
+            m_next  = 0;
+            m_count = 0;
+        }
+
+    private:
+        static constexpr std::size_t s_numSlots = 2 * s_hashHistory;    // at most half full
+
+        struct Slot
+        {
+            std::uint64_t m_hash       = 0;
+            std::uint64_t m_generation = 0;
+            bool          m_used       = false;
+        };
+
+        static std::size_t home(std::uint64_t hash) { return (std::size_t)(hash % s_numSlots); }
+
+        // the entries after it in the same run are shifted back, there is no tombstone
+        void erase(std::uint64_t hash)
+        {
+            auto hole = home(hash);
+            while (m_slots[hole].m_hash != hash) {
+                hole = (hole + 1) % s_numSlots;
+            }
+            for (auto slot = (hole + 1) % s_numSlots; m_slots[slot].m_used; slot = (slot + 1) % s_numSlots) {
+                // an entry only moves back into the hole if that doesn't put it before its home
+                const auto fromHome = (slot + s_numSlots - home(m_slots[slot].m_hash)) % s_numSlots;
+                const auto fromHole = (slot + s_numSlots - hole) % s_numSlots;
+                if (fromHome >= fromHole) {
+                    m_slots[hole] = m_slots[slot];
+                    hole          = slot;
+                }
+            }
+            m_slots[hole] = {};
+        }
+
+        std::array<std::pair<std::uint64_t, std::uint64_t>, s_hashHistory> m_ring;    // generation and hash
+        std::array<Slot, s_numSlots>                                       m_slots{};
+        std::size_t                                                        m_next  = 0;
+        std::size_t                                                        m_count = 0;
+    };
+
     spp::Sync<Grid, std::mutex, false> m_grid;
 
     mutable std::mutex      m_mutex;
@@ -162,8 +728,39 @@ private:
     std::atomic<bool>        m_ignoreDelay;
     std::atomic<bool>        m_paused;
     std::atomic<bool>        m_wakeFlag;
+    std::atomic<int>         m_generationsPerTick = 1;
+    std::atomic<std::size_t> m_levelOfDetail      = 0;
+
+    std::atomic<std::uint64_t> m_generation      = 0;
+    std::atomic<std::uint64_t> m_fastForwardFrom = 0;
+    std::atomic<std::uint64_t> m_fastForwardTo   = 0;    // 0 if not fast-forwarding
 
     TickRateCounter m_tickRateCounter;
+
+    MpscQueue<Command, s_commandCapacity> m_commands;
+
+    SnapshotWriter        m_snapshots;
+    std::filesystem::path m_checkpointPath;
+    std::uint64_t         m_checkpointInterval = 0;    // in generations, 0 if off
+    std::uint64_t         m_nextCheckpoint     = 0;
+
+    // cycle detection, only used on the simulation thread but for the copy of the cycle below
+    CycleAction   m_cycleAction = CycleAction::OFF;
+    HashHistory   m_hashes;
+    bool          m_cycleFound  = false;
+    std::uint64_t m_cyclePeriod = 0;
+
+    mutable std::mutex   m_cycleMutex;
+    std::optional<Cycle> m_cycle;
+
+    mutable std::mutex          m_censusMutex;
+    std::optional<Grid::Census> m_census;
+    std::vector<Grid::Census>   m_censusHistory;    // a ring
+    std::size_t                 m_censusNext  = 0;
+    std::size_t                 m_censusCount = 0;
+
+    mutable std::mutex m_viewportMutex;
+    Grid::Region       m_viewport{ 0, std::numeric_limits<int>::max(), 0, std::numeric_limits<int>::max() };
 };
 
 #endif /* end of include guard: SIMULATION_HPP_WHFEDHF3 */
@@ -0,0 +1,447 @@
+#ifndef SNAPSHOT_HPP_V6RB4NTJ
+#define SNAPSHOT_HPP_V6RB4NTJ
+
+#include "mapped_file.hpp"
+#include "unrolled_matrix.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// A saved state, read straight from its memory mapping. The file is a fixed 128 bytes header followed by the cells in
+// one of two encodings, whichever is smaller for the given state:
+//  - BITS, one bit per cell (bit x % 64 of word x / 64 of the row), rows back to back: the mapping is the state
+//  - RUNS, for sparse states: the cells are split in bands of s_bandRows rows, each band is the LEB128 lengths of its
+//    alternating dead and live runs in row-major order, starting with a dead one (the last dead run is left out). A
+//    table of the offsets of the bands (and of the end) within the body comes first
+//
+// Both can be decoded a band at a time on any number of threads (see decodeChunk()), like a Pattern. Only whether a cell
+// is LIVE is kept: the fade, and the dying states of a Generations rule, come back as dead cells.
+//
+// NOTE: numbers are stored in the native byte order, which is checked to be little endian
+class Snapshot
+{
+public:
+    using Cell  = std::uint8_t;
+    using Cells = UnrolledMatrix<Cell>;
+
+    enum class Encoding : std::uint32_t
+    {
+        BITS = 0,
+        RUNS = 1,
+    };
+
+    struct Info
+    {
+        std::uint64_t m_generation = 0;
+        std::string   m_strategy;    // the one the state was saved from, informative only
+        std::string   m_rule = "B3/S23";
+    };
+
+    static constexpr Cell        s_liveState = 0xff;    // same as Grid::LIVE_STATE
+    static constexpr std::size_t s_bandRows  = 64;
+
+    explicit Snapshot(const std::filesystem::path& path)
+        : m_file{ path }
+    {
+        const auto bytes = m_file.bytes();
+        if (bytes.size() < sizeof(Header)) {
+            throw std::runtime_error{ std::format("'{}' is not a snapshot: too small", path.string()) };
+        }
+
+        std::memcpy(&m_header, bytes.data(), sizeof(Header));
+        if (std::memcmp(m_header.m_magic.data(), s_magic.data(), s_magic.size()) != 0) {
+            throw std::runtime_error{ std::format("'{}' is not a snapshot", path.string()) };
+        }
+        if (m_header.m_version != s_version) {
+            throw std::runtime_error{ std::format("'{}': unsupported version {}", path.string(), m_header.m_version) };
+        }
+
+        m_body = bytes.subspan(sizeof(Header));
+        if (m_header.m_bodySize != m_body.size()) {
+            throw std::runtime_error{ std::format("'{}' is truncated", path.string()) };
+        }
+
+        const auto bands = numOfBands(m_header.m_height);
+        switch ((Encoding)m_header.m_encoding) {
+        case Encoding::BITS:
+            if (m_body.size() != bitsSize(m_header.m_width, m_header.m_height)) {
+                throw std::runtime_error{ std::format("'{}': wrong size for its dimension", path.string()) };
+            }
+            break;
+        case Encoding::RUNS:
+            if (m_body.size() < (bands + 1) * sizeof(std::uint64_t)) {
+                throw std::runtime_error{ std::format("'{}': band table is truncated", path.string()) };
+            }
+            for (std::size_t band = 0; band < bands; ++band) {
+                if (bandOffset(band) > bandOffset(band + 1) || bandOffset(band + 1) > m_body.size()) {
+                    throw std::runtime_error{ std::format("'{}': band table is corrupted", path.string()) };
+                }
+            }
+            break;
+        default:
+            throw std::runtime_error{ std::format("'{}': unknown encoding {}", path.string(), m_header.m_encoding) };
+        }
+
+        m_info = {
+            .m_generation = m_header.m_generation,
+            .m_strategy   = fromField(m_header.m_strategy),
+            .m_rule       = fromField(m_header.m_rule),
+        };
+    }
+
+    int         width() const { return (int)m_header.m_width; }
+    int         height() const { return (int)m_header.m_height; }
+    Encoding    encoding() const { return (Encoding)m_header.m_encoding; }
+    const Info& info() const { return m_info; }
+    std::size_t numOfChunks() const { return numOfBands(m_header.m_height); }
+
+    // fn(x, y) for every live cell of the band, row 0 is the first one of the grid
+    void decodeChunk(std::size_t band, std::invocable<int, int> auto&& fn) const
+    {
+        const auto width  = (std::size_t)m_header.m_width;
+        const auto yStart = band * s_bandRows;
+        const auto yEnd   = std::min(yStart + s_bandRows, (std::size_t)m_header.m_height);
+
+        if (encoding() == Encoding::BITS) {
+            const auto words = wordsPerRow(m_header.m_width);
+            for (auto y = yStart; y < yEnd; ++y) {
+                for (std::size_t w = 0; w < words; ++w) {
+                    std::uint64_t word;
+                    std::memcpy(&word, m_body.data() + (y * words + w) * sizeof(word), sizeof(word));
+                    for (; word != 0; word &= word - 1) {
+                        const auto x = w * 64 + (std::size_t)std::countr_zero(word);
+                        if (x < width) {
+                            fn((int)x, (int)y);
+                        }
+                    }
+                }
+            }
+            return;
+        }
+
+        // a corrupted band stops at its end, it can't spill into the others
+        auto       pos   = bandOffset(band);
+        const auto end   = bandOffset(band + 1);
+        auto       cell  = yStart * width;
+        const auto limit = yEnd * width;
+
+        bool live = false;
+        while (pos < end && cell < limit) {
+            const auto run = std::min(readVarint(pos, end), limit - cell);
+            if (live) {
+                for (auto i = cell; i < cell + run; ++i) {
+                    fn((int)(i % width), (int)(i / width));
+                }
+            }
+            cell += run;
+            live  = !live;
+        }
+    }
+
+    // save `cells` to `path`, through a temporary file renamed over it at the end so a crash while writing never
+    // leaves a broken snapshot behind; `body` is scratch space, passed in to be reused from one save to the next.
+    // return the number of bytes written
+    static std::size_t write(
+        const std::filesystem::path& path,
+        const Cells&                 cells,
+        const Info&                  info,
+        std::vector<std::uint8_t>&   body
+    )
+    {
+        const auto width  = (std::size_t)cells.width();
+        const auto height = (std::size_t)cells.height();
+
+        Header header       = {};
+        header.m_magic      = s_magic;
+        header.m_version    = s_version;
+        header.m_width      = (std::uint32_t)width;
+        header.m_height     = (std::uint32_t)height;
+        header.m_generation = info.m_generation;
+        toField(header.m_strategy, info.m_strategy);
+        toField(header.m_rule, info.m_rule);
+
+        const auto bits = bitsSize(width, height);
+        if (encodeRuns(cells, body, bits)) {
+            header.m_encoding = (std::uint32_t)Encoding::RUNS;
+        } else {
+            header.m_encoding = (std::uint32_t)Encoding::BITS;
+            encodeBits(cells, body);
+        }
+        header.m_bodySize = body.size();
+
+        auto tmp = path;
+        tmp += ".tmp";
+
+        auto* file = std::fopen(tmp.c_str(), "wb");
+        if (file == nullptr) {
+            throw std::runtime_error{ std::format("can't open '{}': {}", tmp.string(), std::strerror(errno)) };
+        }
+        const bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+                        && std::fwrite(body.data(), 1, body.size(), file) == body.size();
+        if (std::fclose(file) != 0 || !ok) {
+            std::filesystem::remove(tmp);
+            throw std::runtime_error{ std::format("can't write '{}'", tmp.string()) };
+        }
+
+        std::filesystem::rename(tmp, path);
+        return sizeof(header) + body.size();
+    }
+
+private:
+    static_assert(std::endian::native == std::endian::little, "the snapshot format is little endian");
+
+    static constexpr std::array<char, 8> s_magic   = { 'G', 'O', 'L', 'S', 'N', 'A', 'P', '\0' };
+    static constexpr std::uint32_t       s_version = 1;
+
+    struct Header
+    {
+        std::array<char, 8>  m_magic;
+        std::uint32_t        m_version;
+        std::uint32_t        m_encoding;
+        std::uint32_t        m_width;
+        std::uint32_t        m_height;
+        std::uint64_t        m_generation;
+        std::uint64_t        m_bodySize;
+        std::array<char, 32> m_strategy;    // NUL padded
+        std::array<char, 48> m_rule;
+        std::array<char, 8>  m_reserved;
+    };
+    static_assert(sizeof(Header) == 128);
+
+    MappedFile            m_file;
+    Header                m_header = {};
+    std::span<const char> m_body;
+    Info                  m_info;
+
+    static std::size_t numOfBands(std::size_t height) { return (height + s_bandRows - 1) / s_bandRows; }
+    static std::size_t wordsPerRow(std::size_t width) { return (width + 63) / 64; }
+    static std::size_t bitsSize(std::size_t width, std::size_t height)
+    {
+        return wordsPerRow(width) * height * sizeof(std::uint64_t);
+    }
+
+    std::size_t bandOffset(std::size_t band) const
+    {
+        std::uint64_t offset;
+        std::memcpy(&offset, m_body.data() + band * sizeof(offset), sizeof(offset));
+        return (std::size_t)offset;
+    }
+
+    std::size_t readVarint(std::size_t& pos, std::size_t end) const
+    {
+        std::size_t value = 0;
+        for (int shift = 0; pos < end && shift < 64; shift += 7) {
+            const auto byte  = (std::uint8_t)m_body[pos++];
+            value           |= (std::size_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    template <std::size_t N>
+    static void toField(std::array<char, N>& field, std::string_view value)
+    {
+        field = {};
+        std::memcpy(field.data(), value.data(), std::min(value.size(), N - 1));
+    }
+
+    template <std::size_t N>
+    static std::string fromField(const std::array<char, N>& field)
+    {
+        return { field.data(), std::find(field.begin(), field.end(), '\0') };
+    }
+
+    static void encodeBits(const Cells& cells, std::vector<std::uint8_t>& body)
+    {
+        const auto width = (std::size_t)cells.width();
+        const auto words = wordsPerRow(width);
+
+        body.assign(bitsSize(width, (std::size_t)cells.height()), 0);
+        for (std::size_t y = 0; y < (std::size_t)cells.height(); ++y) {
+            const auto* row = cells.row((ssize_t)y);
+            for (std::size_t w = 0; w < words; ++w) {
+                std::uint64_t word = 0;
+                for (std::size_t x = w * 64; x < std::min(width, w * 64 + 64); ++x) {
+                    word |= (std::uint64_t)(row[x] == s_liveState) << (x % 64);
+                }
+                std::memcpy(body.data() + (y * words + w) * sizeof(word), &word, sizeof(word));
+            }
+        }
+    }
+
+    // false as soon as it gets larger than `limit`, BITS is used then
+    static bool encodeRuns(const Cells& cells, std::vector<std::uint8_t>& body, std::size_t limit)
+    {
+        const auto width  = (std::size_t)cells.width();
+        const auto height = (std::size_t)cells.height();
+        const auto bands  = numOfBands(height);
+        const auto table  = (bands + 1) * sizeof(std::uint64_t);
+
+        body.assign(table, 0);
+
+        auto setOffset = [&](std::size_t band) {
+            const auto offset = (std::uint64_t)body.size();
+            std::memcpy(body.data() + band * sizeof(offset), &offset, sizeof(offset));
+        };
+        auto writeVarint = [&](std::size_t value) {
+            for (; value >= 0x80; value >>= 7) {
+                body.push_back((std::uint8_t)(value | 0x80));
+            }
+            body.push_back((std::uint8_t)value);
+        };
+
+        for (std::size_t band = 0; band < bands; ++band) {
+            setOffset(band);
+
+            const auto begin = band * s_bandRows;
+            const auto end   = std::min(begin + s_bandRows, height);
+
+            // the runs go on from the end of a row to the start of the next one
+            bool        live = false;
+            std::size_t run  = 0;
+            for (auto y = begin; y < end; ++y) {
+                const auto* row = cells.row((ssize_t)y);
+                for (std::size_t x = 0; x < width; ++x) {
+                    if ((row[x] == s_liveState) != live) {
+                        writeVarint(run);
+                        live = !live;
+                        run  = 0;
+                    }
+                    ++run;
+                }
+            }
+            if (live) {
+                writeVarint(run);
+            }
+
+            if (body.size() > limit) {
+                return false;
+            }
+        }
+        setOffset(bands);
+        return true;
+    }
+};
+
+// Saves snapshots on a background thread: save() only copies the state out (on the calling thread), the encoding and
+// the writing happen on the writer thread. One snapshot is in flight at most, save() refuses the next one until it's
+// written rather than queueing copies of the whole grid.
+class SnapshotWriter
+{
+public:
+    SnapshotWriter()
+        : m_thread{ [this](std::stop_token st) { run(st); } }
+    {
+    }
+
+    SnapshotWriter(const SnapshotWriter&)            = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // the snapshot in flight is written before returning
+    ~SnapshotWriter()
+    {
+        m_thread.request_stop();
+        m_thread.join();
+    }
+
+    // `capture(cells)` fills the buffer the snapshot is written from; false if the previous one is still being
+    // written, `capture` is not called then
+    bool save(std::filesystem::path path, Snapshot::Info info, std::invocable<Snapshot::Cells&> auto&& capture)
+    {
+        {
+            std::scoped_lock lock{ m_mutex };
+            if (m_pending) {
+                return false;
+            }
+            capture(m_cells);
+            m_path    = std::move(path);
+            m_info    = std::move(info);
+            m_pending = true;
+        }
+        m_cv.notify_all();
+        return true;
+    }
+
+    bool isBusy() const
+    {
+        std::scoped_lock lock{ m_mutex };
+        return m_pending;
+    }
+
+    // until the snapshot in flight (if any) is written
+    void wait()
+    {
+        std::unique_lock lock{ m_mutex };
+        m_cv.wait(lock, [this] { return !m_pending; });
+    }
+
+private:
+    mutable std::mutex          m_mutex;
+    std::condition_variable_any m_cv;
+    bool                        m_pending = false;
+
+    // owned by the writer thread while m_pending
+    Snapshot::Cells           m_cells;
+    std::filesystem::path     m_path;
+    Snapshot::Info            m_info;
+    std::vector<std::uint8_t> m_body;
+
+    std::jthread m_thread;    // last, it uses everything above
+
+    void run(std::stop_token st)
+    {
+        while (true) {
+            {
+                std::unique_lock lock{ m_mutex };
+                if (!m_cv.wait(lock, st, [this] { return m_pending; })) {
+                    return;    // stopped with nothing left to write
+                }
+            }
+
+            try {
+                const auto start = std::chrono::steady_clock::now();
+                const auto size  = Snapshot::write(m_path, m_cells, m_info, m_body);
+                const auto time  = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+                spdlog::info(
+                    "(SnapshotWriter) Saved '{}' at generation {}: {} bytes in {:.1f} ms",
+                    m_path.string(),
+                    m_info.m_generation,
+                    size,
+                    time.count()
+                );
+            } catch (const std::exception& e) {
+                spdlog::error("(SnapshotWriter) Failed to save '{}': {}", m_path.string(), e.what());
+            }
+
+            {
+                std::scoped_lock lock{ m_mutex };
+                m_pending = false;
+            }
+            m_cv.notify_all();
+        }
+    }
+};
+
+#endif /* end of include guard: SNAPSHOT_HPP_V6RB4NTJ */
@@ -0,0 +1,362 @@
+#ifndef SPARSE_UNIVERSE_HPP_Q8CW3ZNB
+#define SPARSE_UNIVERSE_HPP_Q8CW3ZNB
+
+#include "bit_matrix.hpp"
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Unbounded universe of 64x64 chunks, kept in a hash map keyed by chunk coordinates. Only the chunks holding live cells
+// are kept, along with the empty ones next to a live edge for as long as a step may give birth in them: the memory goes
+// with the live area, not with the extent of the pattern (spaceships fly off without anything growing behind them).
+//
+// A chunk is 64 rows of 64 bits, bit b of row r being the cell (cx * 64 + b, cy * 64 + r), held twice: the current
+// generation, and the next one being computed from the current one of the chunk and of its 8 neighbors. A step only
+// writes the next generation of the chunks, so they can all be computed in parallel. The chunks come from a pool,
+// given back to it once they died out.
+class SparseUniverse
+{
+public:
+    using Coord_type = std::int64_t;
+    using Word_type  = BitMatrix::Word_type;
+
+    static constexpr Coord_type s_chunkSize = 64;
+
+    struct Chunk
+    {
+        using Rows = std::array<Word_type, s_chunkSize>;
+
+        std::array<Rows, 2> m_rows;    // the current generation is m_rows[m_current] of the universe
+        Coord_type          m_cx;
+        Coord_type          m_cy;
+        std::uint64_t       m_population;
+        std::uint64_t       m_births;    // on the last step
+        std::uint64_t       m_deaths;
+    };
+
+    SparseUniverse() = default;
+
+    SparseUniverse(const SparseUniverse&)            = delete;
+    SparseUniverse& operator=(const SparseUniverse&) = delete;
+
+    // remove everything, the memory of the chunks included
+    void reset()
+    {
+        m_chunks.clear();
+        m_active.clear();
+        m_pool       = {};
+        m_population = 0;
+        m_births     = 0;
+        m_deaths     = 0;
+    }
+
+    void setCell(Coord_type x, Coord_type y, bool live)
+    {
+        const auto mask = Word_type{ 1 } << (x & (s_chunkSize - 1));
+
+        auto* chunk = find(x >> 6, y >> 6);
+        if (!chunk) {
+            if (!live) {
+                return;
+            }
+            chunk = insert(x >> 6, y >> 6);
+        }
+
+        auto&      word = chunk->m_rows[m_current][(std::size_t)(y & (s_chunkSize - 1))];
+        const bool was  = word & mask;
+        word            = live ? (word | mask) : (word & ~mask);
+
+        chunk->m_population += (std::uint64_t)live - (std::uint64_t)was;
+        m_population        += (std::uint64_t)live - (std::uint64_t)was;
+    }
+
+    bool get(Coord_type x, Coord_type y) const
+    {
+        const auto* chunk = find(x >> 6, y >> 6);
+        return chunk && (chunk->m_rows[m_current][(std::size_t)(y & (s_chunkSize - 1))] >> (x & (s_chunkSize - 1))) & 1;
+    }
+
+    // bit n of `birth` (`survival`): a dead (live) cell is live on n neighbors, see Rule. birth on 0 neighbors would
+    // fill the unbounded universe, it's not supported
+    void setRule(std::uint16_t birth, std::uint16_t survival)
+    {
+        m_birthCounts.clear();
+        m_survivalCounts.clear();
+        for (int n = 0; n <= 8; ++n) {
+            if ((birth >> n) & 1) {
+                m_birthCounts.push_back(n);
+            }
+            if ((survival >> n) & 1) {
+                m_survivalCounts.push_back(n);
+            }
+        }
+        m_conway = birth == 1 << 3 && survival == (1 << 2 | 1 << 3);
+    }
+
+    // advance the universe by a generation; `parallel(count, fn)` calls `fn(i)` for every i in [0, count), in any
+    // order and on any thread
+    template <typename Parallel>
+    void step(Parallel&& parallel)
+    {
+        m_active.clear();
+        for (const auto& [key, chunk] : m_chunks) {
+            m_active.push_back(chunk);
+        }
+        grow();
+
+        parallel((long)m_active.size(), [this](long i) { computeNext(*m_active[(std::size_t)i]); });
+        m_current ^= 1;
+
+        m_population = 0;
+        m_births     = 0;
+        m_deaths     = 0;
+        for (auto* chunk : m_active) {
+            m_population += chunk->m_population;
+            m_births     += chunk->m_births;
+            m_deaths     += chunk->m_deaths;
+            if (chunk->m_population == 0) {
+                m_chunks.erase(Key{ chunk->m_cx, chunk->m_cy });
+                m_pool.release(chunk);
+            }
+        }
+    }
+
+    // call `fn(x, y)` for every live cell inside [xStart, xEnd) x [yStart, yEnd); only the chunks overlapping it are
+    // visited, looked up one by one or found by going through all of them, whichever is less work
+    template <std::invocable<Coord_type, Coord_type> Fn>
+    void forEachLive(Coord_type xStart, Coord_type xEnd, Coord_type yStart, Coord_type yEnd, Fn&& fn) const
+    {
+        if (xStart >= xEnd || yStart >= yEnd) {
+            return;
+        }
+
+        const auto cxStart = xStart >> 6;
+        const auto cxEnd   = ((xEnd - 1) >> 6) + 1;
+        const auto cyStart = yStart >> 6;
+        const auto cyEnd   = ((yEnd - 1) >> 6) + 1;
+
+        auto visit = [&](const Chunk& chunk) {
+            const auto x0 = chunk.m_cx * s_chunkSize;
+            const auto y0 = chunk.m_cy * s_chunkSize;
+            for (Coord_type r = std::max(yStart - y0, Coord_type{ 0 }); r < std::min(yEnd - y0, s_chunkSize); ++r) {
+                for (auto word = chunk.m_rows[m_current][(std::size_t)r]; word != 0; word &= word - 1) {
+                    const auto x = x0 + std::countr_zero(word);
+                    if (x >= xStart && x < xEnd) {
+                        fn(x, y0 + r);
+                    }
+                }
+            }
+        };
+
+        if ((std::uint64_t)(cxEnd - cxStart) * (std::uint64_t)(cyEnd - cyStart) <= m_chunks.size()) {
+            for (auto cy = cyStart; cy < cyEnd; ++cy) {
+                for (auto cx = cxStart; cx < cxEnd; ++cx) {
+                    if (const auto* chunk = find(cx, cy)) {
+                        visit(*chunk);
+                    }
+                }
+            }
+        } else {
+            for (const auto& [key, chunk] : m_chunks) {
+                if (chunk->m_cx >= cxStart && chunk->m_cx < cxEnd && chunk->m_cy >= cyStart && chunk->m_cy < cyEnd) {
+                    visit(*chunk);
+                }
+            }
+        }
+    }
+
+    std::uint64_t population() const { return m_population; }
+    std::uint64_t births() const { return m_births; }    // on the last step
+    std::uint64_t deaths() const { return m_deaths; }
+    std::size_t   chunkCount() const { return m_chunks.size(); }
+    std::size_t   pooledChunkCount() const { return m_pool.capacity(); }
+
+private:
+    // chunks are allocated s_blockChunks at a time; a chunk given back is reused before a new block is allocated, the
+    // blocks themselves are only freed by reset()
+    class Pool
+    {
+    public:
+        static constexpr std::size_t s_blockChunks = 64;
+
+        Chunk* acquire()
+        {
+            if (m_free.empty()) {
+                auto& block = m_blocks.emplace_back(std::make_unique<Chunk[]>(s_blockChunks));
+                for (std::size_t i = s_blockChunks; i-- > 0;) {
+                    m_free.push_back(&block[i]);
+                }
+            }
+            auto* chunk = m_free.back();
+            m_free.pop_back();
+            return chunk;
+        }
+
+        void release(Chunk* chunk) { m_free.push_back(chunk); }
+
+        std::size_t capacity() const { return m_blocks.size() * s_blockChunks; }
+
+    private:
+        std::vector<std::unique_ptr<Chunk[]>> m_blocks;
+        std::vector<Chunk*>                   m_free;
+    };
+
+    // the coordinates of a chunk, the whole range of them: two chunks never share a key however far apart they are
+    struct Key
+    {
+        Coord_type m_cx;
+        Coord_type m_cy;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            auto h = (std::uint64_t)key.m_cx * 0x9e3779b97f4a7c15ull;
+            h      = (h ^ (std::uint64_t)key.m_cy) * 0xbf58476d1ce4e5b9ull;
+            return (std::size_t)(h ^ (h >> 31));
+        }
+    };
+
+    std::unordered_map<Key, Chunk*, KeyHash> m_chunks;
+    std::vector<Chunk*>                      m_active;    // of the step being run
+    Pool                                     m_pool;
+    std::size_t                              m_current    = 0;
+    std::uint64_t                            m_population = 0;
+    std::uint64_t                            m_births     = 0;
+    std::uint64_t                            m_deaths     = 0;
+
+    bool             m_conway = true;    // B3/S23 until setRule()
+    std::vector<int> m_birthCounts{ 3 };
+    std::vector<int> m_survivalCounts{ 2, 3 };
+
+    Chunk* find(Coord_type cx, Coord_type cy) const
+    {
+        const auto it = m_chunks.find(Key{ cx, cy });
+        return it == m_chunks.end() ? nullptr : it->second;
+    }
+
+    Chunk* insert(Coord_type cx, Coord_type cy)
+    {
+        auto* chunk = m_pool.acquire();
+        *chunk      = Chunk{ .m_rows = {}, .m_cx = cx, .m_cy = cy, .m_population = 0, .m_births = 0, .m_deaths = 0 };
+        m_chunks.emplace(Key{ cx, cy }, chunk);
+        return chunk;
+    }
+
+    // the missing neighbors of the chunks with live cells on the edge facing them join the step
+    void grow()
+    {
+        const auto count = m_active.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& chunk = *m_active[i];
+            const auto& rows  = chunk.m_rows[m_current];
+
+            Word_type columns = 0;    // the live columns
+            for (const auto row : rows) {
+                columns |= row;
+            }
+            const bool north = rows.front() != 0;
+            const bool south = rows.back() != 0;
+            const bool west  = columns & 1;
+            const bool east  = columns >> 63;
+
+            auto reach = [&](bool live, Coord_type dx, Coord_type dy) {
+                if (live && !find(chunk.m_cx + dx, chunk.m_cy + dy)) {
+                    m_active.push_back(insert(chunk.m_cx + dx, chunk.m_cy + dy));
+                }
+            };
+            reach(north, 0, -1);
+            reach(south, 0, 1);
+            reach(west, -1, 0);
+            reach(east, 1, 0);
+            reach(rows.front() & 1, -1, -1);
+            reach(rows.front() >> 63, 1, -1);
+            reach(rows.back() & 1, -1, 1);
+            reach(rows.back() >> 63, 1, 1);
+        }
+    }
+
+    void computeNext(Chunk& chunk) const
+    {
+        // the 3x3 chunks around it, row by row, a missing one is dead
+        std::array<const Chunk*, 9> around;
+        for (Coord_type dy = -1; dy <= 1; ++dy) {
+            for (Coord_type dx = -1; dx <= 1; ++dx) {
+                around[(std::size_t)((dy + 1) * 3 + dx + 1)] = find(chunk.m_cx + dx, chunk.m_cy + dy);
+            }
+        }
+
+        const auto current = m_current;
+        auto       word    = [&](std::size_t column, Coord_type r) -> Word_type {
+            const auto band = r < 0 ? 0 : (r < s_chunkSize ? 1 : 2);
+            const auto* c   = around[(std::size_t)band * 3 + column];
+            return c ? c->m_rows[current][(std::size_t)((r + s_chunkSize) % s_chunkSize)] : 0;
+        };
+
+        // the row at `r` as the cells, the west neighbors of the cells and the east ones
+        struct Line
+        {
+            Word_type m_cells, m_west, m_east;
+        };
+        auto line = [&](Coord_type r) {
+            const auto cells = word(1, r);
+            return Line{ cells, (cells << 1) | (word(0, r) >> 63), (cells >> 1) | (word(2, r) << 63) };
+        };
+
+        const auto&   rows  = chunk.m_rows[current];
+        auto&         next  = chunk.m_rows[current ^ 1];
+        std::uint64_t total = 0, births = 0, deaths = 0;
+
+        auto up  = line(-1);
+        auto mid = line(0);
+        for (Coord_type r = 0; r < s_chunkSize; ++r) {
+            const auto down   = line(r + 1);
+            const auto counts = BitMatrix::count(
+                up.m_west, up.m_cells, up.m_east, mid.m_west, mid.m_east, down.m_west, down.m_cells, down.m_east
+            );
+
+            const auto cells = rows[(std::size_t)r];
+            const auto out   = nextWord(counts, cells);
+
+            next[(std::size_t)r]  = out;
+            total                += (std::uint64_t)std::popcount(out);
+            births               += (std::uint64_t)std::popcount(out & ~cells);
+            deaths               += (std::uint64_t)std::popcount(cells & ~out);
+
+            up  = mid;
+            mid = down;
+        }
+
+        chunk.m_population = total;
+        chunk.m_births     = births;
+        chunk.m_deaths     = deaths;
+    }
+
+    Word_type nextWord(const BitMatrix::Counts& counts, Word_type cells) const
+    {
+        if (m_conway) {
+            return ~counts.m_s3 & ~counts.m_s2 & counts.m_s1 & (counts.m_s0 | cells);
+        }
+
+        Word_type born = 0;
+        for (const auto n : m_birthCounts) {
+            born |= counts.equal(n);
+        }
+        Word_type survived = 0;
+        for (const auto n : m_survivalCounts) {
+            survived |= counts.equal(n);
+        }
+        return (born & ~cells) | (survived & cells);
+    }
+};
+
+#endif /* end of include guard: SPARSE_UNIVERSE_HPP_Q8CW3ZNB */
@@ -0,0 +1,187 @@
+#ifndef STATS_OVERLAY_HPP_B9XK3MFD
+#define STATS_OVERLAY_HPP_B9XK3MFD
+
+#include "grid_texture.hpp"
+#include "phase_stats.hpp"
+#include "shader.hpp"
+
+#include <glbinding/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <format>
+#include <string_view>
+#include <vector>
+
+// The phase timings drawn on the top left corner of the window. The text is rasterized on the CPU with a built-in 5x7
+// font into a GridTexture, only when the numbers change (once per drain), then drawn on a single quad with blending.
+//
+// NOTE: must be constructed and used on the thread owning the OpenGL context
+class StatsOverlay
+{
+public:
+    StatsOverlay()
+        : m_texture{ s_columns * s_glyphWidth, s_lines * s_glyphHeight, "u_text", 0 }
+        , m_shader{ "./resources/shaders/stats_overlay.vert", "./resources/shaders/stats_overlay.frag" }
+        , m_pixels((std::size_t)m_texture.width() * (std::size_t)m_texture.height(), 0)
+    {
+        gl::glGenVertexArrays(1, &m_vao);    // nothing bound to it, but the core profile won't draw without one
+
+        m_shader.use();
+        m_shader.setUniform("u_foreground", glm::vec4{ 0.9f, 1.0f, 0.9f, 1.0f });
+        m_shader.setUniform("u_background", glm::vec4{ 0.0f, 0.0f, 0.0f, 0.6f });
+
+        m_texture.upload(m_pixels.data());
+    }
+
+    StatsOverlay(const StatsOverlay&)            = delete;
+    StatsOverlay& operator=(const StatsOverlay&) = delete;
+    StatsOverlay(StatsOverlay&&)                 = delete;
+    StatsOverlay& operator=(StatsOverlay&&)      = delete;
+
+    ~StatsOverlay() { gl::glDeleteVertexArrays(1, &m_vao); }
+
+    // `rates` is the line below the table, e.g. the frame and tick rate
+    void update(const PhaseStats::Summaries& summaries, std::string_view rates)
+    {
+        std::ranges::fill(m_pixels, 0);
+
+        int line = 0;
+        print(line++, std::format("{:<15}{:>7}{:>8}{:>8}{:>8}", "PHASE (MS)", "COUNT", "P50", "P99", "MAX"));
+        for (std::size_t i = 0; i < PhaseStats::s_numOfPhases; ++i) {
+            const auto& [count, total, min, p50, p99, max] = summaries[i];
+            const auto& name                               = PhaseStats::s_phaseNames[i];
+            print(line++, std::format("{:<15}{:>7}{:>8.3f}{:>8.3f}{:>8.3f}", name, count, p50, p99, max));
+        }
+        print(line + 1, rates);
+
+        m_texture.upload(m_pixels.data());
+    }
+
+    void draw(int windowWidth, int windowHeight)
+    {
+        if (windowWidth <= 0 || windowHeight <= 0) {
+            return;
+        }
+
+        // pixels to normalized device coordinates, from the top left corner
+        const auto width  = (float)(m_texture.width() * s_scale);
+        const auto height = (float)(m_texture.height() * s_scale);
+        const auto toNdcX = [&](float x) { return 2.0f * x / (float)windowWidth - 1.0f; };
+        const auto toNdcY = [&](float y) { return 1.0f - 2.0f * y / (float)windowHeight; };
+
+        const auto rect = glm::vec4{
+            toNdcX(s_margin),
+            toNdcY(s_margin + height),
+            toNdcX(s_margin + width),
+            toNdcY(s_margin),
+        };
+
+        gl::glEnable(gl::GL_BLEND);
+        gl::glBlendFunc(gl::GL_SRC_ALPHA, gl::GL_ONE_MINUS_SRC_ALPHA);
+
+        m_shader.use();
+        m_shader.setUniform("u_rect", rect);
+        m_texture.activate(m_shader);
+
+        gl::glBindVertexArray(m_vao);
+        gl::glDrawArrays(gl::GL_TRIANGLE_STRIP, 0, 4);
+        gl::glBindVertexArray(0);
+
+        gl::glDisable(gl::GL_BLEND);
+    }
+
+private:
+    using Glyph = std::array<std::uint8_t, 7>;    // one row per element, from the top, the 5 lowest bits are the pixels
+
+    static constexpr int   s_columns     = 46;    // characters per line
+    static constexpr int   s_lines       = (int)PhaseStats::s_numOfPhases + 3;    // header, blank, rates
+    static constexpr int   s_glyphWidth  = 6;    // 5x7 and a pixel of spacing
+    static constexpr int   s_glyphHeight = 8;
+    static constexpr int   s_scale       = 2;    // screen pixels per texel
+    static constexpr float s_margin      = 8.0f;
+
+    GridTexture               m_texture;
+    Shader                    m_shader;
+    gl::GLuint                m_vao = 0;
+    std::vector<std::uint8_t> m_pixels;    // same layout as the texture, first row on top
+
+    // characters past the end of the line are dropped
+    void print(int line, std::string_view text)
+    {
+        const auto width = (std::size_t)m_texture.width();
+        const auto count = std::min(text.size(), (std::size_t)s_columns);
+
+        for (std::size_t col = 0; col < count; ++col) {
+            const auto glyph = glyphOf(text[col]);
+            for (int row = 0; row < 7; ++row) {
+                auto* pixels = m_pixels.data() + ((std::size_t)(line * s_glyphHeight + row) * width) + col * s_glyphWidth;
+                for (int bit = 0; bit < 5; ++bit) {
+                    pixels[bit] = (glyph[(std::size_t)row] >> (4 - bit)) & 1 ? 0xff : 0x00;
+                }
+            }
+        }
+    }
+
+    // uppercase only, lowercase letters are shown as uppercase and anything unknown as blank
+    static Glyph glyphOf(char c)
+    {
+        // clang-format off
+        switch (std::toupper((unsigned char)c)) {
+        case '0': return { 0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110 };
+        case '1': return { 0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110 };
+        case '2': return { 0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111 };
+        case '3': return { 0b11111, 0b00010, 0b00100, 0b00010, 0b00001, 0b10001, 0b01110 };
+        case '4': return { 0b00010, 0b00110, 0b01010, 0b10010, 0b11111, 0b00010, 0b00010 };
+        case '5': return { 0b11111, 0b10000, 0b11110, 0b00001, 0b00001, 0b10001, 0b01110 };
+        case '6': return { 0b00110, 0b01000, 0b10000, 0b11110, 0b10001, 0b10001, 0b01110 };
+        case '7': return { 0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b01000, 0b01000 };
+        case '8': return { 0b01110, 0b10001, 0b10001, 0b01110, 0b10001, 0b10001, 0b01110 };
+        case '9': return { 0b01110, 0b10001, 0b10001, 0b01111, 0b00001, 0b00010, 0b01100 };
+        case 'A': return { 0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001 };
+        case 'B': return { 0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110 };
+        case 'C': return { 0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110 };
+        case 'D': return { 0b11100, 0b10010, 0b10001, 0b10001, 0b10001, 0b10010, 0b11100 };
+        case 'E': return { 0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111 };
+        case 'F': return { 0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b10000 };
+        case 'G': return { 0b01110, 0b10001, 0b10000, 0b10111, 0b10001, 0b10001, 0b01111 };
+        case 'H': return { 0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001 };
+        case 'I': return { 0b01110, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110 };
+        case 'J': return { 0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100 };
+        case 'K': return { 0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001 };
+        case 'L': return { 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111 };
+        case 'M': return { 0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001 };
+        case 'N': return { 0b10001, 0b10001, 0b11001, 0b10101, 0b10011, 0b10001, 0b10001 };
+        case 'O': return { 0b01110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110 };
+        case 'P': return { 0b11110, 0b10001, 0b10001, 0b11110, 0b10000, 0b10000, 0b10000 };
+        case 'Q': return { 0b01110, 0b10001, 0b10001, 0b10001, 0b10101, 0b10010, 0b01101 };
+        case 'R': return { 0b11110, 0b10001, 0b10001, 0b11110, 0b10100, 0b10010, 0b10001 };
+        case 'S': return { 0b01111, 0b10000, 0b10000, 0b01110, 0b00001, 0b00001, 0b11110 };
+        case 'T': return { 0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100 };
+        case 'U': return { 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110 };
+        case 'V': return { 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100 };
+        case 'W': return { 0b10001, 0b10001, 0b10001, 0b10101, 0b10101, 0b10101, 0b01010 };
+        case 'X': return { 0b10001, 0b10001, 0b01010, 0b00100, 0b01010, 0b10001, 0b10001 };
+        case 'Y': return { 0b10001, 0b10001, 0b10001, 0b01010, 0b00100, 0b00100, 0b00100 };
+        case 'Z': return { 0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111 };
+        case '.': return { 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b01100, 0b01100 };
+        case ':': return { 0b00000, 0b01100, 0b01100, 0b00000, 0b01100, 0b01100, 0b00000 };
+        case '/': return { 0b00000, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b00000 };
+        case '%': return { 0b11000, 0b11001, 0b00010, 0b00100, 0b01000, 0b10011, 0b00011 };
+        case '-': return { 0b00000, 0b00000, 0b00000, 0b11111, 0b00000, 0b00000, 0b00000 };
+        case '+': return { 0b00000, 0b00100, 0b00100, 0b11111, 0b00100, 0b00100, 0b00000 };
+        case '=': return { 0b00000, 0b00000, 0b11111, 0b00000, 0b11111, 0b00000, 0b00000 };
+        case '_': return { 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000, 0b11111 };
+        case '(': return { 0b00010, 0b00100, 0b01000, 0b01000, 0b01000, 0b00100, 0b00010 };
+        case ')': return { 0b01000, 0b00100, 0b00010, 0b00010, 0b00010, 0b00100, 0b01000 };
+        case '|': return { 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100 };
+        default:  return {};
+        }
+        // clang-format on
+    }
+};
+
+#endif /* end of include guard: STATS_OVERLAY_HPP_B9XK3MFD */
@@ -1,10 +1,20 @@
 #ifndef THREADPOOL_HPP_YWONTBSQ
 #define THREADPOOL_HPP_YWONTBSQ
 
+#include "alloc_counter.hpp"
+#include "numa.hpp"
+
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <future>
+#include <memory>
+#include <optional>
+#include <span>
 #include <thread>
 #include <type_traits>
 #include <vector>
@@ -19,36 +29,172 @@ public:
     // TODO: replace with std::move_only_function if it has come mainstream (at least exist in gcc main release)
     using Task_type = std::function<void()>;
 
+    enum class Mode
+    {
+        SHARED_QUEUE,     // every task goes through the single mutex-protected queue
+        WORK_STEALING,    // same as above, plus parallelFor() runs on per-worker lock-free deques
+    };
+
 private:
+    // Fixed capacity Chase-Lev deque of packed [begin, end) ranges. The owner pushes and pops at the bottom, thieves
+    // steal from the top. Ranges are split in half before being pushed, so the depth never gets anywhere near the
+    // capacity for any 32-bit range (see pack()).
+    class alignas(64) RangeDeque
+    {
+    public:
+        static constexpr std::int64_t s_capacity = 128;
+
+        bool push(std::uint64_t range)
+        {
+            const auto bottom = m_bottom.load(std::memory_order_relaxed);
+            const auto top    = m_top.load(std::memory_order_acquire);
+            if (bottom - top >= s_capacity) {
+                return false;
+            }
+            m_items[(std::size_t)(bottom % s_capacity)].store(range, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_release);    // publishes the job along with the range
+            return true;
+        }
+
+        std::optional<std::uint64_t> pop()
+        {
+            const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return {};
+            }
+
+            const auto range = m_items[(std::size_t)(bottom % s_capacity)].load(std::memory_order_relaxed);
+            if (top == bottom) {
+                // last item, race against the thieves for it
+                const bool won = m_top.compare_exchange_strong(
+                    top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+                );
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return won ? std::optional{ range } : std::nullopt;
+            }
+            return range;
+        }
+
+        std::optional<std::uint64_t> steal()
+        {
+            auto top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom) {
+                return {};
+            }
+
+            const auto range = m_items[(std::size_t)(top % s_capacity)].load(std::memory_order_relaxed);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return {};
+            }
+            return range;
+        }
+
+    private:
+        std::atomic<std::int64_t>                                 m_top{ 0 };
+        std::atomic<std::int64_t>                                 m_bottom{ 0 };
+        std::array<std::atomic<std::uint64_t>, (std::size_t)s_capacity> m_items{};
+    };
+
+    // the current parallelFor() call, lives as long as the pool so nothing is allocated per call
+    struct Job
+    {
+        void (*m_invoke)(void* fn, long begin, long end, std::size_t worker) = nullptr;
+        void*               m_fn                                         = nullptr;
+        long                m_grain                                      = 1;
+        std::atomic<long>   m_remaining                                  = 0;
+
+        // bumped on every range pushed and when the job is done, the idle workers park on it (see runJob())
+        std::atomic<std::uint32_t> m_signal = 0;
+
+        // of the caller, the workers count their allocations for it. guarded by m_mutex, like m_owned
+        AllocCounter::Track m_track = AllocCounter::Track::OTHER;
+
+        // parallelForOwned(): worker i runs chunk i of [m_begin, m_end) and nothing else, m_pending counts the workers
+        // left (an int so that waiting on it is a plain futex). parallelFor() only sets m_begin, the ranges are packed
+        // relative to it
+        bool             m_owned   = false;    // guarded by m_mutex
+        long             m_begin   = 0;
+        long             m_end     = 0;
+        long             m_chunks  = 0;
+        std::atomic<int> m_pending = 0;
+    };
+
     std::vector<std::jthread> m_threads;
     std::deque<Task_type>     m_tasks;
     mutable std::mutex        m_mutex;
     std::condition_variable   m_condition;
     bool                      m_stop = false;
 
+    struct Current
+    {
+        const ThreadPool* m_pool;
+        std::size_t       m_index;
+    };
+
+    static inline thread_local Current s_current{};    // of the worker running on this thread, if any
+
+    Mode                          m_mode;
+    std::unique_ptr<RangeDeque[]> m_deques;       // one per worker, plus one for the thread calling parallelFor()
+    Job                           m_job;
+    std::uint64_t                 m_jobEpoch = 0;    // guarded by m_mutex, bumped on every parallelFor()
+
 public:
-    ThreadPool(size_t numThreads)
+    // `numThreads` of 0 (what std::thread::hardware_concurrency() returns when it can't tell) makes a single worker
+    ThreadPool(size_t numThreads, Mode mode = Mode::SHARED_QUEUE)
+        : m_mode{ mode }
+        , m_deques{
+            mode == Mode::WORK_STEALING ? std::make_unique<RangeDeque[]>(std::max(numThreads, size_t{ 1 }) + 1) : nullptr
+        }
     {
+        numThreads = std::max(numThreads, size_t{ 1 });
         for (size_t i = 0; i < numThreads; ++i) {
-            m_threads.emplace_back([this] { while (true) {
-                Task_type task;
-                {
-                    std::unique_lock lock{ m_mutex };
-
-                    m_condition.wait(lock, [this] {
-                        auto condition = !m_tasks.empty() || m_stop;
-                        return condition;
-                    });
-
-                    if (m_stop && m_tasks.empty()) {
-                        return;
-                    }
+            m_threads.emplace_back([this, i, epoch = std::uint64_t{ 0 }]() mutable {
+                s_current = { this, i };
+                while (true) {
+                    Task_type task;
+                    {
+                        std::unique_lock lock{ m_mutex };
+
+                        m_condition.wait(lock, [&] {
+                            auto condition = !m_tasks.empty() || m_stop || m_jobEpoch != epoch;
+                            return condition;
+                        });
+
+                        // the kind of job is read along with its epoch, a worker waking up late for the previous
+                        // job must not take part in the next one as if it was its own
+                        if (m_jobEpoch != epoch) {
+                            epoch            = m_jobEpoch;
+                            const auto owned = m_job.m_owned;
+                            const auto track = m_job.m_track;
+                            lock.unlock();
 
-                    task = std::move(m_tasks.front());
-                    m_tasks.pop_front();
+                            AllocCounter::ScopedTrack scopedTrack{ track };
+                            if (owned) {
+                                runOwnedChunk(i);
+                            } else {
+                                runJob(i);
+                            }
+                            continue;
+                        }
+
+                        if (m_stop && m_tasks.empty()) {
+                            return;
+                        }
+
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
                 }
-                task();
-            } });
+            });
         }
         spdlog::info("(ThreadPool) Pool created with [{}] numbers of thread", numThreads);
     }
@@ -94,6 +240,90 @@ public:
         m_condition.notify_one();
     }
 
+    // Fork-join loop over [begin, end), calling `fn(index)` (or `fn(index, worker)`) for every index. The range is split
+    // lazily down to `grain` indices and idle workers steal the other halves, so uneven work balances itself. The
+    // calling thread takes part and the call returns once every index is done.
+    //
+    // On Mode::SHARED_QUEUE this falls back to parallelForOwned(), the calling thread then only waits. A range longer
+    // than s_maxRange runs as consecutive jobs of at most that many indices.
+    // NOTE: not reentrant, and must only be called from one thread at a time.
+    template <typename Fn>
+        requires std::invocable<Fn&, long> || std::invocable<Fn&, long, std::size_t>
+    void parallelFor(long begin, long end, long grain, Fn&& fn)
+    {
+        if (begin >= end) {
+            return;
+        }
+
+        if (m_mode == Mode::SHARED_QUEUE) {
+            parallelForOwned(begin, end, fn);
+            return;
+        }
+
+        for (; end - begin > s_maxRange; begin += s_maxRange) {
+            parallelFor(begin, begin + s_maxRange, grain, fn);
+        }
+
+        m_job.m_invoke = &invokeRange<Fn>;
+        m_job.m_fn     = &fn;
+        m_job.m_grain  = std::max(grain, 1l);
+        m_job.m_begin  = begin;
+        m_job.m_remaining.store(end - begin, std::memory_order_release);
+
+        const auto self = size();
+        pushRange(self, begin, end);
+        publishJob(false);
+
+        runJob(self);
+    }
+
+    // [begin, end) split in min(size(), end - begin) chunks, the last one taking the remainder, and chunk i always run
+    // by worker i: the same indices land on the same worker on every call, so the memory a worker first touched stays
+    // the memory it works on (see pinWorkers()). the calling thread only waits, blocked on m_remaining instead of
+    // spinning, and nothing is allocated per call. works on both modes
+    // NOTE: not reentrant, and must only be called from one thread at a time.
+    template <typename Fn>
+        requires std::invocable<Fn&, long> || std::invocable<Fn&, long, std::size_t>
+    void parallelForOwned(long begin, long end, Fn&& fn)
+    {
+        if (begin >= end) {
+            return;
+        }
+
+        m_job.m_invoke = &invokeRange<Fn>;
+        m_job.m_fn     = &fn;
+        m_job.m_begin  = begin;
+        m_job.m_end    = end;
+        m_job.m_chunks = std::min((long)size(), end - begin);
+
+        // every worker checks in, those without a chunk too, so none still reads m_job once this returns
+        m_job.m_pending.store((int)size(), std::memory_order_release);
+        publishJob(true);
+
+        for (auto pending = m_job.m_pending.load(std::memory_order_acquire); pending > 0;
+             pending      = m_job.m_pending.load(std::memory_order_acquire)) {
+            m_job.m_pending.wait(pending, std::memory_order_acquire);
+        }
+    }
+
+    // pin worker i to cpus[i % cpus.size()]
+    void pinWorkers(std::span<const int> cpus)
+    {
+        if (cpus.empty()) {
+            return;
+        }
+        for (std::size_t i = 0; i < m_threads.size(); ++i) {
+            NumaTopology::pin(m_threads[i].native_handle(), cpus[i % cpus.size()]);
+        }
+        spdlog::info("(ThreadPool) Pinned [{}] workers to [{}] cpus", m_threads.size(), cpus.size());
+    }
+
+    Mode mode() const { return m_mode; }
+
+    // the index of the calling thread among the workers of this pool, size() for any other thread (the one taking part
+    // in parallelFor() included)
+    std::size_t currentWorker() const { return s_current.m_pool == this ? s_current.m_index : m_threads.size(); }
+
     std::size_t queuedTasks() const
     {
         std::unique_lock lock{ m_mutex };
@@ -126,6 +356,123 @@ public:
         // std::unique_lock lock{ m_mutex };    // I guess lock is not actually needed here
         return m_threads.size();
     }
+
+private:
+    static constexpr long s_maxRange        = 0xffff'ffff;    // indices in a single parallelFor() job, see pack()
+    static constexpr int  s_spinsBeforePark = 64;             // failed rounds of stealing before a worker parks
+
+    // a range of the current job, as two 32-bit offsets from its m_begin
+    std::uint64_t pack(long begin, long end) const
+    {
+        return ((std::uint64_t)(begin - m_job.m_begin) << 32) | (std::uint32_t)(end - m_job.m_begin);
+    }
+    std::pair<long, long> unpack(std::uint64_t range) const
+    {
+        return { m_job.m_begin + (long)(range >> 32), m_job.m_begin + (long)(std::uint32_t)range };
+    }
+
+    template <typename Fn>
+    static void invokeRange(void* fn, long begin, long end, std::size_t worker)
+    {
+        auto& func = *static_cast<std::remove_reference_t<Fn>*>(fn);
+        for (long i = begin; i < end; ++i) {
+            if constexpr (std::invocable<Fn&, long, std::size_t>) {
+                func(i, worker);
+            } else {
+                func(i);
+            }
+        }
+    }
+
+    // wake the workers up for the job set up in m_job
+    void publishJob(bool owned)
+    {
+        {
+            std::unique_lock lock{ m_mutex };
+            m_job.m_owned = owned;
+            m_job.m_track = AllocCounter::track();
+            ++m_jobEpoch;
+        }
+        m_condition.notify_all();
+    }
+
+    bool pushRange(std::size_t self, long begin, long end)
+    {
+        if (!m_deques[self].push(pack(begin, end))) {
+            return false;
+        }
+        m_job.m_signal.fetch_add(1, std::memory_order_seq_cst);
+        m_job.m_signal.notify_one();
+        return true;
+    }
+
+    std::optional<std::uint64_t> takeRange(std::size_t self)
+    {
+        const auto numDeques = size() + 1;
+
+        auto range = m_deques[self].pop();
+        for (std::size_t i = 1; !range && i < numDeques; ++i) {
+            range = m_deques[(self + i) % numDeques].steal();
+        }
+        return range;
+    }
+
+    // take ranges from our own deque first, then steal from the others, until the whole job is done. a worker finding
+    // nothing to steal for a while parks on m_signal until a range is pushed or the job is done: reading the signal
+    // before looking one last time means a push in between can't be missed
+    void runJob(std::size_t self)
+    {
+        int spins = 0;
+        while (m_job.m_remaining.load(std::memory_order_acquire) > 0) {
+            auto range = takeRange(self);
+            if (!range && ++spins >= s_spinsBeforePark) {
+                const auto signal = m_job.m_signal.load(std::memory_order_seq_cst);
+                if (!(range = takeRange(self))) {
+                    if (m_job.m_remaining.load(std::memory_order_acquire) > 0) {
+                        m_job.m_signal.wait(signal, std::memory_order_seq_cst);
+                    }
+                    spins = 0;
+                    continue;
+                }
+            }
+            if (!range) {
+                std::this_thread::yield();
+                continue;
+            }
+            spins = 0;
+
+            auto [begin, end] = unpack(*range);
+            while (end - begin > m_job.m_grain) {
+                const auto mid = begin + (end - begin) / 2;
+                if (!pushRange(self, mid, end)) {
+                    break;
+                }
+                end = mid;
+            }
+
+            m_job.m_invoke(m_job.m_fn, begin, end, self);
+            if (m_job.m_remaining.fetch_sub(end - begin, std::memory_order_acq_rel) == end - begin) {
+                m_job.m_signal.fetch_add(1, std::memory_order_seq_cst);
+                m_job.m_signal.notify_all();
+            }
+        }
+    }
+
+    void runOwnedChunk(std::size_t self)
+    {
+        const auto chunk = (long)self;
+        if (chunk < m_job.m_chunks) {
+            const auto chunkSize = (m_job.m_end - m_job.m_begin) / m_job.m_chunks;
+            const auto begin     = m_job.m_begin + chunk * chunkSize;
+            const auto end       = chunk == m_job.m_chunks - 1 ? m_job.m_end : begin + chunkSize;
+
+            m_job.m_invoke(m_job.m_fn, begin, end, self);
+        }
+
+        if (m_job.m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_job.m_pending.notify_all();
+        }
+    }
 };
 
 #endif /* end of include guard: THREADPOOL_HPP_YWONTBSQ */
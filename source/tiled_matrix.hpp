@@ -0,0 +1,104 @@
+#ifndef TILED_MATRIX_HPP_R5TC8WJD
+#define TILED_MATRIX_HPP_R5TC8WJD
+
+#include <concepts>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Same interface as UnrolledMatrix, but the cells are stored in square blocks of `TileSize` x `TileSize` that are each
+// contiguous in memory (row-major inside a block, blocks row-major among themselves). A block and its neighbors stay
+// in cache while it's worked on no matter how wide the matrix is.
+//
+// The last column and row of blocks are padded up to a whole block, the padding is never read through get().
+template <std::default_initializable T, ssize_t TileSize = 64>
+class TiledMatrix
+{
+public:
+    using Element_type = T;
+
+    static constexpr ssize_t s_tileSize = TileSize;
+    static constexpr ssize_t s_tileArea = TileSize * TileSize;
+
+    TiledMatrix() = default;
+
+    TiledMatrix(
+        ssize_t width,
+        ssize_t height
+    )
+        : m_width{ width }
+        , m_height{ height }
+        , m_tilesX{ (width + TileSize - 1) / TileSize }
+        , m_tilesY{ (height + TileSize - 1) / TileSize }
+        , m_mat((std::size_t)(m_tilesX * m_tilesY * s_tileArea))
+    {
+    }
+
+    Element_type& get(ssize_t col, ssize_t row)
+    {
+        if (col < 0 || row < 0 || col >= m_width || row >= m_height) {
+            throw std::out_of_range{ "out of bound" };
+        }
+        return m_mat[(std::size_t)index(col, row)];
+    }
+
+    const Element_type& get(ssize_t col, ssize_t row) const
+    {
+        if (col < 0 || row < 0 || col >= m_width || row >= m_height) {
+            throw std::out_of_range{ "out of bound" };
+        }
+        return m_mat[(std::size_t)index(col, row)];
+    }
+
+    Element_type&       operator()(ssize_t col, ssize_t row) { return get(col, row); }
+    const Element_type& operator()(ssize_t col, ssize_t row) const { return get(col, row); }
+
+    // pointer to the first element of a block, the next row of the same block is `s_tileSize` elements further
+    Element_type*       tile(ssize_t tileX, ssize_t tileY) { return m_mat.data() + tileOffset(tileX, tileY); }
+    const Element_type* tile(ssize_t tileX, ssize_t tileY) const { return m_mat.data() + tileOffset(tileX, tileY); }
+
+    // pointer to the cell at (col, row), the cells after it up to the end of its block row are contiguous
+    Element_type*       rowSegment(ssize_t col, ssize_t row) { return m_mat.data() + index(col, row); }
+    const Element_type* rowSegment(ssize_t col, ssize_t row) const { return m_mat.data() + index(col, row); }
+
+    // return pair of width, height
+    std::pair<ssize_t, ssize_t> dimension() const { return { m_width, m_height }; }
+
+    ssize_t width() const { return m_width; }
+    ssize_t height() const { return m_height; }
+    ssize_t length() const { return m_width * m_height; }
+    ssize_t tilesX() const { return m_tilesX; }
+    ssize_t tilesY() const { return m_tilesY; }
+    ssize_t tileCount() const { return m_tilesX * m_tilesY; }
+
+    const auto& data() const { return m_mat; }
+    auto&       base() { return m_mat; }
+
+    void swap(TiledMatrix& other)
+    {
+        std::swap(m_width, other.m_width);
+        std::swap(m_height, other.m_height);
+        std::swap(m_tilesX, other.m_tilesX);
+        std::swap(m_tilesY, other.m_tilesY);
+        std::swap(m_mat, other.m_mat);
+    }
+
+    void clear() { m_mat.clear(); }
+
+private:
+    ssize_t                   m_width  = 0;
+    ssize_t                   m_height = 0;
+    ssize_t                   m_tilesX = 0;
+    ssize_t                   m_tilesY = 0;
+    std::vector<Element_type> m_mat;
+
+    ssize_t tileOffset(ssize_t tileX, ssize_t tileY) const { return (tileY * m_tilesX + tileX) * s_tileArea; }
+
+    ssize_t index(ssize_t col, ssize_t row) const
+    {
+        const auto tileIndex = (row / TileSize) * m_tilesX + col / TileSize;
+        return tileIndex * s_tileArea + (row % TileSize) * TileSize + col % TileSize;
+    }
+};
+
+#endif /* end of include guard: TILED_MATRIX_HPP_R5TC8WJD */
@@ -0,0 +1,97 @@
+#ifndef TRIPLE_BUFFER_ATOMIC_HPP_K2WQ8ZNM
+#define TRIPLE_BUFFER_ATOMIC_HPP_K2WQ8ZNM
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+
+// Single-producer, single-consumer triple buffer, lock-free. Nothing is ever copied between the two sides: the producer
+// writes into back() and publish() hands it over by swapping an index, the consumer reads whatever acquire() returned
+// until its next call to acquire() (its lease). Of the three buffers one is always leased to the consumer, one is the
+// last published, and the last one is free for the producer to write into.
+//
+// The producer may also read latest(), the last buffer it published, whether the consumer already took it or not; both
+// sides only read it so this is fine. Writing to it is NOT, unless it is known the consumer doesn't read at the same time
+// (e.g. it's done from the consumer thread).
+template <std::default_initializable Buffer>
+class TripleBufferAtomic
+{
+public:
+    using BufferType = Buffer;
+
+    explicit TripleBufferAtomic(const Buffer& startState = {})
+        : m_buffers{ startState, startState, startState }
+    {
+    }
+
+    TripleBufferAtomic(const TripleBufferAtomic&)            = delete;
+    TripleBufferAtomic& operator=(const TripleBufferAtomic&) = delete;
+
+    // `fn(buffer)` on all three buffers, only before the consumer gets to acquire() any
+    void initialize(std::invocable<Buffer&> auto&& fn)
+    {
+        for (auto& buffer : m_buffers) {
+            fn(buffer);
+        }
+    }
+
+    // producer side
+    // -------------
+
+    Buffer&       back() { return m_buffers[m_back]; }
+    const Buffer& back() const { return m_buffers[m_back]; }
+    Buffer&       latest() { return m_buffers[m_latest]; }
+    const Buffer& latest() const { return m_buffers[m_latest]; }
+
+    // make back() the latest, the new back() is either the previous latest if the consumer didn't take it, or the one
+    // the consumer just released. return whether the consumer took the previous latest (it holds it or a newer one)
+    bool publish()
+    {
+        m_versions[m_back] = ++m_version;
+
+        const auto previous = m_middle.exchange((std::uint8_t)(m_back | s_dirtyBit), std::memory_order_acq_rel);
+        m_latest            = m_back;
+        m_back              = previous & s_indexMask;
+
+        return (previous & s_dirtyBit) == 0;
+    }
+
+    // number of publish() so far; the two buffers the producer owns were last published at these, so back() holds the
+    // content of version backVersion() (nothing was written since) and latest() of version()
+    std::uint64_t version() const { return m_version; }
+    std::uint64_t backVersion() const { return m_versions[m_back]; }
+
+    // consumer side
+    // -------------
+
+    // take the latest published buffer if there is a new one, the previous lease is released
+    const Buffer& acquire()
+    {
+        if (m_middle.load(std::memory_order_relaxed) & s_dirtyBit) {
+            const auto newest = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front           = newest & s_indexMask;
+        }
+        return m_buffers[m_front];
+    }
+
+    // the current lease
+    const Buffer& front() const { return m_buffers[m_front]; }
+
+private:
+    static constexpr std::uint8_t s_indexMask = 0b011;
+    static constexpr std::uint8_t s_dirtyBit  = 0b100;    // the middle one was published and not yet acquired
+
+    std::array<Buffer, 3> m_buffers;
+
+    alignas(64) std::atomic<std::uint8_t> m_middle = 1;    // shared
+
+    alignas(64) std::uint8_t     m_back     = 2;    // producer only
+    std::uint8_t                 m_latest   = 0;
+    std::uint64_t                m_version  = 0;
+    std::array<std::uint64_t, 3> m_versions = {};
+
+    alignas(64) std::uint8_t m_front = 0;    // consumer only, starts on the same buffer as m_latest
+};
+
+#endif /* end of include guard: TRIPLE_BUFFER_ATOMIC_HPP_K2WQ8ZNM */
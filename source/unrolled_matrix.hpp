@@ -3,25 +3,141 @@
 
 #include <algorithm>
 #include <concepts>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <ranges>
 
+// std::allocator, but constructing an element without arguments default-initializes it instead of value-initializing
+// it: a vector of trivial elements sized with it is left uninitialized, its pages untouched until first written
+template <typename T>
+struct DefaultInitAllocator : std::allocator<T>
+{
+    template <typename U>
+    struct rebind
+    {
+        using other = DefaultInitAllocator<U>;
+    };
+
+    using std::allocator<T>::allocator;
+
+    template <typename U>
+    void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+    {
+        ::new ((void*)ptr) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args)
+    {
+        ::new ((void*)ptr) U(std::forward<Args>(args)...);
+    }
+};
+
+// what lies past the edges of a matrix, see UnrolledMatrix::refreshGhosts(). resolve() maps a coordinate to the one in
+// [0, size) it reads from, or to -1 if it reads a dead cell
+struct TorusBoundary
+{
+    static constexpr ssize_t resolve(ssize_t i, ssize_t size)
+    {
+        return (i % size + size) % size;
+    }
+};
+
+struct DeadBoundary
+{
+    static constexpr ssize_t resolve(ssize_t i, ssize_t size)
+    {
+        return i >= 0 && i < size ? i : -1;
+    }
+};
+
+// the edge is repeated: -1 reads 0, size reads size - 1, and so on (back and forth on borders wider than the matrix)
+struct MirroredBoundary
+{
+    static constexpr ssize_t resolve(ssize_t i, ssize_t size)
+    {
+        const auto folded = (i % (2 * size) + 2 * size) % (2 * size);
+        return folded < size ? folded : 2 * size - 1 - folded;
+    }
+};
+
+template <typename B>
+concept BoundaryPolicy = requires(ssize_t i) {
+    { B::resolve(i, i) } -> std::same_as<ssize_t>;
+};
+
+// Row-major matrix, optionally surrounded by a border of ghost elements (see the constructor taking a Ghost): a stencil
+// then reads the neighbors of any element straight from memory, without a bound check, once the border is refreshed.
+// get() and the dimensions are the ones of the matrix itself, data() and base() include the border.
 template <std::default_initializable T>
 class UnrolledMatrix
 {
 public:
     using Element_type = T;
 
+    // see the constructor taking it
+    struct Uninitialized
+    {
+    };
+
+    // width of the border, on every side
+    struct Ghost
+    {
+        ssize_t m_width;
+    };
+
     UnrolledMatrix() = default;
 
     UnrolledMatrix(
         ssize_t width,
         ssize_t height
     )
-        : m_mat(width * height)
-        , m_width{ width }
+        : m_width{ width }
+        , m_height{ height }
+        , m_mat(width * height, Element_type{})
+    {
+    }
+
+    // the elements are left as they are if trivial, the memory is only touched when they are first written to. meant
+    // to be written by the threads that are going to work on it (on NUMA, a page is placed where it's first touched)
+    UnrolledMatrix(
+        ssize_t width,
+        ssize_t height,
+        Uninitialized
+    )
+        : m_width{ width }
         , m_height{ height }
+        , m_mat(width * height)
+    {
+    }
+
+    // the border is `ghost.m_width` elements wide, see refreshGhosts()
+    UnrolledMatrix(
+        ssize_t width,
+        ssize_t height,
+        Ghost   ghost
+    )
+        : m_width{ width }
+        , m_height{ height }
+        , m_ghost{ ghost.m_width }
+        , m_mat((width + 2 * ghost.m_width) * (height + 2 * ghost.m_width), Element_type{})
+    {
+    }
+
+    // both of the above: the border too is left to be first written by the threads working on it
+    UnrolledMatrix(
+        ssize_t width,
+        ssize_t height,
+        Ghost   ghost,
+        Uninitialized
+    )
+        : m_width{ width }
+        , m_height{ height }
+        , m_ghost{ ghost.m_width }
+        , m_mat((width + 2 * ghost.m_width) * (height + 2 * ghost.m_width))
     {
     }
 
@@ -31,9 +147,9 @@ public:
         Element_type init
     )
         requires std::copy_constructible<Element_type>
-        : m_mat(width * height, init)
-        , m_width{ width }
+        : m_width{ width }
         , m_height{ height }
+        , m_mat(width * height, init)
     {
     }
 
@@ -75,8 +191,7 @@ public:
             throw std::range_error{ "out of bound" };
         }
 
-        ssize_t idx{ row * m_width + col };
-        return m_mat[idx];
+        return m_mat[index(col, row)];
     }
 
     const Element_type& get(ssize_t col, ssize_t row) const
@@ -85,8 +200,7 @@ public:
             throw std::out_of_range{ "out of bound" };
         }
 
-        ssize_t idx{ row * m_width + col };
-        return m_mat[idx];
+        return m_mat[index(col, row)];
     }
 
     Element_type& operator()(ssize_t col, ssize_t row)
@@ -116,6 +230,57 @@ public:
     {
         return m_width * m_height;
     }
+    ssize_t ghost() const
+    {
+        return m_ghost;
+    }
+    // distance between two rows in data()
+    ssize_t stride() const
+    {
+        return m_width + 2 * m_ghost;
+    }
+
+    // the first element of a row, its ghosts are at [-ghost(), 0) and [width(), width() + ghost()); the ghost rows are
+    // reached the same way, a stride() away from each other
+    Element_type* row(ssize_t row)
+    {
+        return m_mat.data() + index(0, row);
+    }
+    const Element_type* row(ssize_t row) const
+    {
+        return m_mat.data() + index(0, row);
+    }
+
+    // fill the border from the matrix as the boundary policy says, or with `dead`. done once after the matrix changed,
+    // in O(ghost * (width + height))
+    template <BoundaryPolicy Boundary>
+    void refreshGhosts(Element_type dead = Element_type{})
+    {
+        if (m_ghost == 0 || m_width == 0 || m_height == 0) {
+            return;
+        }
+
+        for (ssize_t y = 0; y < m_height; ++y) {
+            auto* cells = row(y);
+            for (ssize_t x = -m_ghost; x < 0; ++x) {
+                const auto from = Boundary::resolve(x, m_width);
+                cells[x]        = from < 0 ? dead : cells[from];
+            }
+            for (ssize_t x = m_width; x < m_width + m_ghost; ++x) {
+                const auto from = Boundary::resolve(x, m_width);
+                cells[x]        = from < 0 ? dead : cells[from];
+            }
+        }
+
+        // whole rows, the corners come along with the ghosts of the rows they are copied from
+        const auto rowLength = (std::size_t)stride();
+        for (ssize_t y = -m_ghost; y < 0; ++y) {
+            refreshGhostRow<Boundary>(y, rowLength, dead);
+        }
+        for (ssize_t y = m_height; y < m_height + m_ghost; ++y) {
+            refreshGhostRow<Boundary>(y, rowLength, dead);
+        }
+    }
 
     const auto& data() const
     {
@@ -130,6 +295,7 @@ public:
     {
         std::swap(m_width, other.m_width);
         std::swap(m_height, other.m_height);
+        std::swap(m_ghost, other.m_ghost);
         std::swap(m_mat, other.m_mat);
         // std::swap(*this, other);    // can i do this instead?
     }
@@ -140,9 +306,27 @@ public:
     }
 
 private:
-    ssize_t                   m_width  = 0;
-    ssize_t                   m_height = 0;
-    std::vector<Element_type> m_mat;
+    ssize_t                                                       m_width  = 0;
+    ssize_t                                                       m_height = 0;
+    ssize_t                                                       m_ghost  = 0;
+    std::vector<Element_type, DefaultInitAllocator<Element_type>> m_mat;
+
+    ssize_t index(ssize_t col, ssize_t row) const
+    {
+        return (row + m_ghost) * stride() + col + m_ghost;
+    }
+
+    template <BoundaryPolicy Boundary>
+    void refreshGhostRow(ssize_t y, std::size_t rowLength, Element_type dead)
+    {
+        auto*      dst  = row(y) - m_ghost;
+        const auto from = Boundary::resolve(y, m_height);
+        if (from < 0) {
+            std::fill_n(dst, rowLength, dead);
+        } else {
+            std::copy_n(row(from) - m_ghost, rowLength, dst);
+        }
+    }
 };
 
 #endif